@@ -0,0 +1,21 @@
+# File for module specific CMake tests.
+#
+# .. cmake_variable:: DUNE_LOCALFUNCTIONS_USE_BLAS
+#
+#    Use the matrix-matrix product dgemm of a BLAS library for the
+#    evaluation of a PolynomialBasis at several points at once.  The
+#    default is OFF, in which case a built-in kernel is used.
+#
+
+option(DUNE_LOCALFUNCTIONS_USE_BLAS
+  "Use BLAS for the evaluation of polynomial bases at several points" OFF)
+
+if(DUNE_LOCALFUNCTIONS_USE_BLAS)
+  find_package(BLAS)
+  if(BLAS_FOUND)
+    set(DUNE_LOCALFUNCTIONS_HAVE_BLAS 1)
+    dune_register_package_flags(LIBRARIES "${BLAS_LIBRARIES}")
+  else()
+    message(WARNING "DUNE_LOCALFUNCTIONS_USE_BLAS is set, but no BLAS library has been found")
+  endif()
+endif()
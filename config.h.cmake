@@ -39,4 +39,7 @@
 /* Define to the revision of dune-localfunctions */
 #define DUNE_LOCALFUNCTIONS_VERSION_REVISION ${DUNE_LOCALFUNCTIONS_VERSION_REVISION}
 
+/* Define to 1 if PolynomialBasis uses BLAS for the evaluation at several points */
+#cmakedefine DUNE_LOCALFUNCTIONS_HAVE_BLAS 1
+
 /* end dune-localfunctions */
@@ -52,7 +52,7 @@ namespace Dune
     }
 
     //! \brief number of shape functions
-    unsigned int size() const
+    static constexpr unsigned int size()
     {
       return 18;
     }
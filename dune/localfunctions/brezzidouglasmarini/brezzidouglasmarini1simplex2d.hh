@@ -61,9 +61,9 @@ namespace Dune
     }
 
     /** \brief Number of shape functions in this finite element */
-    unsigned int size () const
+    static constexpr unsigned int size ()
     {
-      return basis.size();
+      return Traits::LocalBasisType::size();
     }
 
     static constexpr GeometryType type ()
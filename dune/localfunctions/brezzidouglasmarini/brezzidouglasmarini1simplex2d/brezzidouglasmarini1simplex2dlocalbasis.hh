@@ -50,7 +50,7 @@ namespace Dune
     }
 
     //! \brief number of shape functions
-    unsigned int size () const
+    static constexpr unsigned int size ()
     {
       return 6;
     }
@@ -51,7 +51,7 @@ namespace Dune
     }
 
     //! \brief number of shape functions
-    unsigned int size() const
+    static constexpr unsigned int size()
     {
       return 12;
     }
@@ -0,0 +1,123 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#ifndef DUNE_LOCALFUNCTIONS_COMMON_BATCHEDEVALUATION_HH
+#define DUNE_LOCALFUNCTIONS_COMMON_BATCHEDEVALUATION_HH
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include <dune/common/typeutilities.hh>
+
+namespace Dune
+{
+
+  /** \file
+   * \brief Evaluation of a local basis at several points at once
+   *
+   * A local basis may implement the optional methods
+   * \code
+   * void evaluateFunction (const std::vector<typename Traits::DomainType>& points,
+   *                        std::vector<typename Traits::RangeType>& out) const;
+   * void evaluateJacobian (const std::vector<typename Traits::DomainType>& points,
+   *                        std::vector<typename Traits::JacobianType>& out) const;
+   * \endcode
+   * which evaluate all shape functions at all given points.  The results
+   * are stored point by point in one contiguous vector, i.e. the value of
+   * shape function i at point p is out[p*size()+i].
+   *
+   * The free functions evaluateFunctionAtPoints() and evaluateJacobianAtPoints()
+   * call these methods if the basis provides them, and otherwise evaluate
+   * the basis point by point.
+   */
+
+  namespace Impl
+  {
+
+    template<class LocalBasis>
+    auto evaluateFunctionAtPoints (const LocalBasis& localBasis,
+                                   const std::vector<typename LocalBasis::Traits::DomainType>& points,
+                                   std::vector<typename LocalBasis::Traits::RangeType>& out,
+                                   PriorityTag<1>)
+    -> decltype(localBasis.evaluateFunction(points, out))
+    {
+      localBasis.evaluateFunction(points, out);
+    }
+
+    template<class LocalBasis>
+    void evaluateFunctionAtPoints (const LocalBasis& localBasis,
+                                   const std::vector<typename LocalBasis::Traits::DomainType>& points,
+                                   std::vector<typename LocalBasis::Traits::RangeType>& out,
+                                   PriorityTag<0>)
+    {
+      const std::size_t size = localBasis.size();
+      out.resize(points.size()*size);
+      std::vector<typename LocalBasis::Traits::RangeType> values;
+      for (std::size_t p=0; p<points.size(); p++)
+      {
+        localBasis.evaluateFunction(points[p], values);
+        std::copy(values.begin(), values.end(), out.begin()+p*size);
+      }
+    }
+
+    template<class LocalBasis>
+    auto evaluateJacobianAtPoints (const LocalBasis& localBasis,
+                                   const std::vector<typename LocalBasis::Traits::DomainType>& points,
+                                   std::vector<typename LocalBasis::Traits::JacobianType>& out,
+                                   PriorityTag<1>)
+    -> decltype(localBasis.evaluateJacobian(points, out))
+    {
+      localBasis.evaluateJacobian(points, out);
+    }
+
+    template<class LocalBasis>
+    void evaluateJacobianAtPoints (const LocalBasis& localBasis,
+                                   const std::vector<typename LocalBasis::Traits::DomainType>& points,
+                                   std::vector<typename LocalBasis::Traits::JacobianType>& out,
+                                   PriorityTag<0>)
+    {
+      const std::size_t size = localBasis.size();
+      out.resize(points.size()*size);
+      std::vector<typename LocalBasis::Traits::JacobianType> jacobians;
+      for (std::size_t p=0; p<points.size(); p++)
+      {
+        localBasis.evaluateJacobian(points[p], jacobians);
+        std::copy(jacobians.begin(), jacobians.end(), out.begin()+p*size);
+      }
+    }
+
+  } // namespace Impl
+
+  /** \brief Evaluate all shape functions of a local basis at several points
+   *
+   * \param localBasis The local basis to evaluate
+   * \param points The evaluation points
+   * \param[out] out The values, out[p*localBasis.size()+i] is the value of
+   *                 shape function i at points[p]
+   */
+  template<class LocalBasis>
+  void evaluateFunctionAtPoints (const LocalBasis& localBasis,
+                                 const std::vector<typename LocalBasis::Traits::DomainType>& points,
+                                 std::vector<typename LocalBasis::Traits::RangeType>& out)
+  {
+    Impl::evaluateFunctionAtPoints(localBasis, points, out, PriorityTag<1>());
+  }
+
+  /** \brief Evaluate the Jacobians of all shape functions of a local basis at several points
+   *
+   * \param localBasis The local basis to evaluate
+   * \param points The evaluation points
+   * \param[out] out The Jacobians, out[p*localBasis.size()+i] is the Jacobian of
+   *                 shape function i at points[p]
+   */
+  template<class LocalBasis>
+  void evaluateJacobianAtPoints (const LocalBasis& localBasis,
+                                 const std::vector<typename LocalBasis::Traits::DomainType>& points,
+                                 std::vector<typename LocalBasis::Traits::JacobianType>& out)
+  {
+    Impl::evaluateJacobianAtPoints(localBasis, points, out, PriorityTag<1>());
+  }
+
+} // namespace Dune
+
+#endif // DUNE_LOCALFUNCTIONS_COMMON_BATCHEDEVALUATION_HH
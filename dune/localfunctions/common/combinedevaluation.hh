@@ -0,0 +1,135 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#ifndef DUNE_LOCALFUNCTIONS_COMMON_COMBINEDEVALUATION_HH
+#define DUNE_LOCALFUNCTIONS_COMMON_COMBINEDEVALUATION_HH
+
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+#include <dune/common/typeutilities.hh>
+
+namespace Dune
+{
+
+  /** \file
+   * \brief Evaluation of a linear combination of the shape functions of a local basis
+   *
+   * A local basis may implement the optional methods
+   * \code
+   * template<class C>
+   * void evaluateCombination (const typename Traits::DomainType& x,
+   *                           const std::vector<C>& coefficients,
+   *                           typename Traits::RangeType& value) const;
+   * template<class C>
+   * void evaluateCombination (const typename Traits::DomainType& x,
+   *                           const std::vector<C>& coefficients,
+   *                           typename Traits::RangeType& value,
+   *                           typename Traits::JacobianType& jacobian) const;
+   * \endcode
+   * which evaluate \f$\sum_i c_i \phi_i(x)\f$ (and its Jacobian) without
+   * computing the values of the single shape functions, e.g., by sum
+   * factorization for tensor-product bases.
+   *
+   * The free functions evaluateCombination() call these methods if the basis
+   * provides them, and otherwise evaluate all shape functions and contract
+   * the results with the coefficients.
+   */
+
+  namespace Impl
+  {
+
+    template<class LocalBasis, class C>
+    auto evaluateCombination (const LocalBasis& localBasis,
+                              const typename LocalBasis::Traits::DomainType& x,
+                              const std::vector<C>& coefficients,
+                              typename LocalBasis::Traits::RangeType& value,
+                              PriorityTag<1>)
+    -> decltype(localBasis.evaluateCombination(x, coefficients, value))
+    {
+      localBasis.evaluateCombination(x, coefficients, value);
+    }
+
+    template<class LocalBasis, class C>
+    void evaluateCombination (const LocalBasis& localBasis,
+                              const typename LocalBasis::Traits::DomainType& x,
+                              const std::vector<C>& coefficients,
+                              typename LocalBasis::Traits::RangeType& value,
+                              PriorityTag<0>)
+    {
+      assert(coefficients.size() == localBasis.size());
+      std::vector<typename LocalBasis::Traits::RangeType> values;
+      localBasis.evaluateFunction(x, values);
+      value = 0;
+      for (std::size_t i=0; i<values.size(); i++)
+        value.axpy(coefficients[i], values[i]);
+    }
+
+    template<class LocalBasis, class C>
+    auto evaluateCombination (const LocalBasis& localBasis,
+                              const typename LocalBasis::Traits::DomainType& x,
+                              const std::vector<C>& coefficients,
+                              typename LocalBasis::Traits::RangeType& value,
+                              typename LocalBasis::Traits::JacobianType& jacobian,
+                              PriorityTag<1>)
+    -> decltype(localBasis.evaluateCombination(x, coefficients, value, jacobian))
+    {
+      localBasis.evaluateCombination(x, coefficients, value, jacobian);
+    }
+
+    template<class LocalBasis, class C>
+    void evaluateCombination (const LocalBasis& localBasis,
+                              const typename LocalBasis::Traits::DomainType& x,
+                              const std::vector<C>& coefficients,
+                              typename LocalBasis::Traits::RangeType& value,
+                              typename LocalBasis::Traits::JacobianType& jacobian,
+                              PriorityTag<0>)
+    {
+      evaluateCombination(localBasis, x, coefficients, value, PriorityTag<0>());
+      std::vector<typename LocalBasis::Traits::JacobianType> jacobians;
+      localBasis.evaluateJacobian(x, jacobians);
+      jacobian = 0;
+      for (std::size_t i=0; i<jacobians.size(); i++)
+        jacobian.axpy(coefficients[i], jacobians[i]);
+    }
+
+  } // namespace Impl
+
+  /** \brief Evaluate a linear combination of the shape functions of a local basis
+   *
+   * \param localBasis The local basis to evaluate
+   * \param x The evaluation point
+   * \param coefficients The coefficients, one per shape function
+   * \param[out] value The value of the combination at x
+   */
+  template<class LocalBasis, class C>
+  void evaluateCombination (const LocalBasis& localBasis,
+                            const typename LocalBasis::Traits::DomainType& x,
+                            const std::vector<C>& coefficients,
+                            typename LocalBasis::Traits::RangeType& value)
+  {
+    Impl::evaluateCombination(localBasis, x, coefficients, value, PriorityTag<1>());
+  }
+
+  /** \brief Evaluate a linear combination of the shape functions of a local basis
+   *         and its Jacobian
+   *
+   * \param localBasis The local basis to evaluate
+   * \param x The evaluation point
+   * \param coefficients The coefficients, one per shape function
+   * \param[out] value The value of the combination at x
+   * \param[out] jacobian The Jacobian of the combination at x
+   */
+  template<class LocalBasis, class C>
+  void evaluateCombination (const LocalBasis& localBasis,
+                            const typename LocalBasis::Traits::DomainType& x,
+                            const std::vector<C>& coefficients,
+                            typename LocalBasis::Traits::RangeType& value,
+                            typename LocalBasis::Traits::JacobianType& jacobian)
+  {
+    Impl::evaluateCombination(localBasis, x, coefficients, value, jacobian, PriorityTag<1>());
+  }
+
+} // namespace Dune
+
+#endif // DUNE_LOCALFUNCTIONS_COMMON_COMBINEDEVALUATION_HH
@@ -4,6 +4,7 @@
 #ifndef DUNE_LOCALFUNCTIONS_COMMON_LOCALTOGLOBALADAPTORS_HH
 #define DUNE_LOCALFUNCTIONS_COMMON_LOCALTOGLOBALADAPTORS_HH
 
+#include <array>
 #include <cstddef>
 #include <vector>
 
@@ -13,6 +14,8 @@
 
 #include <dune/geometry/type.hh>
 
+#include <dune/localfunctions/common/batchedevaluation.hh>
+
 namespace Dune {
 
   //! Traits class for local-to-global basis adaptors
@@ -77,6 +80,13 @@ namespace Dune {
     const LocalBasis& localBasis;
     Geometry geometry;
 
+    typedef typename Geometry::JacobianInverseTransposed GeometryJacobian;
+    typedef typename LocalBasis::Traits::JacobianType LocalJacobian;
+
+    // The inverse transposed Jacobian if the geometry is affine
+    bool affine_;
+    GeometryJacobian jacobianInverseTransposed_;
+
   public:
     typedef LocalToGlobalBasisAdaptorTraits<typename LocalBasis::Traits,
         Geometry::coorddimension> Traits;
@@ -93,7 +103,11 @@ namespace Dune {
      */
     ScalarLocalToGlobalBasisAdaptor(const LocalBasis& localBasis_,
                                     const Geometry& geometry_) :
-      localBasis(localBasis_), geometry(geometry_)
+      localBasis(localBasis_), geometry(geometry_),
+      affine_(geometry.affine()),
+      jacobianInverseTransposed_(affine_ ?
+                                 GeometryJacobian(geometry.jacobianInverseTransposed(typename Traits::DomainLocal(0))) :
+                                 GeometryJacobian())
     { }
 
     std::size_t size() const { return localBasis.size(); }
@@ -123,16 +137,101 @@ namespace Dune {
     void evaluateJacobian(const typename Traits::DomainLocal& in,
                           std::vector<typename Traits::Jacobian>& out) const
     {
-      std::vector<typename LocalBasis::Traits::JacobianType>
-      localJacobian(size());
+      // reuse the scratch buffer of this thread instead of allocating it anew
+      static thread_local std::vector<LocalJacobian> localJacobian;
       localBasis.evaluateJacobian(in, localJacobian);
 
-      const typename Geometry::JacobianInverseTransposed &geoJacobian =
-        geometry.jacobianInverseTransposed(in);
-
       out.resize(size());
-      for(std::size_t i = 0; i < size(); ++i)
-        geoJacobian.mv(localJacobian[i][0], out[i][0]);
+      if(affine_)
+        transform(jacobianInverseTransposed_, localJacobian.data(), out.data(), size());
+      else
+        transform(geometry.jacobianInverseTransposed(in), localJacobian.data(), out.data(), size());
+    }
+
+    //! evaluate all shape functions at several points, see batchedevaluation.hh
+    /**
+     * The values are not transformed, i.e. they are the same on every
+     * element and may as well be taken from a LocalBasisTabulationCache of
+     * the local basis.
+     */
+    void evaluateFunction(const std::vector<typename Traits::DomainLocal>& points,
+                          std::vector<typename Traits::Range>& out) const
+    {
+      evaluateFunctionAtPoints(localBasis, points, out);
+    }
+
+    //! evaluate the global gradients of all shape functions at several points
+    /**
+     * The local Jacobians are evaluated by evaluateJacobianAtPoints().
+     * out[p*size()+i] is the Jacobian of shape function i at points[p].
+     */
+    void evaluateJacobian(const std::vector<typename Traits::DomainLocal>& points,
+                          std::vector<typename Traits::Jacobian>& out) const
+    {
+      static thread_local std::vector<LocalJacobian> localJacobians;
+      evaluateJacobianAtPoints(localBasis, points, localJacobians);
+      transformJacobians(points, localJacobians.data(), out);
+    }
+
+    //! transform given local Jacobians at several points to global gradients
+    /**
+     * \param points         The local points.
+     * \param localJacobians The local Jacobians of all shape functions at
+     *                       all points, localJacobians[p*size()+i] belonging
+     *                       to shape function i and points[p], e.g. the
+     *                       jacobians() of a LocalBasisTabulation.
+     * \param out            The global Jacobians in the same order.
+     *
+     * For an affine geometry all gradients at all points are transformed
+     * by one product of the inverse transposed Jacobian with the matrix of
+     * the local gradients.  Otherwise the geometry is evaluated once per
+     * point.
+     */
+    void transformJacobians(const std::vector<typename Traits::DomainLocal>& points,
+                            const LocalJacobian* localJacobians,
+                            std::vector<typename Traits::Jacobian>& out) const
+    {
+      out.resize(points.size()*size());
+      if(affine_)
+        transform(jacobianInverseTransposed_, localJacobians, out.data(), out.size());
+      else
+        for(std::size_t p = 0; p < points.size(); ++p)
+          transform(geometry.jacobianInverseTransposed(points[p]),
+                    localJacobians + p*size(), out.data() + p*size(), size());
+    }
+
+  private:
+    // out[m] = geoJacobian * localJacobians[m] for m = 0,...,n-1
+    static void transform(const GeometryJacobian& geoJacobian,
+                          const LocalJacobian* localJacobians,
+                          typename Traits::Jacobian* out, std::size_t n)
+    {
+      static const int dimLocal = Traits::dimDomainLocal;
+      static const int dimGlobal = Traits::dimDomainGlobal;
+
+      // copy the small matrix, so that the loop below sees plain values; the
+      // columns are taken by mv(), since the geometry may return a
+      // structured matrix like a DiagonalMatrix, whose entries cannot be
+      // read by index
+      std::array<std::array<typename Traits::DomainField, dimLocal>, dimGlobal> a;
+      for(int c = 0; c < dimLocal; ++c)
+      {
+        FieldVector<typename Traits::DomainField, dimLocal> unit(0);
+        unit[c] = 1;
+        typename Traits::DomainGlobal column;
+        geoJacobian.mv(unit, column);
+        for(int r = 0; r < dimGlobal; ++r)
+          a[r][c] = column[r];
+      }
+
+      for(std::size_t m = 0; m < n; ++m)
+        for(int r = 0; r < dimGlobal; ++r)
+        {
+          typename Traits::RangeField sum = 0;
+          for(int c = 0; c < dimLocal; ++c)
+            sum += a[r][c] * localJacobians[m][0][c];
+          out[m][0][r] = sum;
+        }
     }
   };
 
@@ -0,0 +1,687 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+
+#ifndef DUNE_LOCALFUNCTIONS_COMMON_PIOLALOCALTOGLOBALADAPTORS_HH
+#define DUNE_LOCALFUNCTIONS_COMMON_PIOLALOCALTOGLOBALADAPTORS_HH
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+#include <dune/common/fmatrix.hh>
+#include <dune/common/fvector.hh>
+
+#include <dune/geometry/type.hh>
+
+#include <dune/localfunctions/common/batchedevaluation.hh>
+#include <dune/localfunctions/common/localtoglobaladaptors.hh>
+
+namespace Dune {
+
+  /** \file
+   * \brief Local-to-global adaptors for vector-valued finite elements
+   *        transformed by the Piola maps
+   *
+   * Let \f$\mu\f$ be the local-to-global map of the geometry,
+   * \f$\hat J = \hat J_\mu(\hat x)\f$ its Jacobian and
+   * \f$|\det\hat J|\f$ the integration element.  The contravariant Piola
+   * map
+   * \f[ v(\mu(\hat x)) = \frac{1}{|\det\hat J|} \hat J \hat v(\hat x) \f]
+   * preserves normal components and is used for H(div) elements like
+   * Raviart-Thomas and Brezzi-Douglas-Marini.  The covariant Piola map
+   * \f[ v(\mu(\hat x)) = \hat J^{-T} \hat v(\hat x) \f]
+   * preserves tangential components and is used for H(curl) (edge)
+   * elements.
+   *
+   * The adaptors evaluate the transformed shape functions, their Jacobians,
+   * and the divergence (contravariant) or curl (covariant), either at a
+   * single point or at several points at once.  The batched methods store
+   * their results point by point, i.e. out[p*size()+i] belongs to shape
+   * function i and points[p], as in batchedevaluation.hh.  For an affine
+   * geometry the transformation is computed once on construction and all
+   * shape functions at all points are transformed in one loop; otherwise it
+   * is computed once per point.
+   *
+   * The divergence and the curl are exact for all geometries.  The Jacobians
+   * neglect the derivatives of \f$\hat J\f$, i.e. they are exact for affine
+   * geometries only.  The local and the global dimension must agree.
+   */
+
+  namespace Impl {
+
+    // The quantities of the geometry needed by the Piola maps at one point
+    template<class Geometry>
+    struct PiolaTransformation
+    {
+      typedef typename Geometry::ctype ctype;
+      static const int dim = Geometry::mydimension;
+
+      PiolaTransformation() = default;
+
+      PiolaTransformation(const Geometry& geometry,
+                          const FieldVector<ctype, dim>& x)
+      {
+        // the columns are taken by matrix-vector products, since the
+        // geometry may return structured matrices like a DiagonalMatrix,
+        // whose entries cannot be read by index
+        const auto& jt = geometry.jacobianTransposed(x);
+        const auto& jit = geometry.jacobianInverseTransposed(x);
+        for(int c = 0; c < dim; ++c)
+        {
+          FieldVector<ctype, dim> unit(0), column, inverseColumn;
+          unit[c] = 1;
+          jt.mtv(unit, column);
+          jit.mv(unit, inverseColumn);
+          for(int r = 0; r < dim; ++r)
+          {
+            jacobian[r][c] = column[r];
+            jacobianInverseTransposed[r][c] = inverseColumn[r];
+          }
+        }
+        determinant = jacobian.determinant();
+        integrationElement = geometry.integrationElement(x);
+      }
+
+      FieldMatrix<ctype, dim, dim> jacobian;
+      FieldMatrix<ctype, dim, dim> jacobianInverseTransposed;
+      ctype determinant;
+      ctype integrationElement;
+    };
+
+    // Common parts of the Piola adaptors: the affine fast path and the
+    // batched evaluation of the local basis
+    template<class LocalBasis, class Geometry>
+    class PiolaLocalToGlobalBasisAdaptorBase {
+      static_assert((std::is_same<typename LocalBasis::Traits::DomainFieldType,
+                                  typename Geometry::ctype>::value),
+                    "Piola adaptors: LocalBasis must use the same ctype as "
+                    "Geometry");
+      static_assert
+        ( static_cast<std::size_t>(LocalBasis::Traits::dimDomain) ==
+        static_cast<std::size_t>(Geometry::mydimension),
+        "Piola adaptors: LocalBasis domain dimension must match local "
+        "dimension of Geometry");
+      static_assert
+        ( static_cast<std::size_t>(Geometry::mydimension) ==
+        static_cast<std::size_t>(Geometry::coorddimension),
+        "Piola adaptors: the local and the global dimension of Geometry "
+        "must agree");
+      static_assert
+        ( static_cast<std::size_t>(LocalBasis::Traits::dimRange) ==
+        static_cast<std::size_t>(Geometry::mydimension),
+        "Piola adaptors: LocalBasis must be vector-valued with dimDomain "
+        "components");
+
+    protected:
+      typedef PiolaTransformation<Geometry> Transformation;
+      typedef typename LocalBasis::Traits::RangeType LocalRange;
+      typedef typename LocalBasis::Traits::JacobianType LocalJacobian;
+
+      const LocalBasis& localBasis;
+      Geometry geometry;
+
+      // The transformation if the geometry is affine
+      bool affine_;
+      Transformation transformation_;
+
+    public:
+      typedef LocalToGlobalBasisAdaptorTraits<typename LocalBasis::Traits,
+          Geometry::coorddimension> Traits;
+
+      PiolaLocalToGlobalBasisAdaptorBase(const LocalBasis& localBasis_,
+                                         const Geometry& geometry_) :
+        localBasis(localBasis_), geometry(geometry_),
+        affine_(geometry.affine()),
+        transformation_(affine_ ?
+                        Transformation(geometry, typename Traits::DomainLocal(0)) :
+                        Transformation())
+      { }
+
+      std::size_t size() const { return localBasis.size(); }
+
+      //! return maximum polynomial order of the base function
+      /**
+       * For an affine geometry this is the order of the local basis.  For
+       * other geometries the geometry is assumed to be multi-linear, and
+       * the global dimension minus 1 is added.
+       */
+      std::size_t order() const {
+        if(affine_)
+          return localBasis.order();
+        else
+          return localBasis.order() + Traits::dimDomainGlobal - 1;
+      }
+
+    protected:
+      // The transformation at the point x
+      Transformation transformation(const typename Traits::DomainLocal& x) const
+      {
+        return affine_ ? transformation_ : Transformation(geometry, x);
+      }
+
+      // Apply transform(transformation, in, out, n) to the size() entries
+      // of each point, or to all entries at once for an affine geometry
+      template<class In, class Out, class Transform>
+      void apply(const std::vector<typename Traits::DomainLocal>& points,
+                 const In* in, Out* out, Transform&& transform) const
+      {
+        if(affine_)
+          transform(transformation_, in, out, points.size()*size());
+        else
+          for(std::size_t p = 0; p < points.size(); ++p)
+            transform(Transformation(geometry, points[p]),
+                      in + p*size(), out + p*size(), size());
+      }
+
+      // Scratch buffers of this thread for the local values and Jacobians
+      const std::vector<LocalRange>&
+      localValues(const std::vector<typename Traits::DomainLocal>& points) const
+      {
+        static thread_local std::vector<LocalRange> values;
+        evaluateFunctionAtPoints(localBasis, points, values);
+        return values;
+      }
+
+      const std::vector<LocalJacobian>&
+      localJacobians(const std::vector<typename Traits::DomainLocal>& points) const
+      {
+        static thread_local std::vector<LocalJacobian> jacobians;
+        evaluateJacobianAtPoints(localBasis, points, jacobians);
+        return jacobians;
+      }
+    };
+
+  } // namespace Impl
+
+  //! Convert a local H(div) basis into a global basis by the contravariant Piola map
+  /**
+   * \f$v = \frac{1}{|\det\hat J|} \hat J \hat v\f$, see
+   * piolalocaltoglobaladaptors.hh.  The divergence is
+   * \f$\nabla\cdot v = \frac{1}{|\det\hat J|} \hat\nabla\cdot\hat v\f$.
+   *
+   * \tparam LocalBasis Type of the local basis to adapt.
+   * \tparam Geometry   Type of the local-to-global transformation.
+   *
+   * \implements BasisInterface
+   */
+  template<class LocalBasis, class Geometry>
+  class ContravariantPiolaLocalToGlobalBasisAdaptor :
+    public Impl::PiolaLocalToGlobalBasisAdaptorBase<LocalBasis, Geometry>
+  {
+    typedef Impl::PiolaLocalToGlobalBasisAdaptorBase<LocalBasis, Geometry> Base;
+    typedef typename Base::Transformation Transformation;
+    typedef typename Base::LocalRange LocalRange;
+    typedef typename Base::LocalJacobian LocalJacobian;
+
+    static const int dim = Geometry::mydimension;
+
+  public:
+    typedef typename Base::Traits Traits;
+
+    //! construct a ContravariantPiolaLocalToGlobalBasisAdaptor
+    /**
+     * \param localBasis_ The local basis object to adapt.
+     * \param geometry_   The geometry object to use for adaption.
+     *
+     * \note This class stores the reference to the local basis passed here.
+     *       Any use of this class after it has become invalid results in
+     *       undefined behaviour.
+     */
+    ContravariantPiolaLocalToGlobalBasisAdaptor(const LocalBasis& localBasis_,
+                                                const Geometry& geometry_) :
+      Base(localBasis_, geometry_)
+    { }
+
+    using Base::size;
+
+    void evaluateFunction(const typename Traits::DomainLocal& in,
+                          std::vector<typename Traits::Range>& out) const
+    {
+      static thread_local std::vector<LocalRange> values;
+      this->localBasis.evaluateFunction(in, values);
+      out.resize(size());
+      transformValues(this->transformation(in), values.data(), out.data(), size());
+    }
+
+    void evaluateJacobian(const typename Traits::DomainLocal& in,
+                          std::vector<typename Traits::Jacobian>& out) const
+    {
+      static thread_local std::vector<LocalJacobian> jacobians;
+      this->localBasis.evaluateJacobian(in, jacobians);
+      out.resize(size());
+      transformJacobians(this->transformation(in), jacobians.data(), out.data(), size());
+    }
+
+    //! evaluate the divergence of all shape functions
+    void evaluateDivergence(const typename Traits::DomainLocal& in,
+                            std::vector<typename Traits::RangeField>& out) const
+    {
+      static thread_local std::vector<LocalJacobian> jacobians;
+      this->localBasis.evaluateJacobian(in, jacobians);
+      out.resize(size());
+      transformDivergences(this->transformation(in), jacobians.data(), out.data(), size());
+    }
+
+    //! evaluate all shape functions at several points
+    void evaluateFunction(const std::vector<typename Traits::DomainLocal>& points,
+                          std::vector<typename Traits::Range>& out) const
+    {
+      const auto& values = this->localValues(points);
+      out.resize(points.size()*size());
+      this->apply(points, values.data(), out.data(), transformValues);
+    }
+
+    //! evaluate the Jacobians of all shape functions at several points
+    void evaluateJacobian(const std::vector<typename Traits::DomainLocal>& points,
+                          std::vector<typename Traits::Jacobian>& out) const
+    {
+      const auto& jacobians = this->localJacobians(points);
+      out.resize(points.size()*size());
+      this->apply(points, jacobians.data(), out.data(), transformJacobians);
+    }
+
+    //! evaluate the divergence of all shape functions at several points
+    void evaluateDivergence(const std::vector<typename Traits::DomainLocal>& points,
+                            std::vector<typename Traits::RangeField>& out) const
+    {
+      const auto& jacobians = this->localJacobians(points);
+      out.resize(points.size()*size());
+      this->apply(points, jacobians.data(), out.data(), transformDivergences);
+    }
+
+    //! pull a global vector at the local point x back to the reference element
+    /**
+     * This is the inverse of the transformation of the shape functions,
+     * \f$\hat v = |\det\hat J| \hat J^{-1} v\f$.
+     */
+    void pullBack(const typename Traits::DomainLocal& x,
+                  const typename Traits::Range& global, LocalRange& local) const
+    {
+      const Transformation t = this->transformation(x);
+      for(int c = 0; c < dim; ++c)
+      {
+        typename Traits::RangeField sum = 0;
+        for(int r = 0; r < dim; ++r)
+          sum += t.jacobianInverseTransposed[r][c] * global[r];
+        local[c] = t.integrationElement * sum;
+      }
+    }
+
+  private:
+    static void transformValues(const Transformation& t, const LocalRange* in,
+                                typename Traits::Range* out, std::size_t n)
+    {
+      FieldMatrix<typename Traits::DomainField, dim, dim> a = t.jacobian;
+      a /= t.integrationElement;
+      for(std::size_t m = 0; m < n; ++m)
+        a.mv(in[m], out[m]);
+    }
+
+    // (1/|det J|) J DvHat J^{-1}
+    static void transformJacobians(const Transformation& t, const LocalJacobian* in,
+                                   typename Traits::Jacobian* out, std::size_t n)
+    {
+      FieldMatrix<typename Traits::DomainField, dim, dim> a = t.jacobian;
+      a /= t.integrationElement;
+      const auto& b = t.jacobianInverseTransposed;
+      for(std::size_t m = 0; m < n; ++m)
+      {
+        // c = DvHat J^{-1}
+        LocalJacobian c;
+        for(int i = 0; i < dim; ++i)
+          for(int j = 0; j < dim; ++j)
+          {
+            typename Traits::RangeField sum = 0;
+            for(int l = 0; l < dim; ++l)
+              sum += in[m][i][l] * b[j][l];
+            c[i][j] = sum;
+          }
+        for(int i = 0; i < dim; ++i)
+          for(int j = 0; j < dim; ++j)
+          {
+            typename Traits::RangeField sum = 0;
+            for(int l = 0; l < dim; ++l)
+              sum += a[i][l] * c[l][j];
+            out[m][i][j] = sum;
+          }
+      }
+    }
+
+    static void transformDivergences(const Transformation& t, const LocalJacobian* in,
+                                     typename Traits::RangeField* out, std::size_t n)
+    {
+      const typename Traits::DomainField factor = 1 / t.integrationElement;
+      for(std::size_t m = 0; m < n; ++m)
+      {
+        typename Traits::RangeField trace = 0;
+        for(int i = 0; i < dim; ++i)
+          trace += in[m][i][i];
+        out[m] = factor * trace;
+      }
+    }
+  };
+
+  //! Convert a local H(curl) basis into a global basis by the covariant Piola map
+  /**
+   * \f$v = \hat J^{-T} \hat v\f$, see piolalocaltoglobaladaptors.hh.  The
+   * curl is \f$\nabla\times v = \frac{1}{\det\hat J} \hat J
+   * \hat\nabla\times\hat v\f$ in 3d and
+   * \f$\frac{1}{\det\hat J}\hat\nabla\times\hat v\f$ for the scalar curl
+   * \f$\partial_0 v_1 - \partial_1 v_0\f$ in 2d.
+   *
+   * \tparam LocalBasis Type of the local basis to adapt.
+   * \tparam Geometry   Type of the local-to-global transformation.
+   *
+   * \implements BasisInterface
+   */
+  template<class LocalBasis, class Geometry>
+  class CovariantPiolaLocalToGlobalBasisAdaptor :
+    public Impl::PiolaLocalToGlobalBasisAdaptorBase<LocalBasis, Geometry>
+  {
+    typedef Impl::PiolaLocalToGlobalBasisAdaptorBase<LocalBasis, Geometry> Base;
+    typedef typename Base::Transformation Transformation;
+    typedef typename Base::LocalRange LocalRange;
+    typedef typename Base::LocalJacobian LocalJacobian;
+
+    static const int dim = Geometry::mydimension;
+
+  public:
+    typedef typename Base::Traits Traits;
+
+    //! Type of the curl, a vector in 3d and a scalar in 2d
+    typedef FieldVector<typename Traits::RangeField, dim == 3 ? 3 : 1> Curl;
+
+    //! construct a CovariantPiolaLocalToGlobalBasisAdaptor
+    /**
+     * \param localBasis_ The local basis object to adapt.
+     * \param geometry_   The geometry object to use for adaption.
+     *
+     * \note This class stores the reference to the local basis passed here.
+     *       Any use of this class after it has become invalid results in
+     *       undefined behaviour.
+     */
+    CovariantPiolaLocalToGlobalBasisAdaptor(const LocalBasis& localBasis_,
+                                            const Geometry& geometry_) :
+      Base(localBasis_, geometry_)
+    { }
+
+    using Base::size;
+
+    void evaluateFunction(const typename Traits::DomainLocal& in,
+                          std::vector<typename Traits::Range>& out) const
+    {
+      static thread_local std::vector<LocalRange> values;
+      this->localBasis.evaluateFunction(in, values);
+      out.resize(size());
+      transformValues(this->transformation(in), values.data(), out.data(), size());
+    }
+
+    void evaluateJacobian(const typename Traits::DomainLocal& in,
+                          std::vector<typename Traits::Jacobian>& out) const
+    {
+      static thread_local std::vector<LocalJacobian> jacobians;
+      this->localBasis.evaluateJacobian(in, jacobians);
+      out.resize(size());
+      transformJacobians(this->transformation(in), jacobians.data(), out.data(), size());
+    }
+
+    //! evaluate the curl of all shape functions, only in 2d and 3d
+    void evaluateCurl(const typename Traits::DomainLocal& in,
+                      std::vector<Curl>& out) const
+    {
+      static thread_local std::vector<LocalJacobian> jacobians;
+      this->localBasis.evaluateJacobian(in, jacobians);
+      out.resize(size());
+      transformCurls(this->transformation(in), jacobians.data(), out.data(), size());
+    }
+
+    //! evaluate all shape functions at several points
+    void evaluateFunction(const std::vector<typename Traits::DomainLocal>& points,
+                          std::vector<typename Traits::Range>& out) const
+    {
+      const auto& values = this->localValues(points);
+      out.resize(points.size()*size());
+      this->apply(points, values.data(), out.data(), transformValues);
+    }
+
+    //! evaluate the Jacobians of all shape functions at several points
+    void evaluateJacobian(const std::vector<typename Traits::DomainLocal>& points,
+                          std::vector<typename Traits::Jacobian>& out) const
+    {
+      const auto& jacobians = this->localJacobians(points);
+      out.resize(points.size()*size());
+      this->apply(points, jacobians.data(), out.data(), transformJacobians);
+    }
+
+    //! evaluate the curl of all shape functions at several points, only in 2d and 3d
+    void evaluateCurl(const std::vector<typename Traits::DomainLocal>& points,
+                      std::vector<Curl>& out) const
+    {
+      const auto& jacobians = this->localJacobians(points);
+      out.resize(points.size()*size());
+      this->apply(points, jacobians.data(), out.data(), transformCurls);
+    }
+
+    //! pull a global vector at the local point x back to the reference element
+    /**
+     * This is the inverse of the transformation of the shape functions,
+     * \f$\hat v = \hat J^T v\f$.
+     */
+    void pullBack(const typename Traits::DomainLocal& x,
+                  const typename Traits::Range& global, LocalRange& local) const
+    {
+      this->transformation(x).jacobian.mtv(global, local);
+    }
+
+  private:
+    static void transformValues(const Transformation& t, const LocalRange* in,
+                                typename Traits::Range* out, std::size_t n)
+    {
+      const auto& a = t.jacobianInverseTransposed;
+      for(std::size_t m = 0; m < n; ++m)
+        a.mv(in[m], out[m]);
+    }
+
+    // J^{-T} DvHat J^{-1}
+    static void transformJacobians(const Transformation& t, const LocalJacobian* in,
+                                   typename Traits::Jacobian* out, std::size_t n)
+    {
+      const auto& a = t.jacobianInverseTransposed;
+      for(std::size_t m = 0; m < n; ++m)
+      {
+        // c = DvHat J^{-1}
+        LocalJacobian c;
+        for(int i = 0; i < dim; ++i)
+          for(int j = 0; j < dim; ++j)
+          {
+            typename Traits::RangeField sum = 0;
+            for(int l = 0; l < dim; ++l)
+              sum += in[m][i][l] * a[j][l];
+            c[i][j] = sum;
+          }
+        for(int i = 0; i < dim; ++i)
+          for(int j = 0; j < dim; ++j)
+          {
+            typename Traits::RangeField sum = 0;
+            for(int l = 0; l < dim; ++l)
+              sum += a[i][l] * c[l][j];
+            out[m][i][j] = sum;
+          }
+      }
+    }
+
+    static void transformCurls(const Transformation& t, const LocalJacobian* in,
+                               Curl* out, std::size_t n)
+    {
+      static_assert(dim == 2 || dim == 3,
+                    "The curl is only defined in 2d and 3d");
+      const typename Traits::DomainField factor = 1 / t.determinant;
+      for(std::size_t m = 0; m < n; ++m)
+      {
+        if(dim == 2)
+          out[m][0] = factor * (in[m][1][0] - in[m][0][1]);
+        else
+        {
+          // the curl on the reference element
+          FieldVector<typename Traits::RangeField, dim> curl;
+          for(int i = 0; i < dim; ++i)
+            curl[i] = in[m][(i+2)%dim][(i+1)%dim] - in[m][(i+1)%dim][(i+2)%dim];
+          for(int i = 0; i < static_cast<int>(Curl::dimension); ++i)
+          {
+            typename Traits::RangeField sum = 0;
+            for(int l = 0; l < dim; ++l)
+              sum += t.jacobian[i][l] * curl[l];
+            out[m][i] = factor * sum;
+          }
+        }
+      }
+    }
+  };
+
+  //! Convert a local interpolation into a global interpolation for a Piola adaptor
+  /**
+   * The global function is evaluated at local coordinates, as for
+   * LocalToGlobalInterpolationAdaptor, and its values are pulled back to
+   * the reference element before they are passed to the local
+   * interpolation.
+   *
+   * \tparam LocalInterpolation Type of the local interpolation to adapt.
+   * \tparam Basis              Type of the Piola basis adaptor.
+   *
+   * \implements InterpolationInterface
+   */
+  template<class LocalInterpolation, class Basis>
+  class PiolaLocalToGlobalInterpolationAdaptor {
+    const LocalInterpolation& localInterpolation;
+    const Basis& basis;
+
+    // The pullback of a global function
+    template<class Function>
+    struct PulledBackFunction
+    {
+      // the global and the local range type agree
+      struct Traits {
+        typedef typename Basis::Traits::DomainLocal DomainType;
+        typedef typename Basis::Traits::Range RangeType;
+      };
+
+      const Function& function;
+      const Basis& basis;
+
+      template<class Domain, class LocalRange>
+      void evaluate(const Domain& x, LocalRange& y) const
+      {
+        typename Basis::Traits::Range global;
+        function.evaluate(x, global);
+        basis.pullBack(x, global, y);
+      }
+    };
+
+  public:
+    typedef typename Basis::Traits Traits;
+
+    //! construct a PiolaLocalToGlobalInterpolationAdaptor
+    /**
+     * \note This class stores the references passed here.  Any use of this
+     *       class after these references have become invalid results in
+     *       undefined behaviour.
+     */
+    PiolaLocalToGlobalInterpolationAdaptor
+      ( const LocalInterpolation& localInterpolation_, const Basis& basis_) :
+      localInterpolation(localInterpolation_), basis(basis_)
+    { }
+
+    template<class Function, class Coeff>
+    void interpolate(const Function& function, std::vector<Coeff>& out) const
+    {
+      localInterpolation.interpolate(PulledBackFunction<Function>{function, basis}, out);
+    }
+  };
+
+  namespace Impl {
+
+    // A local finite element transformed by a Piola basis adaptor
+    template<class LocalFiniteElement, class BasisAdaptor>
+    class PiolaLocalToGlobalFiniteElementAdaptor {
+    public:
+      struct Traits {
+        typedef BasisAdaptor Basis;
+        typedef PiolaLocalToGlobalInterpolationAdaptor<typename LocalFiniteElement::
+            Traits::LocalInterpolationType, Basis> Interpolation;
+        typedef typename LocalFiniteElement::Traits::LocalCoefficientsType
+        Coefficients;
+      };
+
+    private:
+      const LocalFiniteElement &localFE;
+      typename Traits::Basis basis_;
+      typename Traits::Interpolation interpolation_;
+
+    public:
+      template<class Geometry>
+      PiolaLocalToGlobalFiniteElementAdaptor
+        ( const LocalFiniteElement& localFE_, const Geometry &geometry) :
+        localFE(localFE_),
+        basis_(localFE.localBasis(), geometry),
+        interpolation_(localFE.localInterpolation(), basis_)
+      { }
+
+      // interpolation_ refers to basis_
+      PiolaLocalToGlobalFiniteElementAdaptor
+        ( const PiolaLocalToGlobalFiniteElementAdaptor& other) :
+        localFE(other.localFE),
+        basis_(other.basis_),
+        interpolation_(localFE.localInterpolation(), basis_)
+      { }
+
+      const typename Traits::Basis& basis() const { return basis_; }
+      const typename Traits::Interpolation& interpolation() const
+      { return interpolation_; }
+      const typename Traits::Coefficients& coefficients() const
+      { return localFE.localCoefficients(); }
+      GeometryType type() const { return localFE.type(); }
+    };
+
+  } // namespace Impl
+
+  //! Convert a local H(div) finite element into a global finite element
+  /**
+   * The shape functions are transformed by the contravariant Piola map,
+   * see ContravariantPiolaLocalToGlobalBasisAdaptor.
+   *
+   * \tparam LocalFiniteElement Type of the local finite element to adapt.
+   * \tparam Geometry           Type of the local-to-global transformation.
+   *
+   * \note This class stores the reference to the local finite element
+   *       passed to its constructor.
+   *
+   * \implements FiniteElementInterface
+   */
+  template<class LocalFiniteElement, class Geometry>
+  using ContravariantPiolaLocalToGlobalAdaptor =
+    Impl::PiolaLocalToGlobalFiniteElementAdaptor<LocalFiniteElement,
+      ContravariantPiolaLocalToGlobalBasisAdaptor<typename LocalFiniteElement::
+        Traits::LocalBasisType, Geometry> >;
+
+  //! Convert a local H(curl) finite element into a global finite element
+  /**
+   * The shape functions are transformed by the covariant Piola map, see
+   * CovariantPiolaLocalToGlobalBasisAdaptor.
+   *
+   * \tparam LocalFiniteElement Type of the local finite element to adapt.
+   * \tparam Geometry           Type of the local-to-global transformation.
+   *
+   * \note This class stores the reference to the local finite element
+   *       passed to its constructor.
+   *
+   * \implements FiniteElementInterface
+   */
+  template<class LocalFiniteElement, class Geometry>
+  using CovariantPiolaLocalToGlobalAdaptor =
+    Impl::PiolaLocalToGlobalFiniteElementAdaptor<LocalFiniteElement,
+      CovariantPiolaLocalToGlobalBasisAdaptor<typename LocalFiniteElement::
+        Traits::LocalBasisType, Geometry> >;
+
+} // namespace Dune
+
+#endif // DUNE_LOCALFUNCTIONS_COMMON_PIOLALOCALTOGLOBALADAPTORS_HH
@@ -0,0 +1,398 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#ifndef DUNE_LOCALFUNCTIONS_COMMON_TABULATIONCACHE_HH
+#define DUNE_LOCALFUNCTIONS_COMMON_TABULATIONCACHE_HH
+
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <typeindex>
+#include <typeinfo>
+#include <vector>
+
+#include <dune/common/alignedallocator.hh>
+#include <dune/common/exceptions.hh>
+#include <dune/common/fmatrix.hh>
+
+#include <dune/geometry/type.hh>
+
+#include <dune/localfunctions/common/batchedevaluation.hh>
+
+namespace Dune
+{
+
+  /** \brief Values and derivatives of all shape functions of a local basis
+   *         at all points of a quadrature rule
+   *
+   * The data is stored point by point in contiguous arrays aligned to
+   * cache lines, i.e. the entries for the shape functions at one point
+   * are adjacent in memory.  Objects of this class are immutable and
+   * are usually obtained from a LocalBasisTabulationCache.
+   *
+   * \tparam T The LocalBasisTraits of the tabulated basis
+   */
+  template<class T>
+  class LocalBasisTabulation
+  {
+  public:
+    typedef T Traits;
+
+    typedef typename Traits::RangeType RangeType;
+    typedef typename Traits::JacobianType JacobianType;
+
+    /** \brief Type of the second derivatives of a shape function
+     *
+     * hessian[c][j][l] is the derivative of component c with respect to the
+     * local coordinates j and l.
+     */
+    typedef std::array<FieldMatrix<typename Traits::RangeFieldType,Traits::dimDomain,Traits::dimDomain>,Traits::dimRange> HessianType;
+
+    //! Alignment of the stored arrays in bytes
+    static const std::size_t alignment = 64;
+
+    template<class U>
+    using Storage = std::vector<U, AlignedAllocator<U,alignment> >;
+
+    /** \brief Tabulate a local basis at the given points
+     *
+     * \param localBasis The local basis to tabulate
+     * \param points The points to tabulate at
+     * \param diffOrder The highest derivative order to tabulate, at most 2.
+     *                  Second derivatives are obtained from the partial()
+     *                  method of the basis.
+     */
+    template<class LocalBasis>
+    LocalBasisTabulation (const LocalBasis& localBasis,
+                          const std::vector<typename Traits::DomainType>& points,
+                          unsigned int diffOrder)
+      : size_(localBasis.size()),
+        numPoints_(points.size()),
+        diffOrder_(diffOrder)
+    {
+      if (diffOrder > 2)
+        DUNE_THROW(NotImplemented, "Tabulation of derivatives of order " << diffOrder << " is not implemented");
+
+      std::vector<RangeType> values;
+      evaluateFunctionAtPoints(localBasis, points, values);
+      values_.assign(values.begin(), values.end());
+
+      if (diffOrder > 0)
+      {
+        std::vector<JacobianType> jacobians;
+        evaluateJacobianAtPoints(localBasis, points, jacobians);
+        jacobians_.assign(jacobians.begin(), jacobians.end());
+      }
+
+      if (diffOrder > 1)
+      {
+        hessians_.resize(numPoints_*size_);
+        for (int j=0; j<Traits::dimDomain; j++)
+          for (int l=0; l<=j; l++)
+          {
+            std::array<unsigned int,Traits::dimDomain> order;
+            order.fill(0);
+            order[j]++;
+            order[l]++;
+            for (std::size_t p=0; p<numPoints_; p++)
+            {
+              localBasis.partial(order, points[p], values);
+              for (std::size_t i=0; i<size_; i++)
+                for (int c=0; c<Traits::dimRange; c++)
+                {
+                  hessians_[p*size_+i][c][j][l] = values[i][c];
+                  hessians_[p*size_+i][c][l][j] = values[i][c];
+                }
+            }
+          }
+      }
+    }
+
+    //! Number of shape functions
+    std::size_t size () const { return size_; }
+
+    //! Number of points
+    std::size_t numPoints () const { return numPoints_; }
+
+    //! Highest tabulated derivative order
+    unsigned int diffOrder () const { return diffOrder_; }
+
+    //! Values of all shape functions at point p
+    const RangeType* values (std::size_t p) const
+    {
+      return values_.data() + p*size_;
+    }
+
+    //! Jacobians of all shape functions at point p, requires diffOrder() >= 1
+    const JacobianType* jacobians (std::size_t p) const
+    {
+      assert(diffOrder_ >= 1);
+      return jacobians_.data() + p*size_;
+    }
+
+    //! Second derivatives of all shape functions at point p, requires diffOrder() >= 2
+    const HessianType* hessians (std::size_t p) const
+    {
+      assert(diffOrder_ >= 2);
+      return hessians_.data() + p*size_;
+    }
+
+    //! Value of shape function i at point p
+    const RangeType& value (std::size_t p, std::size_t i) const
+    {
+      return values(p)[i];
+    }
+
+    //! Jacobian of shape function i at point p
+    const JacobianType& jacobian (std::size_t p, std::size_t i) const
+    {
+      return jacobians(p)[i];
+    }
+
+    //! Second derivatives of shape function i at point p
+    const HessianType& hessian (std::size_t p, std::size_t i) const
+    {
+      return hessians(p)[i];
+    }
+
+    //! Memory used by the tabulated data in bytes
+    std::size_t memory () const
+    {
+      return values_.size()*sizeof(RangeType)
+             + jacobians_.size()*sizeof(JacobianType)
+             + hessians_.size()*sizeof(HessianType);
+    }
+
+  private:
+    std::size_t size_;
+    std::size_t numPoints_;
+    unsigned int diffOrder_;
+    Storage<RangeType> values_;
+    Storage<JacobianType> jacobians_;
+    Storage<HessianType> hessians_;
+  };
+
+
+
+  /** \brief Shared cache of tabulations of local bases at quadrature points
+   *
+   * Assemblers evaluate the same reference basis at the same quadrature
+   * points on every element.  This cache computes the LocalBasisTabulation
+   * once and hands out shared references to it.
+   *
+   * Entries are identified by the type and address of the local basis, the
+   * address, geometry type, order and size of the quadrature rule, and the
+   * derivative order.  A request for a lower derivative order is answered
+   * by an existing entry of higher order.  The basis and the rule have to
+   * stay alive and unchanged as long as their entries are used, which is
+   * the case for rules obtained from Dune::QuadratureRules and for the
+   * bases of long-lived finite element objects.  Both static local bases
+   * and LocalBasisVirtualInterface objects can be used.
+   *
+   * The cache may be used from several threads concurrently.  Lookups of
+   * existing entries read an immutable snapshot of the table, which is
+   * obtained by std::atomic_load of a shared_ptr; this may take a short
+   * internal lock of the standard library, but lookups never wait for the
+   * tabulation or the insertion of another thread.  Insertions copy the
+   * table under a mutex.  When the memory of all entries exceeds the
+   * capacity, the least recently used entries are removed from the cache;
+   * tabulations still held by a caller stay valid.
+   *
+   * The recency of an entry is tracked per insertion: a lookup marks the
+   * entry as used after all entries inserted so far, and writes to it only
+   * the first time after each insertion.  So lookups share no written
+   * memory in the steady state, and entries used between two insertions
+   * are treated as equally recent.
+   *
+   * \tparam T The LocalBasisTraits of the cached bases
+   */
+  template<class T>
+  class LocalBasisTabulationCache
+  {
+  public:
+    typedef T Traits;
+    typedef LocalBasisTabulation<Traits> Tabulation;
+
+    //! Default capacity in bytes
+    static const std::size_t defaultCapacity = std::size_t(64) << 20;
+
+    /** \brief Create an empty cache
+     *
+     * \param capacity Upper bound for the memory of the cached tabulations
+     *                 in bytes.  The most recent entry is always kept, even
+     *                 if it exceeds the capacity on its own.
+     */
+    explicit LocalBasisTabulationCache (std::size_t capacity = defaultCapacity)
+      : entries_(std::make_shared<Map>()),
+        capacity_(capacity),
+        clock_(0)
+    {}
+
+    LocalBasisTabulationCache (const LocalBasisTabulationCache&) = delete;
+    LocalBasisTabulationCache &operator= (const LocalBasisTabulationCache&) = delete;
+
+    //! A global cache for bases with traits T
+    static LocalBasisTabulationCache &instance ()
+    {
+      static LocalBasisTabulationCache cache;
+      return cache;
+    }
+
+    /** \brief Get the tabulation of a local basis at the points of a quadrature rule
+     *
+     * \param localBasis The local basis
+     * \param rule The quadrature rule
+     * \param diffOrder The highest derivative order needed
+     */
+    template<class LocalBasis, class QuadratureRule>
+    std::shared_ptr<const Tabulation> get (const LocalBasis& localBasis,
+                                           const QuadratureRule& rule,
+                                           unsigned int diffOrder = 1)
+    {
+      const Key key(std::type_index(typeid(localBasis)), &localBasis, localBasis.size(), localBasis.order(),
+                    &rule, rule.type().id(), rule.type().dim(), rule.order(), rule.size(), diffOrder);
+
+      if (auto tabulation = find(*std::atomic_load(&entries_), key))
+        return tabulation;
+
+      std::vector<typename Traits::DomainType> points(rule.size());
+      for (std::size_t p=0; p<rule.size(); p++)
+        points[p] = rule[p].position();
+      auto tabulation = std::make_shared<const Tabulation>(localBasis, points, diffOrder);
+
+      std::lock_guard<std::mutex> guard(mutex_);
+
+      // another thread might have filled the entry in the meantime
+      std::shared_ptr<const Map> entries = std::atomic_load(&entries_);
+      if (auto existing = find(*entries, key))
+        return existing;
+
+      auto newEntries = std::make_shared<Map>(*entries);
+      // the new entry is newer than all others, and the entries found
+      // after this insertion are newer than the new entry
+      const std::uint64_t now = clock_.fetch_add(2, std::memory_order_relaxed) + 1;
+      auto& newEntry = (*newEntries)[key];
+      newEntry = std::make_shared<Entry>(tabulation, now);
+      evict(*newEntries, newEntry);
+      std::atomic_store(&entries_, std::shared_ptr<const Map>(std::move(newEntries)));
+
+      return tabulation;
+    }
+
+    //! Get the tabulation of the basis of a local finite element
+    template<class LocalFiniteElement, class QuadratureRule>
+    std::shared_ptr<const Tabulation> getFromFiniteElement (const LocalFiniteElement& fe,
+                                                            const QuadratureRule& rule,
+                                                            unsigned int diffOrder = 1)
+    {
+      return get(fe.localBasis(), rule, diffOrder);
+    }
+
+    //! Number of cached tabulations
+    std::size_t size () const
+    {
+      return std::atomic_load(&entries_)->size();
+    }
+
+    //! Memory of all cached tabulations in bytes
+    std::size_t memory () const
+    {
+      std::size_t memory = 0;
+      for (const auto& entry : *std::atomic_load(&entries_))
+        memory += entry.second->tabulation->memory();
+      return memory;
+    }
+
+    //! Upper bound for the memory of the cached tabulations in bytes
+    std::size_t capacity () const
+    {
+      return capacity_;
+    }
+
+    //! Remove all entries
+    void clear ()
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      std::atomic_store(&entries_, std::shared_ptr<const Map>(std::make_shared<Map>()));
+    }
+
+  private:
+    // basis type, basis address, basis size, basis order,
+    // rule address, rule topology id, rule dimension, rule order, rule size,
+    // derivative order
+    typedef std::tuple<std::type_index, const void*, std::size_t, unsigned int,
+        const void*, unsigned int, unsigned int, int, std::size_t,
+        unsigned int> Key;
+
+    struct Entry
+    {
+      Entry (std::shared_ptr<const Tabulation> t, std::uint64_t time)
+        : tabulation(std::move(t)), lastUsed(time)
+      {}
+
+      std::shared_ptr<const Tabulation> tabulation;
+      mutable std::atomic<std::uint64_t> lastUsed;
+    };
+
+    typedef std::map<Key, std::shared_ptr<Entry> > Map;
+
+    // Find an entry for key with at least the requested derivative order
+    std::shared_ptr<const Tabulation> find (const Map& entries, const Key& key) const
+    {
+      auto it = entries.lower_bound(key);
+      if (it == entries.end() or not sameExceptDiffOrder(it->first, key))
+        return nullptr;
+      // write the stamp only if it is older than the last insertion
+      const std::uint64_t now = clock_.load(std::memory_order_relaxed);
+      if (it->second->lastUsed.load(std::memory_order_relaxed) != now)
+        it->second->lastUsed.store(now, std::memory_order_relaxed);
+      return it->second->tabulation;
+    }
+
+    static bool sameExceptDiffOrder (const Key& a, const Key& b)
+    {
+      Key c = b;
+      std::get<9>(c) = std::get<9>(a);
+      return a == c;
+    }
+
+    // Remove least recently used entries other than keep until the capacity is respected
+    void evict (Map& entries, const std::shared_ptr<Entry>& keep) const
+    {
+      std::size_t memory = 0;
+      for (const auto& entry : entries)
+        memory += entry.second->tabulation->memory();
+
+      while (memory > capacity_ and entries.size() > 1)
+      {
+        auto oldest = entries.end();
+        for (auto it = entries.begin(); it != entries.end(); ++it)
+          if (it->second != keep and (oldest == entries.end()
+                                      or it->second->lastUsed.load(std::memory_order_relaxed)
+                                         < oldest->second->lastUsed.load(std::memory_order_relaxed)))
+            oldest = it;
+        memory -= oldest->second->tabulation->memory();
+        entries.erase(oldest);
+      }
+    }
+
+    std::shared_ptr<const Map> entries_;
+    std::size_t capacity_;
+    std::atomic<std::uint64_t> clock_;
+    std::mutex mutex_;
+  };
+
+  template<class T>
+  const std::size_t LocalBasisTabulationCache<T>::defaultCapacity;
+
+  template<class T>
+  const std::size_t LocalBasisTabulation<T>::alignment;
+
+} // namespace Dune
+
+#endif // DUNE_LOCALFUNCTIONS_COMMON_TABULATIONCACHE_HH
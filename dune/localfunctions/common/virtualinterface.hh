@@ -10,6 +10,7 @@
 
 #include <dune/geometry/type.hh>
 
+#include <dune/localfunctions/common/batchedevaluation.hh>
 #include <dune/localfunctions/common/localbasis.hh>
 #include <dune/localfunctions/common/localkey.hh>
 #include <dune/localfunctions/common/localfiniteelementtraits.hh>
@@ -98,6 +99,34 @@ namespace Dune
     virtual void evaluateJacobian(const typename Traits::DomainType& in,         // position
                                   std::vector<typename Traits::JacobianType>& out) const = 0;
 
+    /** \brief Evaluate all shape functions at several positions
+     *
+     * out[p*size()+i] is the value of the i'th shape function at points[p].
+     * The default implementation evaluates the basis point by point.
+     *
+     * \param [in]  points The positions where evaluated
+     * \param [out] out    The result
+     */
+    virtual void evaluateFunction (const std::vector<typename Traits::DomainType>& points,
+                                   std::vector<typename Traits::RangeType>& out) const
+    {
+      Impl::evaluateFunctionAtPoints(*this, points, out, PriorityTag<0>());
+    }
+
+    /** \brief Evaluate jacobian of all shape functions at several positions
+     *
+     * out[p*size()+i] is the jacobian of the i'th shape function at points[p].
+     * The default implementation evaluates the basis point by point.
+     *
+     * \param [in]  points The positions where evaluated
+     * \param [out] out    The result
+     */
+    virtual void evaluateJacobian (const std::vector<typename Traits::DomainType>& points,
+                                   std::vector<typename Traits::JacobianType>& out) const
+    {
+      Impl::evaluateJacobianAtPoints(*this, points, out, PriorityTag<0>());
+    }
+
     /** \brief Evaluate partial derivatives of any order of all shape functions
      * \param order Order of the partial derivatives, in the classic multi-index notation
      * \param in Position where to evaluate the derivatives
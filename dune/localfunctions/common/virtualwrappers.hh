@@ -7,6 +7,7 @@
 
 #include <dune/common/function.hh>
 
+#include <dune/localfunctions/common/batchedevaluation.hh>
 #include <dune/localfunctions/common/localbasis.hh>
 #include <dune/localfunctions/common/localkey.hh>
 #include <dune/localfunctions/common/virtualinterface.hh>
@@ -113,6 +114,22 @@ namespace Dune
       impl_.evaluateJacobian(in,out);
     }
 
+    //! @copydoc LocalBasisVirtualInterface::evaluateFunction(const std::vector<typename Traits::DomainType>&,std::vector<typename Traits::RangeType>&) const
+    inline void evaluateFunction (
+      const std::vector<typename Traits::DomainType>& points,
+      std::vector<typename Traits::RangeType>& out) const
+    {
+      evaluateFunctionAtPoints(impl_,points,out);
+    }
+
+    //! @copydoc LocalBasisVirtualInterface::evaluateJacobian(const std::vector<typename Traits::DomainType>&,std::vector<typename Traits::JacobianType>&) const
+    inline void evaluateJacobian (
+      const std::vector<typename Traits::DomainType>& points,
+      std::vector<typename Traits::JacobianType>& out) const
+    {
+      evaluateJacobianAtPoints(impl_,points,out);
+    }
+
     /** \brief Evaluate partial derivatives of any order of all shape functions
      * \param order Order of the partial derivatives, in the classic multi-index notation
      * \param in Position where to evaluate the derivatives
@@ -28,9 +28,10 @@ namespace Dune
    *
    * Examples include:
    * - EqualdistantPointSet: standard point set for lagrange points
-   * - LobattoPointSet:      an approximate Freget type point set
-   *                         (provided for simplex and generalized prism
-   *                         topologies (i.e. not for a 3d pyramid)
+   * - LobattoPointSet:      Gauss-Lobatto points on cubes and recursive
+   *                         Lobatto points on simplices, with small
+   *                         Lebesgue constants (provided for all
+   *                         topologies up to dimension 3)
    *
    * \ingroup Lagrange
    *
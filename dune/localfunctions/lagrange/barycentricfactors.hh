@@ -0,0 +1,174 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#ifndef DUNE_LOCALFUNCTIONS_LAGRANGE_BARYCENTRICFACTORS_HH
+#define DUNE_LOCALFUNCTIONS_LAGRANGE_BARYCENTRICFACTORS_HH
+
+#include <array>
+
+namespace Dune
+{
+  namespace Impl
+  {
+
+    /** \brief Factor tables of the equidistant Lagrange shape functions of
+     *         order k on the reference simplex of dimension dim
+     *
+     * The shape function with the barycentric lattice index
+     * (alpha_0,...,alpha_dim), |alpha| = k, is the product
+     * \f[ \prod_{m=0}^{dim} L_{\alpha_m}(\lambda_m), \qquad
+     *     L_i(\lambda) = \prod_{j=0}^{i-1} \frac{k\lambda-j}{i-j}, \f]
+     * of 1d factors in the barycentric coordinates
+     * \f$\lambda_m = x_m\f$ for m < dim and \f$\lambda_{dim} = 1 - \sum_m x_m\f$.
+     * tabulate() computes the values and derivatives of the L_i for
+     * i = 0,...,k at a single point by the recursion
+     * \f$L_i = L_{i-1} \cdot (k\lambda-i+1)/i\f$, i.e., in O(dim k) operations
+     * with the reciprocals 1/i taken from a table.  Afterwards each shape
+     * function and each of its derivatives costs O(dim) products of table
+     * entries, and all N shape functions cost O(N dim + dim k).
+     */
+    template<class R, unsigned int k, int dim>
+    class BarycentricLagrangeFactors
+    {
+      typedef std::array<R,k+1> Table;
+
+      // The reciprocals 1/i of the denominators, and 0 for i=0
+      static const Table& reciprocals ()
+      {
+        static const Table reciprocals = [] () {
+            Table reciprocals;
+            reciprocals[0] = R(0);
+            for (unsigned int i=1; i<=k; i++)
+              reciprocals[i] = R(1) / R(i);
+            return reciprocals;
+          } ();
+        return reciprocals;
+      }
+
+    public:
+      /** \brief Tabulate the factors and their derivatives up to diffOrder
+       *         (at most 2) at the point x
+       */
+      template<class Domain>
+      void tabulate (const Domain& x, int diffOrder)
+      {
+        R last(1);
+        for (int m=0; m<dim; m++)
+        {
+          tabulate(R(x[m]), diffOrder, m);
+          last -= R(x[m]);
+        }
+        tabulate(last, diffOrder, dim);
+      }
+
+      //! \brief The factor L_i of the barycentric coordinate m
+      const R& value (int m, unsigned int i) const
+      {
+        return value_[m][i];
+      }
+
+      //! \brief The derivative of L_i with respect to lambda_m
+      const R& derivative (int m, unsigned int i) const
+      {
+        return derivative_[m][i];
+      }
+
+      /** \brief The gradient of the shape function with the barycentric
+       *         lattice index alpha, written to gradient[0],...,gradient[dim-1]
+       */
+      template<class Gradient>
+      void gradient (const unsigned int* alpha, Gradient& gradient) const
+      {
+        // prefix[m] and suffix[m] are the products of the factors of
+        // lambda_0,...,lambda_{m-1} and of lambda_{m+1},...,lambda_{dim-1}
+        std::array<R,dim+1> prefix, suffix;
+        prefix[0] = R(1);
+        for (int m=0; m<dim; m++)
+          prefix[m+1] = prefix[m] * value_[m][alpha[m]];
+        suffix[dim-1] = value_[dim][alpha[dim]];
+        for (int m=dim-1; m>0; m--)
+          suffix[m-1] = suffix[m] * value_[m][alpha[m]];
+
+        // lambda_dim contributes the same term to all directions
+        const R last = derivative_[dim][alpha[dim]] * prefix[dim];
+        for (int a=0; a<dim; a++)
+          gradient[a] = derivative_[a][alpha[a]] * prefix[a] * suffix[a] - last;
+      }
+
+      /** \brief The derivative in direction a of the shape function with the
+       *         barycentric lattice index alpha
+       */
+      R partial (const unsigned int* alpha, int a) const
+      {
+        // only lambda_a and lambda_dim depend on x_a
+        R dLa = derivative_[a][alpha[a]];
+        R dLd = derivative_[dim][alpha[dim]];
+        for (int m=0; m<dim; m++)
+          if (m != a)
+          {
+            dLa *= value_[m][alpha[m]];
+            dLd *= value_[m][alpha[m]];
+          }
+        return dLa * value_[dim][alpha[dim]] - dLd * value_[a][alpha[a]];
+      }
+
+      /** \brief The second derivative in directions a and b of the shape
+       *         function with the barycentric lattice index alpha
+       */
+      R partial (const unsigned int* alpha, int a, int b) const
+      {
+        // d lambda_a / d x_a = 1 and d lambda_dim / d x_a = -1
+        const int first[2] = { a, dim };
+        const int second[2] = { b, dim };
+        R result(0);
+        for (int s=0; s<2; s++)
+          for (int t=0; t<2; t++)
+          {
+            const int m = first[s], n = second[t];
+            R product = (m == n) ? secondDerivative_[m][alpha[m]]
+                                 : derivative_[m][alpha[m]] * derivative_[n][alpha[n]];
+            for (int l=0; l<=dim; l++)
+              if (l != m and l != n)
+                product *= value_[l][alpha[l]];
+            if (s == t)
+              result += product;
+            else
+              result -= product;
+          }
+        return result;
+      }
+
+    private:
+      // Tabulate the factors of the barycentric coordinate m with value lambda
+      void tabulate (const R& lambda, int diffOrder, int m)
+      {
+        const Table& r = reciprocals();
+        const R t = R(k) * lambda;
+        Table& L = value_[m];
+        Table& dL = derivative_[m];
+        Table& ddL = secondDerivative_[m];
+
+        L[0] = R(1);
+        for (unsigned int i=1; i<=k; i++)
+          L[i] = L[i-1] * (t - R(i-1)) * r[i];
+        if (diffOrder < 1)
+          return;
+
+        // d/dlambda (k lambda - i + 1)/i = k/i
+        dL[0] = R(0);
+        for (unsigned int i=1; i<=k; i++)
+          dL[i] = (dL[i-1] * (t - R(i-1)) + L[i-1] * R(k)) * r[i];
+        if (diffOrder < 2)
+          return;
+
+        ddL[0] = R(0);
+        for (unsigned int i=1; i<=k; i++)
+          ddL[i] = (ddL[i-1] * (t - R(i-1)) + R(2) * dL[i-1] * R(k)) * r[i];
+      }
+
+      std::array<Table,dim+1> value_, derivative_, secondDerivative_;
+    };
+
+  } // namespace Impl
+} // namespace Dune
+
+#endif // #ifndef DUNE_LOCALFUNCTIONS_LAGRANGE_BARYCENTRICFACTORS_HH
@@ -3,9 +3,11 @@
 #ifndef DUNE_LAGRANGEBASIS_INTERPOLATION_HH
 #define DUNE_LAGRANGEBASIS_INTERPOLATION_HH
 
+#include <cstddef>
 #include <vector>
 #include <dune/geometry/topologyfactory.hh>
 #include <dune/localfunctions/lagrange/lagrangecoefficients.hh>
+#include <dune/localfunctions/utility/executor.hh>
 
 namespace Dune
 {
@@ -62,14 +64,15 @@ namespace Dune
     template< class Matrix, class Basis >
     void interpolate ( const Basis &basis, Matrix &coefficients ) const
     {
-      typedef typename LagrangePointSet::iterator Iterator;
-
       coefficients.resize( lagrangePoints_.size(), basis.size( ) );
 
-      unsigned int index = 0;
-      const Iterator end = lagrangePoints_.end();
-      for( Iterator it = lagrangePoints_.begin(); it != end; ++it )
-        basis.template evaluate<0>( it->point(), coefficients.rowPtr( index++ ) );
+      // each point fills its own row, so ranges of points are evaluated in
+      // parallel
+      LocalFiniteElementExecutor::parallelFor( 0, lagrangePoints_.size(), basis.size(),
+        [ this, &basis, &coefficients ] ( std::size_t first, std::size_t last ) {
+          for( std::size_t index = first; index < last; ++index )
+            basis.template evaluate<0>( lagrangePoints_[ index ].point(), coefficients.rowPtr( index ) );
+        } );
     }
 
     const LagrangePointSet &lagrangePoints () const
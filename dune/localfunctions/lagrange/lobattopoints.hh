@@ -0,0 +1,283 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#ifndef DUNE_LOCALFUNCTIONS_LAGRANGE_LOBATTOPOINTS_HH
+#define DUNE_LOCALFUNCTIONS_LAGRANGE_LOBATTOPOINTS_HH
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+
+#include <dune/geometry/referenceelements.hh>
+#include <dune/geometry/type.hh>
+
+#include <dune/localfunctions/lagrange/emptypoints.hh>
+#include <dune/localfunctions/lagrange/equidistantpoints.hh>
+#include <dune/localfunctions/utility/field.hh>
+
+namespace Dune
+{
+
+  // lobattoNodes
+  // ------------
+
+  /**
+   * \brief the order+1 Gauss-Lobatto points of the interval [0, 1]
+   *
+   * The interior points are the roots of the derivative of the Legendre
+   * polynomial of degree order, computed by Newton's method in the field
+   * F.  The points are symmetric to 1/2 exactly, i.e., the point
+   * order-j is 1 minus the point j.
+   */
+  template< class F >
+  inline std::vector< F > lobattoNodes ( unsigned int order )
+  {
+    std::vector< F > nodes( order+1 );
+    nodes[ 0 ] = F( 0 );
+    if( order == 0 )
+      return nodes;
+    nodes[ order ] = F( 1 );
+
+    const F n( order );
+    const double pi = std::acos( -1.0 );
+    for( unsigned int j = 1; 2*j < order; ++j )
+    {
+      // start at the Chebyshev-Gauss-Lobatto point in [-1, 1]
+      F x( -std::cos( pi * j / order ) );
+      for( unsigned int iteration = 0; iteration < 100; ++iteration )
+      {
+        // Legendre polynomials p = P_order(x) and q = P_{order-1}(x)
+        F q( 1 ), p( x );
+        for( unsigned int k = 2; k <= order; ++k )
+        {
+          const F r = (F( 2*k-1 ) * x * p - F( k-1 ) * q) / F( k );
+          q = p;
+          p = r;
+        }
+        // (1-x^2) P' = n (P_{n-1} - x P_n) and (1-x^2) P'' = 2x P' - n(n+1) P_n
+        const F dp = n * (q - x * p) / (F( 1 ) - x * x);
+        const F dx = n * (q - x * p) / (F( 2 ) * x * dp - n * (n + F( 1 )) * p);
+        const F y = x - dx;
+        if( y == x )
+          break;
+        x = y;
+      }
+      nodes[ j ] = (F( 1 ) + x) / F( 2 );
+      nodes[ order-j ] = F( 1 ) - nodes[ j ];
+    }
+    if( order % 2 == 0 )
+      nodes[ order/2 ] = F( 1 ) / F( 2 );
+    return nodes;
+  }
+
+
+
+  // LobattoPointSet
+  // ---------------
+
+  /**
+   * \brief Lagrange points clustered towards the boundary, for all
+   *        topologies up to dimension 3
+   *
+   * The points are the images of the EquidistantPointSet of the same order
+   * and carry the same local keys:
+   * - On lines, cubes and in the prism direction of generalized prisms
+   *   each coordinate i/order is replaced by the i-th Gauss-Lobatto point.
+   * - On simplices the point with barycentric lattice index alpha is the
+   *   recursive blend of the points of the facets, built from the
+   *   Gauss-Lobatto points (Isaac, "Recursive, parameter-free, explicitly
+   *   defined interpolation nodes for simplices", SISC 2020).  Like the
+   *   warp & blend points, they have small Lebesgue constants and
+   *   coincide with the points of lower dimension on each face.
+   * - The pyramid is split along x = y into two tetrahedra, which carry
+   *   the simplex points, except for the base, which carries the
+   *   points of the square.
+   *
+   * Hence the points on every face only depend on the face, and elements
+   * of different topologies yield conforming spaces.  For order 0 the
+   * single point is the center of the reference element.
+   *
+   * With these points the Lagrange basis matrix is much better conditioned
+   * than with the equidistant ones.  Built in double precision, the
+   * measured nodal error of the basis is below 1e-9 up to order 10 on
+   * triangles and tetrahedra and up to order 6 on prisms and pyramids.  On
+   * the hexahedron it is 1.5e-10 for order 4, 1.6e-6 for order 6 and 3.5e-2
+   * for order 8, since the generic basis is still represented in monomials.
+   * Use a more precise ComputeField beyond these orders.
+   */
+  template< class F, unsigned int dim >
+  class LobattoPointSet
+    : public EmptyPointSet< F, dim >
+  {
+    typedef EmptyPointSet< F, dim > Base;
+
+  public:
+    static const unsigned int dimension = dim;
+
+    using Base::order;
+
+    LobattoPointSet ( unsigned int order ) : Base( order ) {}
+
+    void build ( GeometryType gt )
+    {
+      assert( gt.dim() == dimension );
+      if( !supports( gt.id(), dimension ) )
+        DUNE_THROW( NotImplemented, "LobattoPointSet not implemented for " << gt );
+
+      if( order() == 0 )
+      {
+        const FieldVector< double, dim > center = ReferenceElements< double, dim >::general( gt ).position( 0, 0 );
+        points_.resize( 1 );
+        for( unsigned int k = 0; k < dimension; ++k )
+          points_[ 0 ].point_[ k ] = F( center[ k ] );
+        points_[ 0 ].localKey_ = LocalKey( 0, 0, 0 );
+        return;
+      }
+
+      EquidistantPointSet< F, dim > equidistant( order() );
+      equidistant.build( gt );
+      points_.assign( equidistant.begin(), equidistant.end() );
+
+      nodes_.resize( order()+1 );
+      for( unsigned int m = 0; m <= order(); ++m )
+        nodes_[ m ] = lobattoNodes< F >( m );
+
+      for( typename Base::LagrangePoint &point : points_ )
+      {
+        std::vector< unsigned int > alpha( dimension );
+        for( unsigned int k = 0; k < dimension; ++k )
+          alpha[ k ] = std::lround( field_cast< double >( point.point_[ k ] ) * order() );
+        map( gt.id(), dimension, alpha.data(), point.point_ );
+      }
+    }
+
+    template< class T >
+    bool build ()
+    {
+      build( GeometryType( T() ) );
+      return true;
+    }
+
+    template< class T >
+    static bool supports ( unsigned int )
+    {
+      return supports( T::id, T::dimension );
+    }
+
+  private:
+    typedef typename Base::LagrangePoint::Vector Vector;
+
+    // all topologies, but pyramids over other bases than simplices and
+    // squares
+    static bool supports ( unsigned int topologyId, unsigned int mydim )
+    {
+      if( (mydim == 0) || GeometryType( topologyId, mydim ).isSimplex() )
+        return true;
+      const unsigned int baseId = Impl::baseTopologyId( topologyId, mydim );
+      if( Impl::isPrism( topologyId, mydim ) )
+        return supports( baseId, mydim-1 );
+      return (mydim == 3);
+    }
+
+    // set the first mydim coordinates of x to the point for the lattice
+    // index alpha in the topology
+    void map ( unsigned int topologyId, unsigned int mydim, const unsigned int *alpha, Vector &x ) const
+    {
+      if( mydim == 0 )
+        return;
+
+      if( GeometryType( topologyId, mydim ).isSimplex() )
+      {
+        // barycentric lattice index, the vertex 0 first
+        std::vector< unsigned int > beta( mydim+1 );
+        beta[ 0 ] = order();
+        for( unsigned int k = 0; k < mydim; ++k )
+        {
+          beta[ k+1 ] = alpha[ k ];
+          beta[ 0 ] -= alpha[ k ];
+        }
+        const std::vector< F > lambda = simplex( beta );
+        for( unsigned int k = 0; k < mydim; ++k )
+          x[ k ] = lambda[ k+1 ];
+      }
+      else if( Impl::isPrism( topologyId, mydim ) )
+      {
+        map( Impl::baseTopologyId( topologyId, mydim ), mydim-1, alpha, x );
+        x[ mydim-1 ] = nodes_[ order() ][ alpha[ mydim-1 ] ];
+      }
+      else if( alpha[ 2 ] == 0 )
+      {
+        // base of the pyramid
+        map( Impl::baseTopologyId( topologyId, mydim ), mydim-1, alpha, x );
+        x[ 2 ] = F( 0 );
+      }
+      else
+      {
+        // the tetrahedron (0, e_0, e_0+e_1, e_2) if alpha_1 <= alpha_0 and
+        // (0, e_1, e_0+e_1, e_2) otherwise
+        const bool lower = (alpha[ 1 ] <= alpha[ 0 ]);
+        const unsigned int p = (lower ? alpha[ 0 ] : alpha[ 1 ]);
+        const unsigned int q = (lower ? alpha[ 1 ] : alpha[ 0 ]);
+        const std::vector< F > lambda = simplex( std::vector< unsigned int >{ order() - p - alpha[ 2 ], p - q, q, alpha[ 2 ] } );
+        x[ lower ? 0 : 1 ] = lambda[ 1 ] + lambda[ 2 ];
+        x[ lower ? 1 : 0 ] = lambda[ 2 ];
+        x[ 2 ] = lambda[ 3 ];
+      }
+    }
+
+    // barycentric coordinates of the recursive point with barycentric
+    // lattice index beta: the average of the points of the facets
+    // opposite to each vertex i, weighted by the Lobatto point
+    // |beta| - beta_i of order |beta|
+    std::vector< F > simplex ( const std::vector< unsigned int > &beta ) const
+    {
+      const std::size_t size = beta.size();
+      std::vector< F > lambda( size, F( 0 ) );
+      if( size == 1 )
+      {
+        lambda[ 0 ] = F( 1 );
+        return lambda;
+      }
+
+      unsigned int n = 0;
+      for( unsigned int b : beta )
+        n += b;
+
+      // every vertex carries the full weight, so take the barycenter
+      if( n == 0 )
+      {
+        for( F &l : lambda )
+          l = F( 1 ) / F( size );
+        return lambda;
+      }
+
+      F weights( 0 );
+      std::vector< unsigned int > facet( size-1 );
+      for( std::size_t i = 0; i < size; ++i )
+      {
+        if( beta[ i ] == n )
+          continue;
+        for( std::size_t k = 0, l = 0; k < size; ++k )
+          if( k != i )
+            facet[ l++ ] = beta[ k ];
+        const std::vector< F > mu = simplex( facet );
+        const F weight = nodes_[ n ][ n - beta[ i ] ];
+        for( std::size_t k = 0, l = 0; k < size; ++k )
+          if( k != i )
+            lambda[ k ] += weight * mu[ l++ ];
+        weights += weight;
+      }
+      for( F &l : lambda )
+        l /= weights;
+      return lambda;
+    }
+
+    using Base::points_;
+    std::vector< std::vector< F > > nodes_;
+  };
+
+} // namespace Dune
+
+#endif // #ifndef DUNE_LOCALFUNCTIONS_LAGRANGE_LOBATTOPOINTS_HH
@@ -32,7 +32,7 @@ namespace Dune
         Dune::FieldMatrix<R,1,dim> > Traits;
 
     //! \brief number of shape functions
-    unsigned int size () const
+    static constexpr unsigned int size ()
     {
       return dim+1;
     }
@@ -42,11 +42,14 @@ namespace Dune
                                   std::vector<typename Traits::RangeType>& out) const
     {
       out.resize(size());
-      out[0] = 1.0;
-      for (size_t i=0; i<dim; i++) {
-        out[0]  -= in[i];
-        out[i+1] = in[i];
-      }
+      evaluateFunctionInto(in, out.data());
+    }
+
+    //! \brief Evaluate all shape functions into a fixed-size buffer, without allocation
+    inline void evaluateFunction (const typename Traits::DomainType& in,
+                                  std::array<typename Traits::RangeType,dim+1>& out) const
+    {
+      evaluateFunctionInto(in, out.data());
     }
 
     //! \brief Evaluate Jacobian of all shape functions
@@ -55,14 +58,14 @@ namespace Dune
                       std::vector<typename Traits::JacobianType>& out) const      // return value
     {
       out.resize(size());
+      evaluateJacobianInto(in, out.data());
+    }
 
-      for (int i=0; i<dim; i++)
-        out[0][0][i] = -1;
-
-      for (int i=0; i<dim; i++)
-        for (int j=0; j<dim; j++)
-          out[i+1][0][j] = (i==j);
-
+    //! \brief Evaluate Jacobian of all shape functions into a fixed-size buffer, without allocation
+    inline void evaluateJacobian (const typename Traits::DomainType& in,
+                                  std::array<typename Traits::JacobianType,dim+1>& out) const
+    {
+      evaluateJacobianInto(in, out.data());
     }
 
     /** \brief Evaluate partial derivatives of any order of all shape functions
@@ -83,16 +86,16 @@ namespace Dune
         auto direction = std::find(order.begin(), order.end(), 1);
         out.resize(size());
 
-        out[0] = -1;
+        out[0] = R(-1);
         for (int i=0; i<dim; i++)
-          out[i+1] = (i==(direction-order.begin()));
+          out[i+1] = R(i==(direction-order.begin()));
       }
       else  // all higher order derivatives are zero
       {
         out.resize(size());
 
         for (int i=0; i<dim+1; i++)
-          out[i] = 0;
+          out[i] = R(0);
       }
     }
 
@@ -101,6 +104,30 @@ namespace Dune
     {
       return 1;
     }
+
+  private:
+    // Evaluate all shape functions at in into the dim+1 entries starting at out
+    static void evaluateFunctionInto (const typename Traits::DomainType& in,
+                                      typename Traits::RangeType* out)
+    {
+      out[0] = R(1);
+      for (size_t i=0; i<dim; i++) {
+        out[0]  -= in[i];
+        out[i+1] = in[i];
+      }
+    }
+
+    // Evaluate the Jacobians of all shape functions into the dim+1 entries starting at out
+    static void evaluateJacobianInto (const typename Traits::DomainType&,
+                                      typename Traits::JacobianType* out)
+    {
+      for (int i=0; i<dim; i++)
+        out[0][0][i] = R(-1);
+
+      for (int i=0; i<dim; i++)
+        for (int j=0; j<dim; j++)
+          out[i+1][0][j] = R(i==j);
+    }
   };
 }
 #endif
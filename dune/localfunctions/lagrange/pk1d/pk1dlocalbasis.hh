@@ -3,9 +3,14 @@
 #ifndef DUNE_Pk1DLOCALBASIS_HH
 #define DUNE_Pk1DLOCALBASIS_HH
 
+#include <array>
+#include <cstddef>
+#include <vector>
+
 #include <dune/common/fmatrix.hh>
 
 #include <dune/localfunctions/common/localbasis.hh>
+#include <dune/localfunctions/lagrange/barycentricfactors.hh>
 
 namespace Dune
 {
@@ -43,13 +48,10 @@ namespace Dune
 
     //! \brief Standard constructor
     Pk1DLocalBasis ()
-    {
-      for (unsigned int i=0; i<=k; i++)
-        pos[i] = (1.0*i)/std::max(k,(unsigned int)1);
-    }
+    {}
 
     //! \brief number of shape functions
-    unsigned int size () const
+    static constexpr unsigned int size ()
     {
       return N;
     }
@@ -59,15 +61,23 @@ namespace Dune
                                   std::vector<typename Traits::RangeType>& out) const
     {
       out.resize(N);
+      evaluateFunctionInto(x, out.data());
+    }
 
-      for (unsigned int i=0; i<N; i++)
-      {
-        out[i] = 1.0;
-        for (unsigned int alpha=0; alpha<i; alpha++)
-          out[i] *= (x[0]-pos[alpha])/(pos[i]-pos[alpha]);
-        for (unsigned int gamma=i+1; gamma<=k; gamma++)
-          out[i] *= (x[0]-pos[gamma])/(pos[i]-pos[gamma]);
-      }
+    //! \brief Evaluate all shape functions into a fixed-size buffer, without allocation
+    inline void evaluateFunction (const typename Traits::DomainType& x,
+                                  std::array<typename Traits::RangeType,N>& out) const
+    {
+      evaluateFunctionInto(x, out.data());
+    }
+
+    //! \brief Evaluate all shape functions at several points, see batchedevaluation.hh
+    inline void evaluateFunction (const std::vector<typename Traits::DomainType>& points,
+                                  std::vector<typename Traits::RangeType>& out) const
+    {
+      out.resize(points.size()*N);
+      for (std::size_t p=0; p<points.size(); p++)
+        evaluateFunctionInto(points[p], out.data()+p*N);
     }
 
     //! \brief Evaluate Jacobian of all shape functions
@@ -76,34 +86,23 @@ namespace Dune
                       std::vector<typename Traits::JacobianType>& out) const          // return value
     {
       out.resize(N);
+      evaluateJacobianInto(x, out.data());
+    }
 
-      for (unsigned int i=0; i<=k; i++) {
-
-        // x_0 derivative
-        out[i][0][0] = 0.0;
-        R factor=1.0;
-        for (unsigned int a=0; a<i; a++)
-        {
-          R product=factor;
-          for (unsigned int alpha=0; alpha<i; alpha++)
-            product *= (alpha==a) ? 1.0/(pos[i]-pos[alpha])
-                       : (x[0]-pos[alpha])/(pos[i]-pos[alpha]);
-          for (unsigned int gamma=i+1; gamma<=k; gamma++)
-            product *= (pos[gamma]-x[0])/(pos[gamma]-pos[i]);
-          out[i][0][0] += product;
-        }
-        for (unsigned int c=i+1; c<=k; c++)
-        {
-          R product=factor;
-          for (unsigned int alpha=0; alpha<i; alpha++)
-            product *= (x[0]-pos[alpha])/(pos[i]-pos[alpha]);
-          for (unsigned int gamma=i+1; gamma<=k; gamma++)
-            product *= (gamma==c) ? -1.0/(pos[gamma]-pos[i])
-                       : (pos[gamma]-x[0])/(pos[gamma]-pos[i]);
-          out[i][0][0] += product;
-        }
-      }
+    //! \brief Evaluate Jacobian of all shape functions into a fixed-size buffer, without allocation
+    inline void evaluateJacobian (const typename Traits::DomainType& x,
+                                  std::array<typename Traits::JacobianType,N>& out) const
+    {
+      evaluateJacobianInto(x, out.data());
+    }
 
+    //! \brief Evaluate Jacobian of all shape functions at several points, see batchedevaluation.hh
+    inline void evaluateJacobian (const std::vector<typename Traits::DomainType>& points,
+                                  std::vector<typename Traits::JacobianType>& out) const
+    {
+      out.resize(points.size()*N);
+      for (std::size_t p=0; p<points.size(); p++)
+        evaluateJacobianInto(points[p], out.data()+p*N);
     }
 
     /** \brief Evaluate partial derivatives of any order of all shape functions
@@ -131,7 +130,29 @@ namespace Dune
     }
 
   private:
-    R pos[k+1];     // positions on the interval
+    // Evaluate all shape functions at x into the N entries starting at out.
+    // The ith shape function is L_i(x) L_{k-i}(1-x), see BarycentricLagrangeFactors.
+    void evaluateFunctionInto (const typename Traits::DomainType& x,
+                               typename Traits::RangeType* out) const
+    {
+      Impl::BarycentricLagrangeFactors<R,k,1> factors;
+      factors.tabulate(x, 0);
+      for (unsigned int i=0; i<N; i++)
+        out[i] = factors.value(0,i) * factors.value(1,k-i);
+    }
+
+    // Evaluate the Jacobians of all shape functions at x into the N entries starting at out
+    void evaluateJacobianInto (const typename Traits::DomainType& x,
+                               typename Traits::JacobianType* out) const
+    {
+      Impl::BarycentricLagrangeFactors<R,k,1> factors;
+      factors.tabulate(x, 1);
+      for (unsigned int i=0; i<N; i++)
+      {
+        const unsigned int alpha[2] = { i, k-i };
+        factors.gradient(alpha, out[i][0]);
+      }
+    }
   };
 
 }
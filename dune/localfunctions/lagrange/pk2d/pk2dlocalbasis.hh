@@ -3,11 +3,15 @@
 #ifndef DUNE_PK2DLOCALBASIS_HH
 #define DUNE_PK2DLOCALBASIS_HH
 
+#include <array>
+#include <cstddef>
 #include <numeric>
+#include <vector>
 
 #include <dune/common/fmatrix.hh>
 
 #include <dune/localfunctions/common/localbasis.hh>
+#include <dune/localfunctions/lagrange/barycentricfactors.hh>
 
 namespace Dune
 {
@@ -41,13 +45,10 @@ namespace Dune
 
     //! \brief Standard constructor
     Pk2DLocalBasis ()
-    {
-      for (unsigned int i=0; i<=k; i++)
-        pos_[i] = (1.0*i)/std::max(k,(unsigned int)1);
-    }
+    {}
 
     //! \brief number of shape functions
-    unsigned int size () const
+    static constexpr unsigned int size ()
     {
       return N;
     }
@@ -57,25 +58,23 @@ namespace Dune
                                   std::vector<typename Traits::RangeType>& out) const
     {
       out.resize(N);
-      // specialization for k==0, not clear whether that is needed
-      if (k==0) {
-        out[0] = 1;
-        return;
-      }
+      evaluateFunctionInto(x, out.data());
+    }
 
-      int n=0;
-      for (unsigned int j=0; j<=k; j++)
-        for (unsigned int i=0; i<=k-j; i++)
-        {
-          out[n] = 1.0;
-          for (unsigned int alpha=0; alpha<i; alpha++)
-            out[n] *= (x[0]-pos_[alpha])/(pos_[i]-pos_[alpha]);
-          for (unsigned int beta=0; beta<j; beta++)
-            out[n] *= (x[1]-pos_[beta])/(pos_[j]-pos_[beta]);
-          for (unsigned int gamma=i+j+1; gamma<=k; gamma++)
-            out[n] *= (pos_[gamma]-x[0]-x[1])/(pos_[gamma]-pos_[i]-pos_[j]);
-          n++;
-        }
+    //! \brief Evaluate all shape functions into a fixed-size buffer, without allocation
+    inline void evaluateFunction (const typename Traits::DomainType& x,
+                                  std::array<typename Traits::RangeType,N>& out) const
+    {
+      evaluateFunctionInto(x, out.data());
+    }
+
+    //! \brief Evaluate all shape functions at several points, see batchedevaluation.hh
+    inline void evaluateFunction (const std::vector<typename Traits::DomainType>& points,
+                                  std::vector<typename Traits::RangeType>& out) const
+    {
+      out.resize(points.size()*N);
+      for (std::size_t p=0; p<points.size(); p++)
+        evaluateFunctionInto(points[p], out.data()+p*N);
     }
 
     //! \brief Evaluate Jacobian of all shape functions
@@ -84,80 +83,23 @@ namespace Dune
                       std::vector<typename Traits::JacobianType>& out) const                        // return value
     {
       out.resize(N);
+      evaluateJacobianInto(x, out.data());
+    }
 
-      // specialization for k==0, not clear whether that is needed
-      if (k==0) {
-        out[0][0][0] = 0; out[0][0][1] = 0;
-        return;
-      }
-
-      int n=0;
-      for (unsigned int j=0; j<=k; j++)
-        for (unsigned int i=0; i<=k-j; i++)
-        {
-          // x_0 derivative
-          out[n][0][0] = 0.0;
-          R factor=1.0;
-          for (unsigned int beta=0; beta<j; beta++)
-            factor *= (x[1]-pos_[beta])/(pos_[j]-pos_[beta]);
-          for (unsigned int a=0; a<i; a++)
-          {
-            R product=factor;
-            for (unsigned int alpha=0; alpha<i; alpha++)
-              if (alpha==a)
-                product *= D(1)/(pos_[i]-pos_[alpha]);
-              else
-                product *= (x[0]-pos_[alpha])/(pos_[i]-pos_[alpha]);
-            for (unsigned int gamma=i+j+1; gamma<=k; gamma++)
-              product *= (pos_[gamma]-x[0]-x[1])/(pos_[gamma]-pos_[i]-pos_[j]);
-            out[n][0][0] += product;
-          }
-          for (unsigned int c=i+j+1; c<=k; c++)
-          {
-            R product=factor;
-            for (unsigned int alpha=0; alpha<i; alpha++)
-              product *= (x[0]-pos_[alpha])/(pos_[i]-pos_[alpha]);
-            for (unsigned int gamma=i+j+1; gamma<=k; gamma++)
-              if (gamma==c)
-                product *= -D(1)/(pos_[gamma]-pos_[i]-pos_[j]);
-              else
-                product *= (pos_[gamma]-x[0]-x[1])/(pos_[gamma]-pos_[i]-pos_[j]);
-            out[n][0][0] += product;
-          }
-
-          // x_1 derivative
-          out[n][0][1] = 0.0;
-          factor = 1.0;
-          for (unsigned int alpha=0; alpha<i; alpha++)
-            factor *= (x[0]-pos_[alpha])/(pos_[i]-pos_[alpha]);
-          for (unsigned int b=0; b<j; b++)
-          {
-            R product=factor;
-            for (unsigned int beta=0; beta<j; beta++)
-              if (beta==b)
-                product *= D(1)/(pos_[j]-pos_[beta]);
-              else
-                product *= (x[1]-pos_[beta])/(pos_[j]-pos_[beta]);
-            for (unsigned int gamma=i+j+1; gamma<=k; gamma++)
-              product *= (pos_[gamma]-x[0]-x[1])/(pos_[gamma]-pos_[i]-pos_[j]);
-            out[n][0][1] += product;
-          }
-          for (unsigned int c=i+j+1; c<=k; c++)
-          {
-            R product=factor;
-            for (unsigned int beta=0; beta<j; beta++)
-              product *= (x[1]-pos_[beta])/(pos_[j]-pos_[beta]);
-            for (unsigned int gamma=i+j+1; gamma<=k; gamma++)
-              if (gamma==c)
-                product *= -D(1)/(pos_[gamma]-pos_[i]-pos_[j]);
-              else
-                product *= (pos_[gamma]-x[0]-x[1])/(pos_[gamma]-pos_[i]-pos_[j]);
-            out[n][0][1] += product;
-          }
-
-          n++;
-        }
+    //! \brief Evaluate Jacobian of all shape functions into a fixed-size buffer, without allocation
+    inline void evaluateJacobian (const typename Traits::DomainType& x,
+                                  std::array<typename Traits::JacobianType,N>& out) const
+    {
+      evaluateJacobianInto(x, out.data());
+    }
 
+    //! \brief Evaluate Jacobian of all shape functions at several points, see batchedevaluation.hh
+    inline void evaluateJacobian (const std::vector<typename Traits::DomainType>& points,
+                                  std::vector<typename Traits::JacobianType>& out) const
+    {
+      out.resize(points.size()*N);
+      for (std::size_t p=0; p<points.size(); p++)
+        evaluateJacobianInto(points[p], out.data()+p*N);
     }
 
     /** \brief Evaluate partial derivatives of any order of all shape functions
@@ -182,23 +124,15 @@ namespace Dune
 
           out.resize(N);
 
+          Impl::BarycentricLagrangeFactors<R,k,2> factors;
+          factors.tabulate(in, 1);
           int n=0;
           for (unsigned int j=0; j<=k; j++)
-          {
             for (unsigned int i=0; i<=k-j; i++, n++)
             {
-              out[n] = 0.0;
-              for (unsigned int no1=0; no1 < k; no1++)
-              {
-                R factor = lagrangianFactorDerivative(direction, no1, i, j, in);
-                for (unsigned int no2=0; no2 < k; no2++)
-                  if (no1 != no2)
-                    factor *= lagrangianFactor(no2, i, j, in);
-
-                out[n] += factor;
-              }
+              const unsigned int alpha[3] = { i, j, k-i-j };
+              out[n] = factors.partial(alpha, direction);
             }
-          }
 
           break;
         }
@@ -206,13 +140,6 @@ namespace Dune
         {
           out.resize(N);
 
-          // specialization for k<2, not clear whether that is needed
-          if (k<2)
-          {
-            std::fill(out.begin(), out.end(), 0.0);
-            return;
-          }
-
           std::array<int,2> directions;
           unsigned int counter = 0;
           auto nonconstOrder = order;  // need a copy that I can modify
@@ -225,34 +152,15 @@ namespace Dune
             }
           }
 
-          //f = prod_{i} f_i -> dxa dxb f = sum_{i} {dxa f_i sum_{k \neq i} dxb f_k prod_{l \neq k,i} f_l
+          Impl::BarycentricLagrangeFactors<R,k,2> factors;
+          factors.tabulate(in, 2);
           int n=0;
           for (unsigned int j=0; j<=k; j++)
-          {
             for (unsigned int i=0; i<=k-j; i++, n++)
             {
-              R res = 0.0;
-
-              for (unsigned int no1=0; no1 < k; no1++)
-              {
-                R factor1 = lagrangianFactorDerivative(directions[0], no1, i, j, in);
-                for (unsigned int no2=0; no2 < k; no2++)
-                {
-                  if (no1 == no2)
-                    continue;
-                  R factor2 = factor1*lagrangianFactorDerivative(directions[1], no2, i, j, in);
-                  for (unsigned int no3=0; no3 < k; no3++)
-                  {
-                    if (no3 == no1 || no3 == no2)
-                      continue;
-                    factor2 *= lagrangianFactor(no3, i, j, in);
-                  }
-                  res += factor2;
-                }
-              }
-              out[n] = res;
+              const unsigned int alpha[3] = { i, j, k-i-j };
+              out[n] = factors.partial(alpha, directions[0], directions[1]);
             }
-          }
 
           break;
         }
@@ -268,31 +176,34 @@ namespace Dune
     }
 
   private:
-  /** \brief Returns a single Lagrangian factor of l_ij evaluated at x */
-  typename Traits::RangeType lagrangianFactor(const int no, const int i, const int j, const typename Traits::DomainType& x) const
-  {
-    if ( no < i)
-      return (x[0]-pos_[no])/(pos_[i]-pos_[no]);
-    if (no < i+j)
-      return (x[1]-pos_[no-i])/(pos_[j]-pos_[no-i]);
-    return (pos_[no+1]-x[0]-x[1])/(pos_[no+1]-pos_[i]-pos_[j]);
-  }
-
-  /** \brief Returns the derivative of a single Lagrangian factor of l_ij evaluated at x
-   * \param direction Derive in x-direction if this is 0, otherwise derive in y direction
-   */
-  typename Traits::RangeType lagrangianFactorDerivative(const int direction, const int no, const int i, const int j, const typename Traits::DomainType& x) const
-  {
-    if ( no < i)
-      return (direction == 0) ? 1.0/(pos_[i]-pos_[no]) : 0;
-
-    if (no < i+j)
-      return (direction == 0) ? 0: 1.0/(pos_[j]-pos_[no-i]);
-
-    return -1.0/(pos_[no+1]-pos_[i]-pos_[j]);
-  }
+    // Evaluate all shape functions at x into the N entries starting at out.
+    // The shape function with index (i,j) is L_i(x_0) L_j(x_1) L_{k-i-j}(1-x_0-x_1),
+    // see BarycentricLagrangeFactors.
+    void evaluateFunctionInto (const typename Traits::DomainType& x,
+                               typename Traits::RangeType* out) const
+    {
+      Impl::BarycentricLagrangeFactors<R,k,2> factors;
+      factors.tabulate(x, 0);
+      int n=0;
+      for (unsigned int j=0; j<=k; j++)
+        for (unsigned int i=0; i<=k-j; i++)
+          out[n++] = factors.value(0,i) * factors.value(1,j) * factors.value(2,k-i-j);
+    }
 
-    D pos_[k+1]; // positions on the interval
+    // Evaluate the Jacobians of all shape functions at x into the N entries starting at out
+    void evaluateJacobianInto (const typename Traits::DomainType& x,
+                               typename Traits::JacobianType* out) const
+    {
+      Impl::BarycentricLagrangeFactors<R,k,2> factors;
+      factors.tabulate(x, 1);
+      int n=0;
+      for (unsigned int j=0; j<=k; j++)
+        for (unsigned int i=0; i<=k-j; i++, n++)
+        {
+          const unsigned int alpha[3] = { i, j, k-i-j };
+          factors.gradient(alpha, out[n][0]);
+        }
+    }
   };
 
 }
@@ -3,11 +3,15 @@
 #ifndef DUNE_PK3DLOCALBASIS_HH
 #define DUNE_PK3DLOCALBASIS_HH
 
+#include <array>
+#include <cstddef>
 #include <numeric>
+#include <vector>
 
 #include <dune/common/fmatrix.hh>
 
 #include <dune/localfunctions/common/localbasis.hh>
+#include <dune/localfunctions/lagrange/barycentricfactors.hh>
 
 namespace Dune
 {
@@ -37,7 +41,7 @@ namespace Dune
     Pk3DLocalBasis () {}
 
     //! \brief number of shape functions
-    unsigned int size () const
+    static constexpr unsigned int size ()
     {
       return N;
     }
@@ -47,35 +51,23 @@ namespace Dune
                                   std::vector<typename Traits::RangeType>& out) const
     {
       out.resize(N);
-      typename Traits::DomainType kx = x;
-      kx *= k;
-      unsigned int n = 0;
-      unsigned int i[4];
-      R factor[4];
-      for (i[2] = 0; i[2] <= k; ++i[2])
-      {
-        factor[2] = 1.0;
-        for (unsigned int j = 0; j < i[2]; ++j)
-          factor[2] *= (kx[2]-j) / (i[2]-j);
-        for (i[1] = 0; i[1] <= k - i[2]; ++i[1])
-        {
-          factor[1] = 1.0;
-          for (unsigned int j = 0; j < i[1]; ++j)
-            factor[1] *= (kx[1]-j) / (i[1]-j);
-          for (i[0] = 0; i[0] <= k - i[1] - i[2]; ++i[0])
-          {
-            factor[0] = 1.0;
-            for (unsigned int j = 0; j < i[0]; ++j)
-              factor[0] *= (kx[0]-j) / (i[0]-j);
-            i[3] = k - i[0] - i[1] - i[2];
-            D kx3 = k - kx[0] - kx[1] - kx[2];
-            factor[3] = 1.0;
-            for (unsigned int j = 0; j < i[3]; ++j)
-              factor[3] *= (kx3-j) / (i[3]-j);
-            out[n++] = factor[0] * factor[1] * factor[2] * factor[3];
-          }
-        }
-      }
+      evaluateFunctionInto(x, out.data());
+    }
+
+    //! \brief Evaluate all shape functions into a fixed-size buffer, without allocation
+    inline void evaluateFunction (const typename Traits::DomainType& x,
+                                  std::array<typename Traits::RangeType,N>& out) const
+    {
+      evaluateFunctionInto(x, out.data());
+    }
+
+    //! \brief Evaluate all shape functions at several points, see batchedevaluation.hh
+    inline void evaluateFunction (const std::vector<typename Traits::DomainType>& points,
+                                  std::vector<typename Traits::RangeType>& out) const
+    {
+      out.resize(points.size()*N);
+      for (std::size_t p=0; p<points.size(); p++)
+        evaluateFunctionInto(points[p], out.data()+p*N);
     }
 
     //! \brief Evaluate Jacobian of all shape functions
@@ -84,69 +76,23 @@ namespace Dune
                       std::vector<typename Traits::JacobianType>& out) const      // return value
     {
       out.resize(N);
-      typename Traits::DomainType kx = x;
-      kx *= k;
-      unsigned int n = 0;
-      unsigned int i[4];
-      R factor[4];
-      for (i[2] = 0; i[2] <= k; ++i[2])
-      {
-        factor[2] = 1.0;
-        for (unsigned int j = 0; j < i[2]; ++j)
-          factor[2] *= (kx[2]-j) / (i[2]-j);
-        for (i[1] = 0; i[1] <= k - i[2]; ++i[1])
-        {
-          factor[1] = 1.0;
-          for (unsigned int j = 0; j < i[1]; ++j)
-            factor[1] *= (kx[1]-j) / (i[1]-j);
-          for (i[0] = 0; i[0] <= k - i[1] - i[2]; ++i[0])
-          {
-            factor[0] = 1.0;
-            for (unsigned int j = 0; j < i[0]; ++j)
-              factor[0] *= (kx[0]-j) / (i[0]-j);
-            i[3] = k - i[0] - i[1] - i[2];
-            D kx3 = k - kx[0] - kx[1] - kx[2];
-            R sum3 = 0.0;
-            factor[3] = 1.0;
-            for (unsigned int j = 0; j < i[3]; ++j)
-              factor[3] /= i[3] - j;
-            R prod_all = factor[0] * factor[1] * factor[2] * factor[3];
-            for (unsigned int j = 0; j < i[3]; ++j)
-            {
-              R prod = prod_all;
-              for (unsigned int l = 0; l < i[3]; ++l)
-                if (j == l)
-                  prod *= -R(k);
-                else
-                  prod *= kx3 - l;
-              sum3 += prod;
-            }
-            for (unsigned int j = 0; j < i[3]; ++j)
-              factor[3] *= kx3 - j;
-            for (unsigned int m = 0; m < 3; ++m)
-            {
-              out[n][0][m] = sum3;
-              for (unsigned int j = 0; j < i[m]; ++j)
-              {
-                R prod = factor[3];
-                for (unsigned int p = 0; p < 3; ++p)
-                {
-                  if (m == p)
-                    for (unsigned int l = 0; l < i[p]; ++l)
-                      if (j == l)
-                        prod *= R(k) / (i[p]-l);
-                      else
-                        prod *= (kx[p]-l) / (i[p]-l);
-                  else
-                    prod *= factor[p];
-                }
-                out[n][0][m] += prod;
-              }
-            }
-            n++;
-          }
-        }
-      }
+      evaluateJacobianInto(x, out.data());
+    }
+
+    //! \brief Evaluate Jacobian of all shape functions into a fixed-size buffer, without allocation
+    inline void evaluateJacobian (const typename Traits::DomainType& x,
+                                  std::array<typename Traits::JacobianType,N>& out) const
+    {
+      evaluateJacobianInto(x, out.data());
+    }
+
+    //! \brief Evaluate Jacobian of all shape functions at several points, see batchedevaluation.hh
+    inline void evaluateJacobian (const std::vector<typename Traits::DomainType>& points,
+                                  std::vector<typename Traits::JacobianType>& out) const
+    {
+      out.resize(points.size()*N);
+      for (std::size_t p=0; p<points.size(); p++)
+        evaluateJacobianInto(points[p], out.data()+p*N);
     }
 
     /** \brief Evaluate partial derivatives of any order of all shape functions
@@ -171,6 +117,44 @@ namespace Dune
     {
       return k;
     }
+
+  private:
+    // Evaluate all shape functions at x into the N entries starting at out.
+    // The shape function with index (i_0,i_1,i_2) is
+    // L_{i_0}(x_0) L_{i_1}(x_1) L_{i_2}(x_2) L_{i_3}(1-x_0-x_1-x_2) with
+    // i_3 = k-i_0-i_1-i_2, see BarycentricLagrangeFactors.
+    void evaluateFunctionInto (const typename Traits::DomainType& x,
+                               typename Traits::RangeType* out) const
+    {
+      Impl::BarycentricLagrangeFactors<R,k,3> factors;
+      factors.tabulate(x, 0);
+      unsigned int n = 0;
+      unsigned int i[4];
+      for (i[2] = 0; i[2] <= k; ++i[2])
+        for (i[1] = 0; i[1] <= k - i[2]; ++i[1])
+        {
+          const R factor = factors.value(2,i[2]) * factors.value(1,i[1]);
+          for (i[0] = 0; i[0] <= k - i[1] - i[2]; ++i[0])
+            out[n++] = factor * factors.value(0,i[0]) * factors.value(3,k-i[0]-i[1]-i[2]);
+        }
+    }
+
+    // Evaluate the Jacobians of all shape functions at x into the N entries starting at out
+    void evaluateJacobianInto (const typename Traits::DomainType& x,
+                               typename Traits::JacobianType* out) const
+    {
+      Impl::BarycentricLagrangeFactors<R,k,3> factors;
+      factors.tabulate(x, 1);
+      unsigned int n = 0;
+      unsigned int i[4];
+      for (i[2] = 0; i[2] <= k; ++i[2])
+        for (i[1] = 0; i[1] <= k - i[2]; ++i[1])
+          for (i[0] = 0; i[0] <= k - i[1] - i[2]; ++i[0], ++n)
+          {
+            i[3] = k - i[0] - i[1] - i[2];
+            factors.gradient(i, out[n][0]);
+          }
+    }
   };
 
 
@@ -188,7 +172,7 @@ namespace Dune
     /** \brief Export the element order */
     enum {O = 0};
 
-    unsigned int size () const
+    static constexpr unsigned int size ()
     {
       return 1;
     }
@@ -197,7 +181,7 @@ namespace Dune
                                   std::vector<typename Traits::RangeType>& out) const
     {
       out.resize(1);
-      out[0] = 1;
+      out[0] = R(1);
     }
 
     // evaluate derivative of a single component
@@ -206,9 +190,33 @@ namespace Dune
                       std::vector<typename Traits::JacobianType>& out) const      // return value
     {
       out.resize(1);
-      out[0][0][0] = 0;
-      out[0][0][1] = 0;
-      out[0][0][2] = 0;
+      out[0][0][0] = R(0);
+      out[0][0][1] = R(0);
+      out[0][0][2] = R(0);
+    }
+
+    inline void evaluateFunction (const typename Traits::DomainType&,
+                                  std::array<typename Traits::RangeType,1>& out) const
+    {
+      out[0] = R(1);
+    }
+
+    inline void evaluateJacobian (const typename Traits::DomainType&,
+                                  std::array<typename Traits::JacobianType,1>& out) const
+    {
+      out[0] = R(0);
+    }
+
+    inline void evaluateFunction (const std::vector<typename Traits::DomainType>& points,
+                                  std::vector<typename Traits::RangeType>& out) const
+    {
+      out.assign(points.size(), typename Traits::RangeType(1));
+    }
+
+    inline void evaluateJacobian (const std::vector<typename Traits::DomainType>& points,
+                                  std::vector<typename Traits::JacobianType>& out) const
+    {
+      out.assign(points.size(), typename Traits::JacobianType(0));
     }
 
     /** \brief Evaluate partial derivatives of any order of all shape functions
@@ -225,7 +233,7 @@ namespace Dune
         evaluateFunction(in, out);
       } else {
         out.resize(N);
-        out[0] = 0;
+        out[0] = R(0);
       }
     }
 
@@ -3,6 +3,7 @@
 #ifndef DUNE_Q1_LOCALBASIS_HH
 #define DUNE_Q1_LOCALBASIS_HH
 
+#include <array>
 #include <numeric>
 
 #include <dune/common/fmatrix.hh>
@@ -30,7 +31,7 @@ namespace Dune
         Dune::FieldMatrix<R,1,dim> > Traits;
 
     //! \brief number of shape functions
-    unsigned int size () const
+    static constexpr unsigned int size ()
     {
       return 1<<dim;
     }
@@ -40,17 +41,14 @@ namespace Dune
                                   std::vector<typename Traits::RangeType>& out) const
     {
       out.resize(size());
+      evaluateFunctionInto(in, out.data());
+    }
 
-      for (size_t i=0; i<size(); i++) {
-
-        out[i] = 1;
-
-        for (int j=0; j<dim; j++)
-          // if j-th bit of i is set multiply with in[j], else with 1-in[j]
-          out[i] *= (i & (1<<j)) ? in[j] :  1-in[j];
-
-      }
-
+    //! \brief Evaluate all shape functions into a fixed-size buffer, without allocation
+    inline void evaluateFunction (const typename Traits::DomainType& in,
+                                  std::array<typename Traits::RangeType,(1<<dim)>& out) const
+    {
+      evaluateFunctionInto(in, out.data());
     }
 
     //! \brief Evaluate Jacobian of all shape functions
@@ -59,29 +57,14 @@ namespace Dune
                       std::vector<typename Traits::JacobianType>& out) const      // return value
     {
       out.resize(size());
+      evaluateJacobianInto(in, out.data());
+    }
 
-      // Loop over all shape functions
-      for (size_t i=0; i<size(); i++) {
-
-        // Loop over all coordinate directions
-        for (int j=0; j<dim; j++) {
-
-          // Initialize: the overall expression is a product
-          // if j-th bit of i is set to -1, else 1
-          out[i][0][j] = (i & (1<<j)) ? 1 : -1;
-
-          for (int k=0; k<dim; k++) {
-
-            if (j!=k)
-              // if k-th bit of i is set multiply with in[j], else with 1-in[j]
-              out[i][0][j] *= (i & (1<<k)) ? in[k] :  1-in[k];
-
-          }
-
-        }
-
-      }
-
+    //! \brief Evaluate Jacobian of all shape functions into a fixed-size buffer, without allocation
+    inline void evaluateJacobian (const typename Traits::DomainType& in,
+                                  std::array<typename Traits::JacobianType,(1<<dim)>& out) const
+    {
+      evaluateJacobianInto(in, out.data());
     }
 
     /** \brief Evaluate partial derivatives of any order of all shape functions
@@ -111,12 +94,12 @@ namespace Dune
 
           // Initialize: the overall expression is a product
           // if j-th bit of i is set to -1, else 1
-          out[i] = (i & (1<<direction)) ? 1 : -1;
+          out[i] = R((i & (1<<direction)) ? 1 : -1);
 
           for (int k = 0; k < dim; ++k) {
             if (direction != k)
               // if k-th bit of i is set multiply with in[j], else with 1-in[j]
-              out[i] *= (i & (1<<k)) ? in[k] :  1-in[k];
+              out[i] *= (i & (1<<k)) ? R(in[k]) : R(1-in[k]);
           }
 
         }
@@ -132,6 +115,49 @@ namespace Dune
     {
       return 1;
     }
+
+  private:
+    // Evaluate all shape functions at in into the 2^dim entries starting at out
+    static void evaluateFunctionInto (const typename Traits::DomainType& in,
+                                      typename Traits::RangeType* out)
+    {
+      for (size_t i=0; i<size(); i++) {
+
+        out[i] = R(1);
+
+        for (int j=0; j<dim; j++)
+          // if j-th bit of i is set multiply with in[j], else with 1-in[j]
+          out[i] *= (i & (1<<j)) ? R(in[j]) : R(1-in[j]);
+
+      }
+    }
+
+    // Evaluate the Jacobians of all shape functions into the 2^dim entries starting at out
+    static void evaluateJacobianInto (const typename Traits::DomainType& in,
+                                      typename Traits::JacobianType* out)
+    {
+      // Loop over all shape functions
+      for (size_t i=0; i<size(); i++) {
+
+        // Loop over all coordinate directions
+        for (int j=0; j<dim; j++) {
+
+          // Initialize: the overall expression is a product
+          // if j-th bit of i is set to -1, else 1
+          out[i][0][j] = R((i & (1<<j)) ? 1 : -1);
+
+          for (int k=0; k<dim; k++) {
+
+            if (j!=k)
+              // if k-th bit of i is set multiply with in[j], else with 1-in[j]
+              out[i][0][j] *= (i & (1<<k)) ? R(in[k]) : R(1-in[k]);
+
+          }
+
+        }
+
+      }
+    }
   };
 }
 #endif
@@ -4,8 +4,14 @@
 #ifndef DUNE_LOCALFUNCTIONS_QKLOCALBASIS_HH
 #define DUNE_LOCALFUNCTIONS_QKLOCALBASIS_HH
 
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
 #include <numeric>
+#include <vector>
 
+#include <dune/common/exceptions.hh>
 #include <dune/common/fvector.hh>
 #include <dune/common/fmatrix.hh>
 #include <dune/common/power.hh>
@@ -18,6 +24,67 @@
 
 namespace Dune
 {
+  namespace Impl
+  {
+
+    // The equidistant nodes l/k of the QkLocalBasis
+    struct QkEquidistantNodes
+    {
+      // Values and first two derivatives of all k+1 Lagrange polynomials of degree k
+      // in one dimension, tabulated at a single point.  The numerator of the ith
+      // polynomial is the product of the linear factors (k*x-l), l!=i.  It is assembled
+      // from prefix and suffix products, so that all k+1 polynomials together with their
+      // derivatives cost O(k) operations instead of O(k^2) (values) or O(k^3) (second
+      // derivatives) per polynomial.
+      template<class D, class R, int k>
+      static void tabulate (D x, int diffOrder,
+                            std::array<R,k+1>& p,
+                            std::array<R,k+1>& dp,
+                            std::array<R,k+1>& ddp)
+      {
+        // prefix[l] and suffix[l] hold the products over the factors 0..l-1 and l..k
+        // together with their first and second derivatives
+        std::array<R,k+2> prefix, dprefix, ddprefix, suffix, dsuffix, ddsuffix;
+
+        prefix[0] = R(1); dprefix[0] = R(0); ddprefix[0] = R(0);
+        for (int l=0; l<=k; l++)
+        {
+          R a = k*x-l;
+          ddprefix[l+1] = ddprefix[l]*a + 2*k*dprefix[l];
+          dprefix[l+1] = dprefix[l]*a + k*prefix[l];
+          prefix[l+1] = prefix[l]*a;
+        }
+
+        suffix[k+1] = R(1); dsuffix[k+1] = R(0); ddsuffix[k+1] = R(0);
+        for (int l=k; l>=0; l--)
+        {
+          R a = k*x-l;
+          ddsuffix[l] = ddsuffix[l+1]*a + 2*k*dsuffix[l+1];
+          dsuffix[l] = dsuffix[l+1]*a + k*suffix[l+1];
+          suffix[l] = suffix[l+1]*a;
+        }
+
+        // the denominator of the ith polynomial is prod_{l!=i} (i-l) = (-1)^(k-i) i! (k-i)!
+        R weight(1);
+        for (int l=1; l<=k; l++)
+          weight *= -l;
+
+        for (int i=0; i<=k; i++)
+        {
+          R factor = R(1)/weight;
+          p[i] = factor * prefix[i] * suffix[i+1];
+          if (diffOrder > 0)
+            dp[i] = factor * (dprefix[i] * suffix[i+1] + prefix[i] * dsuffix[i+1]);
+          if (diffOrder > 1)
+            ddp[i] = factor * (ddprefix[i] * suffix[i+1] + 2 * dprefix[i] * dsuffix[i+1] + prefix[i] * ddsuffix[i+1]);
+          if (i<k)
+            weight = weight * R(-(i+1)) / R(k-i);
+        }
+      }
+    };
+
+  } // namespace Impl
+
   /**@ingroup LocalBasisImplementation
      \brief Lagrange shape functions of order k on the reference cube.
 
@@ -27,107 +94,102 @@ namespace Dune
      \tparam R Type to represent the field in the range.
      \tparam k Polynomial degree
      \tparam d Dimension of the cube
+     \tparam Nodes Provides the 1d Lagrange polynomials by a static method
+                  tabulate<D,R,k>(x, diffOrder, p, dp, ddp), the default are
+                  the equidistant nodes l/k
 
      \nosubgrouping
    */
-  template<class D, class R, int k, int d>
+  template<class D, class R, int k, int d, class Nodes = Impl::QkEquidistantNodes>
   class QkLocalBasis
   {
-    // ith Lagrange polynomial of degree k in one dimension
-    static R p (int i, D x)
-    {
-      R result(1.0);
-      for (int j=0; j<=k; j++)
-        if (j!=i) result *= (k*x-j)/(i-j);
-      return result;
-    }
-
-    // derivative of ith Lagrange polynomial of degree k in one dimension
-    static R dp (int i, D x)
+    // Values and first two derivatives of all k+1 Lagrange polynomials of degree k
+    // in one dimension, tabulated at a single point
+    static void tabulate1d (D x, int diffOrder,
+                            std::array<R,k+1>& p,
+                            std::array<R,k+1>& dp,
+                            std::array<R,k+1>& ddp)
     {
-      R result(0.0);
-
-      for (int j=0; j<=k; j++)
-        if (j!=i)
-        {
-          R prod( (k*1.0)/(i-j) );
-          for (int l=0; l<=k; l++)
-            if (l!=i && l!=j)
-              prod *= (k*x-l)/(i-l);
-          result += prod;
-        }
-      return result;
+      Nodes::template tabulate<D,R,k>(x, diffOrder, p, dp, ddp);
     }
 
-    // Second derivative of j-th Lagrange polynomial of degree k in one dimension
-    // Formula and notation taken from https://en.wikipedia.org/wiki/Lagrange_polynomial#Derivatives
-    static R ddp (int j, D x)
+    // 1d tables for all coordinate directions
+    struct Tabulation
     {
-      R result(0.0);
-
-      for (int i=0; i<=k; i++)
+      Tabulation (const Dune::FieldVector<D,d>& x, int diffOrder)
       {
-        if (i==j)
-          continue;
-
-        R sum(0);
+        for (int j=0; j<d; j++)
+          tabulate1d(x[j], diffOrder, p[j], dp[j], ddp[j]);
+      }
 
-        for (int m=0; m<=k; m++)
+      // Return the table of the given derivative order in direction j
+      const std::array<R,k+1>& operator() (int j, unsigned int diffOrder) const
+      {
+        switch (diffOrder)
         {
-          if (m==i || m==j)
-            continue;
-
-          R prod( (k*1.0)/(j-m) );
-          for (int l=0; l<=k; l++)
-            if (l!=i && l!=j && l!=m)
-              prod *= (k*x-l)/(j-l);
-          sum += prod;
+          case 0 : return p[j];
+          case 1 : return dp[j];
+          case 2 : return ddp[j];
+          default :
+            DUNE_THROW(NotImplemented, "Desired derivative order is not implemented");
         }
-
-        result += sum * ( (k*1.0)/(j-i) );
       }
 
-      return result;
-    }
+      std::array<std::array<R,k+1>,d> p, dp, ddp;
+    };
 
-    // Return i as a d-digit number in the (k+1)-nary system
-    static Dune::FieldVector<int,d> multiindex (int i)
+    // Sum factorization: form all (k+1)^d products of one entry per 1d table,
+    // direction by direction.  entry(i) gives access to the ith result,
+    // where i is the shape function index with the first direction running fastest.
+    template<class Entry>
+    static void tensorProduct (const std::array<const std::array<R,k+1>*,d>& factors, Entry&& entry)
     {
-      Dune::FieldVector<int,d> alpha;
+      entry(0) = R(1);
+      std::size_t n = 1;
       for (int j=0; j<d; j++)
       {
-        alpha[j] = i % (k+1);
-        i = i/(k+1);
+        // Run backwards so that entry(b) is still the partial product when it is read
+        for (int a=k; a>=0; a--)
+          for (std::size_t b=0; b<n; b++)
+            entry(a*n+b) = entry(b) * (*factors[j])[a];
+        n *= k+1;
       }
-      return alpha;
     }
 
   public:
     typedef LocalBasisTraits<D,d,Dune::FieldVector<D,d>,R,1,Dune::FieldVector<R,1>,Dune::FieldMatrix<R,1,d> > Traits;
 
     //! \brief number of shape functions
-    unsigned int size () const
+    static constexpr unsigned int size ()
     {
       return StaticPower<k+1,d>::power;
     }
 
+    //! \brief Type used for the second derivatives in evaluateAll
+    typedef Dune::FieldMatrix<R,d,d> HessianType;
+
     //! \brief Evaluate all shape functions
     inline void evaluateFunction (const typename Traits::DomainType& in,
                                   std::vector<typename Traits::RangeType>& out) const
     {
       out.resize(size());
-      for (size_t i=0; i<size(); i++)
-      {
-        // convert index i to multiindex
-        Dune::FieldVector<int,d> alpha(multiindex(i));
+      evaluateFunctionInto(Tabulation(in, 0), out.data());
+    }
 
-        // initialize product
-        out[i] = 1.0;
+    //! \brief Evaluate all shape functions into a fixed-size buffer, without allocation
+    inline void evaluateFunction (const typename Traits::DomainType& in,
+                                  std::array<typename Traits::RangeType,StaticPower<k+1,d>::power>& out) const
+    {
+      evaluateFunctionInto(Tabulation(in, 0), out.data());
+    }
 
-        // dimension by dimension
-        for (int j=0; j<d; j++)
-          out[i] *= p(alpha[j],in[j]);
-      }
+    //! \brief Evaluate all shape functions at several points, see batchedevaluation.hh
+    inline void evaluateFunction (const std::vector<typename Traits::DomainType>& points,
+                                  std::vector<typename Traits::RangeType>& out) const
+    {
+      out.resize(points.size()*size());
+      for (std::size_t p=0; p<points.size(); p++)
+        evaluateFunctionInto(Tabulation(points[p], 0), out.data()+p*size());
     }
 
     /** \brief Evaluate Jacobian of all shape functions
@@ -139,26 +201,23 @@ namespace Dune
                       std::vector<typename Traits::JacobianType>& out) const
     {
       out.resize(size());
+      evaluateJacobianInto(Tabulation(in, 1), out.data());
+    }
 
-      // Loop over all shape functions
-      for (size_t i=0; i<size(); i++)
-      {
-        // convert index i to multiindex
-        Dune::FieldVector<int,d> alpha(multiindex(i));
-
-        // Loop over all coordinate directions
-        for (int j=0; j<d; j++)
-        {
-          // Initialize: the overall expression is a product
-          // if j-th bit of i is set to -1, else 1
-          out[i][0][j] = dp(alpha[j],in[j]);
+    //! \brief Evaluate Jacobian of all shape functions into a fixed-size buffer, without allocation
+    inline void evaluateJacobian (const typename Traits::DomainType& in,
+                                  std::array<typename Traits::JacobianType,StaticPower<k+1,d>::power>& out) const
+    {
+      evaluateJacobianInto(Tabulation(in, 1), out.data());
+    }
 
-          // rest of the product
-          for (int l=0; l<d; l++)
-            if (l!=j)
-              out[i][0][j] *= p(alpha[l],in[l]);
-        }
-      }
+    //! \brief Evaluate Jacobian of all shape functions at several points, see batchedevaluation.hh
+    inline void evaluateJacobian (const std::vector<typename Traits::DomainType>& points,
+                                  std::vector<typename Traits::JacobianType>& out) const
+    {
+      out.resize(points.size()*size());
+      for (std::size_t p=0; p<points.size(); p++)
+        evaluateJacobianInto(Tabulation(points[p], 1), out.data()+p*size());
     }
 
     /** \brief Evaluate partial derivatives of any order of all shape functions
@@ -172,41 +231,174 @@ namespace Dune
     {
       out.resize(size());
 
-      // Loop over all shape functions
-      for (size_t i=0; i<size(); i++)
-      {
-        // convert index i to multiindex
-        Dune::FieldVector<int,d> alpha(multiindex(i));
+      unsigned int maxOrder = 0;
+      for (int l=0; l<d; l++)
+        maxOrder = std::max(maxOrder, order[l]);
+      if (maxOrder > 2)
+        DUNE_THROW(NotImplemented, "Desired derivative order is not implemented");
+
+      Tabulation tab(in, maxOrder);
 
-        // Initialize: the overall expression is a product
-        out[i][0] = 1.0;
+      std::array<const std::array<R,k+1>*,d> factors;
+      for (int l=0; l<d; l++)
+        factors[l] = &tab(l, order[l]);
+      tensorProduct(factors, [&](std::size_t i) -> R& { return out[i][0]; });
+    }
 
-        // rest of the product
-        for (std::size_t l=0; l<d; l++)
+    /** \brief Evaluate values, Jacobians and second derivatives of all shape functions at once
+     *
+     * The 1d polynomials are tabulated only once for all three quantities.
+     *
+     * \param in Position where to evaluate
+     * \param[out] values The shape function values
+     * \param[out] jacobians The Jacobians of the shape functions
+     * \param[out] hessians The matrices of second derivatives of the shape functions
+     */
+    inline void evaluateAll (const typename Traits::DomainType& in,
+                             std::vector<typename Traits::RangeType>& values,
+                             std::vector<typename Traits::JacobianType>& jacobians,
+                             std::vector<HessianType>& hessians) const
+    {
+      values.resize(size());
+      jacobians.resize(size());
+      hessians.resize(size());
+      Tabulation tab(in, 2);
+      evaluateFunctionInto(tab, values.data());
+      evaluateJacobianInto(tab, jacobians.data());
+
+      std::array<const std::array<R,k+1>*,d> factors;
+      for (int j=0; j<d; j++)
+      {
+        for (int m=0; m<=j; m++)
         {
-          switch (order[l])
-          {
-            case 0:
-              out[i][0] *= p(alpha[l],in[l]);
-              break;
-            case 1:
-              out[i][0] *= dp(alpha[l],in[l]);
-              break;
-            case 2:
-              out[i][0] *= ddp(alpha[l],in[l]);
-              break;
-            default:
-              DUNE_THROW(NotImplemented, "Desired derivative order is not implemented");
-          }
+          for (int l=0; l<d; l++)
+            factors[l] = &tab(l, (l==j) + (l==m));
+          tensorProduct(factors, [&](std::size_t i) -> R& { return hessians[i][j][m]; });
+          if (m != j)
+            for (std::size_t i=0; i<size(); i++)
+              hessians[i][m][j] = hessians[i][j][m];
         }
       }
     }
 
+    /** \brief Evaluate the combination of the shape functions with the given
+     *         coefficients, without the values of the single shape functions
+     *
+     * The coefficients are contracted with the 1d polynomials, one direction
+     * at a time (sum factorization), which costs O((k+1)^d) operations.
+     */
+    template<class C>
+    void evaluateCombination (const typename Traits::DomainType& in,
+                              const std::vector<C>& coefficients,
+                              typename Traits::RangeType& value) const
+    {
+      typename Traits::JacobianType gradient;
+      contract(Tabulation(in, 0), coefficients, value, gradient, false);
+    }
+
+    /** \brief Evaluate the combination of the shape functions with the given
+     *         coefficients and its Jacobian, see above
+     *
+     * All d+1 results are contracted at once, which costs O((k+1)^d) as well.
+     */
+    template<class C>
+    void evaluateCombination (const typename Traits::DomainType& in,
+                              const std::vector<C>& coefficients,
+                              typename Traits::RangeType& value,
+                              typename Traits::JacobianType& gradient) const
+    {
+      contract(Tabulation(in, 1), coefficients, value, gradient, true);
+    }
+
     //! \brief Polynomial order of the shape functions
     unsigned int order () const
     {
       return k;
     }
+
+  private:
+    // Contract the coefficients with the 1d polynomials, the first direction
+    // first.  After the directions 0,...,j the tensor v holds the partial sums
+    // for the value and g[l] those for the derivative in direction l <= j,
+    // both with one entry per multi-index in the directions j+1,...,d-1.
+    template<class C>
+    static void contract (const Tabulation& tab, const std::vector<C>& coefficients,
+                          typename Traits::RangeType& value,
+                          typename Traits::JacobianType& gradient,
+                          bool withGradient)
+    {
+      assert(coefficients.size() == size());
+      static const int n0 = StaticPower<k+1,d-1>::power;
+      std::array<R,n0> v;
+      std::array<std::array<R,n0>,d> g;
+
+      std::size_t n = n0;
+      for (std::size_t b=0; b<n; b++)
+      {
+        R value(0), derivative(0);
+        for (int a=0; a<=k; a++)
+        {
+          const R c = R(coefficients[b*(k+1)+a]);
+          value += c * tab.p[0][a];
+          if (withGradient)
+            derivative += c * tab.dp[0][a];
+        }
+        v[b] = value;
+        g[0][b] = derivative;
+      }
+
+      for (int j=1; j<d; j++)
+      {
+        n /= k+1;
+        // In place, as the entry b is written after the entries b*(k+1),...,b*(k+1)+k are read
+        for (std::size_t b=0; b<n; b++)
+        {
+          R value(0), derivative(0);
+          for (int a=0; a<=k; a++)
+          {
+            value += v[b*(k+1)+a] * tab.p[j][a];
+            if (withGradient)
+              derivative += v[b*(k+1)+a] * tab.dp[j][a];
+          }
+          if (withGradient)
+            for (int l=0; l<j; l++)
+            {
+              R partial(0);
+              for (int a=0; a<=k; a++)
+                partial += g[l][b*(k+1)+a] * tab.p[j][a];
+              g[l][b] = partial;
+            }
+          v[b] = value;
+          g[j][b] = derivative;
+        }
+      }
+
+      value = v[0];
+      for (int j=0; j<d; j++)
+        gradient[0][j] = g[j][0];
+    }
+
+    // Evaluate all shape functions into the size() entries starting at out
+    static void evaluateFunctionInto (const Tabulation& tab, typename Traits::RangeType* out)
+    {
+      std::array<const std::array<R,k+1>*,d> factors;
+      for (int l=0; l<d; l++)
+        factors[l] = &tab.p[l];
+      tensorProduct(factors, [&](std::size_t i) -> R& { return out[i][0]; });
+    }
+
+    // Evaluate the Jacobians of all shape functions into the size() entries starting at out
+    static void evaluateJacobianInto (const Tabulation& tab, typename Traits::JacobianType* out)
+    {
+      // Loop over all coordinate directions
+      for (int j=0; j<d; j++)
+      {
+        std::array<const std::array<R,k+1>*,d> factors;
+        for (int l=0; l<d; l++)
+          factors[l] = (l==j) ? &tab.dp[l] : &tab.p[l];
+        tensorProduct(factors, [&](std::size_t i) -> R& { return out[i][0][j]; });
+      }
+    }
   };
 }
 
@@ -0,0 +1,345 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+
+#ifndef DUNE_LOCALFUNCTIONS_QKSUMFACTORIZATION_HH
+#define DUNE_LOCALFUNCTIONS_QKSUMFACTORIZATION_HH
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+#include <dune/common/fvector.hh>
+#include <dune/common/power.hh>
+
+#include <dune/geometry/quadraturerules.hh>
+#include <dune/geometry/type.hh>
+
+#include <dune/localfunctions/lagrange/qk/qklocalbasis.hh>
+
+
+namespace Dune
+{
+  /** \brief Matrix-free application of the QkLocalBasis at the points of a
+   *         tensor product quadrature rule
+   *
+   * Let B be the matrix of the values of the (k+1)^d shape functions at
+   * the q^d points of the tensor product of a 1d quadrature rule with q
+   * points, and B_j the matrix of their derivatives in direction j.  This
+   * class applies
+   * - interpolateToQuadrature(): B and B_j to a coefficient vector, i.e.,
+   *   it evaluates the discrete function and its gradient at all points,
+   * - integrateFromQuadrature(): the transposed matrices to data given at
+   *   the points, i.e., it tests the data with all shape functions.
+   *
+   * The matrices are never formed.  As the shape functions are products of
+   * the 1d Lagrange polynomials of the QkLocalBasis, both operations are
+   * sequences of contractions with the 1d matrices of size q x (k+1), one
+   * direction at a time (sum factorization).  This costs O(d^2 q^d (k+1))
+   * instead of O(d q^d (k+1)^d) operations.
+   *
+   * Quadrature weights and geometry factors are not applied, the caller
+   * multiplies the data at the points by them between the two operations.
+   * The points are numbered like the shape functions, the first direction
+   * running fastest, see quadratureRule().
+   *
+   * The methods are templates in the type V of coefficients and point data.
+   * Besides the range field, V may be a SIMD vector type, with the data of a
+   * different element in each lane, which vectorizes over elements.  V has
+   * to be constructible from 0 and support V += R*V.
+   *
+   * The methods are reentrant and may be called concurrently.
+   *
+   * \tparam D Type to represent the field in the domain
+   * \tparam R Type to represent the field in the range
+   * \tparam k Polynomial degree
+   * \tparam d Dimension of the cube
+   * \tparam Nodes The nodes of the shape functions, as for QkLocalBasis
+   */
+  template<class D, class R, int k, int d, class Nodes = Impl::QkEquidistantNodes>
+  class QkSumFactorization
+  {
+    // The tensor product rule, whose constructor is not public in the base class
+    struct Rule
+      : public QuadratureRule<D,d>
+    {
+      Rule (const QuadratureRule<D,1>& rule1d)
+        : QuadratureRule<D,d>(GeometryTypes::cube(d), rule1d.order())
+      {
+        const std::size_t q = rule1d.size();
+        std::size_t size = 1;
+        for (int j=0; j<d; j++)
+          size *= q;
+        this->reserve(size);
+        for (std::size_t i=0; i<size; i++)
+        {
+          FieldVector<D,d> x;
+          D weight(1);
+          std::size_t rest = i;
+          for (int j=0; j<d; j++, rest /= q)
+          {
+            x[j] = rule1d[rest % q].position()[0];
+            weight *= rule1d[rest % q].weight();
+          }
+          this->push_back(QuadraturePoint<D,d>(x, weight));
+        }
+      }
+    };
+
+    // A 1d matrix, stored row by row
+    struct Matrix
+    {
+      std::size_t rows, cols;
+      std::vector<R> entries;
+    };
+
+  public:
+    //! \brief Number of shape functions
+    static constexpr unsigned int size ()
+    {
+      return StaticPower<k+1,d>::power;
+    }
+
+    /** \brief Construct for the tensor product of the given rule on [0,1]
+     *
+     * For the Gauss-Lobatto rule of the QkGLLLocalBasis, which is the
+     * tensor product of its 1d rule, the values are the identity.
+     */
+    explicit QkSumFactorization (const QuadratureRule<D,1>& rule1d)
+      : rule_(rule1d)
+    {
+      const std::size_t q = rule1d.size();
+      values_.rows = derivatives_.rows = q;
+      values_.cols = derivatives_.cols = k+1;
+      values_.entries.resize(q*(k+1));
+      derivatives_.entries.resize(q*(k+1));
+
+      std::array<R,k+1> p, dp, ddp;
+      for (std::size_t l=0; l<q; l++)
+      {
+        Nodes::template tabulate<D,R,k>(rule1d[l].position()[0], 1, p, dp, ddp);
+        for (int i=0; i<=k; i++)
+        {
+          values_.entries[l*(k+1)+i] = p[i];
+          derivatives_.entries[l*(k+1)+i] = dp[i];
+        }
+      }
+
+      transposedValues_ = transpose(values_);
+      transposedDerivatives_ = transpose(derivatives_);
+    }
+
+    //! \brief Construct for the tensor Gauss rule of the given order
+    explicit QkSumFactorization (int order)
+      : QkSumFactorization(QuadratureRules<D,1>::rule(GeometryTypes::line, order))
+    {}
+
+    //! \brief The tensor product quadrature rule, whose points are the evaluation points
+    const QuadratureRule<D,d>& quadratureRule () const
+    {
+      return rule_;
+    }
+
+    //! \brief Number of quadrature points
+    std::size_t numPoints () const
+    {
+      return rule_.size();
+    }
+
+    /** \brief Evaluate the function with the given coefficients at all
+     *         quadrature points
+     *
+     * \param coefficients The size() coefficients
+     * \param[out] values The values at the numPoints() quadrature points
+     */
+    template<class V>
+    void interpolateToQuadrature (const std::vector<V>& coefficients,
+                                  std::vector<V>& values) const
+    {
+      assert(coefficients.size() == size());
+      std::vector<V>* buffers = scratch<V>();
+      buffers[0].assign(coefficients.begin(), coefficients.end());
+      std::array<std::size_t,d> extents;
+      extents.fill(k+1);
+      for (int j=0; j<d; j++)
+      {
+        apply(values_, j, extents, buffers[0], buffers[1]);
+        std::swap(buffers[0], buffers[1]);
+      }
+      values.assign(buffers[0].begin(), buffers[0].begin()+numPoints());
+    }
+
+    /** \brief Evaluate the function with the given coefficients and its
+     *         gradient at all quadrature points
+     *
+     * \param coefficients The size() coefficients
+     * \param[out] values The values at the numPoints() quadrature points
+     * \param[out] gradients The gradients with respect to the local
+     *                       coordinates at the quadrature points
+     */
+    template<class V>
+    void interpolateToQuadrature (const std::vector<V>& coefficients,
+                                  std::vector<V>& values,
+                                  std::vector<FieldVector<V,d> >& gradients) const
+    {
+      assert(coefficients.size() == size());
+      const std::size_t n = numPoints();
+      gradients.resize(n);
+
+      // The derivative in direction j is the derivative matrix in direction j
+      // and the value matrix in all others.  The contractions in the directions
+      // before j are shared with the values.
+      std::vector<V>* buffers = scratch<V>();
+      buffers[0].assign(coefficients.begin(), coefficients.end());
+      std::array<std::size_t,d> extents;
+      extents.fill(k+1);
+      for (int j=0; j<d; j++)
+      {
+        std::array<std::size_t,d> gradientExtents = extents;
+        apply(derivatives_, j, gradientExtents, buffers[0], buffers[2]);
+        for (int l=j+1; l<d; l++)
+        {
+          apply(values_, l, gradientExtents, buffers[2], buffers[3]);
+          std::swap(buffers[2], buffers[3]);
+        }
+        for (std::size_t i=0; i<n; i++)
+          gradients[i][j] = buffers[2][i];
+
+        apply(values_, j, extents, buffers[0], buffers[1]);
+        std::swap(buffers[0], buffers[1]);
+      }
+      values.assign(buffers[0].begin(), buffers[0].begin()+n);
+    }
+
+    /** \brief Integrate data given at the quadrature points against all
+     *         shape functions
+     *
+     * Computes out_i = sum_p values_p phi_i(x_p), i.e., without weights.
+     *
+     * \param values The data at the numPoints() quadrature points
+     * \param[out] out The size() results
+     */
+    template<class V>
+    void integrateFromQuadrature (const std::vector<V>& values,
+                                  std::vector<V>& out) const
+    {
+      assert(values.size() == numPoints());
+      std::vector<V>* buffers = scratch<V>();
+      buffers[0].assign(values.begin(), values.end());
+      std::array<std::size_t,d> extents;
+      extents.fill(values_.rows);
+      for (int j=0; j<d; j++)
+      {
+        apply(transposedValues_, j, extents, buffers[0], buffers[1]);
+        std::swap(buffers[0], buffers[1]);
+      }
+      out.assign(buffers[0].begin(), buffers[0].begin()+size());
+    }
+
+    /** \brief Integrate data given at the quadrature points against all
+     *         shape functions and their gradients
+     *
+     * Computes out_i = sum_p (values_p phi_i(x_p) + gradients_p . grad phi_i(x_p)),
+     * i.e., without weights.
+     *
+     * \param values The data at the numPoints() quadrature points, tested with the shape functions
+     * \param gradients The data at the quadrature points, tested with the gradients
+     *                  of the shape functions with respect to the local coordinates
+     * \param[out] out The size() results
+     */
+    template<class V>
+    void integrateFromQuadrature (const std::vector<V>& values,
+                                  const std::vector<FieldVector<V,d> >& gradients,
+                                  std::vector<V>& out) const
+    {
+      const std::size_t n = numPoints();
+      assert(values.size() == n and gradients.size() == n);
+
+      // After the contractions in the directions 0,...,j, buffers[0] holds the
+      // sum of the values and the gradient components 0,...,j contracted in
+      // these directions, the component j with the derivative matrix in direction j.
+      std::vector<V>* buffers = scratch<V>();
+      buffers[0].assign(values.begin(), values.end());
+      std::array<std::size_t,d> extents;
+      extents.fill(values_.rows);
+      for (int j=0; j<d; j++)
+      {
+        buffers[2].resize(n);
+        for (std::size_t i=0; i<n; i++)
+          buffers[2][i] = gradients[i][j];
+        std::array<std::size_t,d> gradientExtents;
+        gradientExtents.fill(values_.rows);
+        for (int l=0; l<j; l++)
+        {
+          apply(transposedValues_, l, gradientExtents, buffers[2], buffers[3]);
+          std::swap(buffers[2], buffers[3]);
+        }
+        apply(transposedDerivatives_, j, gradientExtents, buffers[2], buffers[3]);
+
+        apply(transposedValues_, j, extents, buffers[0], buffers[1]);
+        std::swap(buffers[0], buffers[1]);
+        for (std::size_t i=0; i<buffers[0].size(); i++)
+          buffers[0][i] += buffers[3][i];
+      }
+      out.assign(buffers[0].begin(), buffers[0].begin()+size());
+    }
+
+  private:
+    static Matrix transpose (const Matrix& matrix)
+    {
+      Matrix transposed;
+      transposed.rows = matrix.cols;
+      transposed.cols = matrix.rows;
+      transposed.entries.resize(matrix.entries.size());
+      for (std::size_t r=0; r<matrix.rows; r++)
+        for (std::size_t c=0; c<matrix.cols; c++)
+          transposed.entries[c*matrix.rows+r] = matrix.entries[r*matrix.cols+c];
+      return transposed;
+    }
+
+    // Contract the tensor in with the given extents, the first direction
+    // running fastest, with the 1d matrix in direction j.  extents[j] has to
+    // be matrix.cols, and is replaced by matrix.rows.
+    template<class V>
+    static void apply (const Matrix& matrix, int j, std::array<std::size_t,d>& extents,
+                       const std::vector<V>& in, std::vector<V>& out)
+    {
+      assert(extents[j] == matrix.cols);
+      std::size_t before = 1, after = 1;
+      for (int l=0; l<j; l++)
+        before *= extents[l];
+      for (int l=j+1; l<d; l++)
+        after *= extents[l];
+
+      out.assign(before*matrix.rows*after, V(0));
+      for (std::size_t a=0; a<after; a++)
+        for (std::size_t r=0; r<matrix.rows; r++)
+        {
+          V* o = out.data() + (a*matrix.rows + r)*before;
+          for (std::size_t c=0; c<matrix.cols; c++)
+          {
+            const R& coefficient = matrix.entries[r*matrix.cols+c];
+            const V* i = in.data() + (a*matrix.cols + c)*before;
+            for (std::size_t b=0; b<before; b++)
+              o[b] += coefficient * i[b];
+          }
+        }
+      extents[j] = matrix.rows;
+    }
+
+    // Four buffers per thread and data type, reused between the calls
+    template<class V>
+    static std::vector<V>* scratch ()
+    {
+      thread_local std::array<std::vector<V>,4> buffers;
+      return buffers.data();
+    }
+
+    Rule rule_;
+    Matrix values_, derivatives_, transposedValues_, transposedDerivatives_;
+  };
+
+}
+
+#endif
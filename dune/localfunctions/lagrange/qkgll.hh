@@ -0,0 +1,103 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+
+#ifndef DUNE_LOCALFUNCTIONS_QKGLL_LOCALFINITEELEMENT_HH
+#define DUNE_LOCALFUNCTIONS_QKGLL_LOCALFINITEELEMENT_HH
+
+#include <dune/geometry/type.hh>
+
+#include <dune/localfunctions/common/localfiniteelementtraits.hh>
+
+#include "qk/qklocalcoefficients.hh"
+#include "qkgll/qkglllocalbasis.hh"
+#include "qkgll/qkglllocalinterpolation.hh"
+#include "qkgll/qkgllquadrature.hh"
+
+namespace Dune
+{
+  /** \brief Spectral Lagrange finite element for cubes with the
+   *         Gauss-Lobatto-Legendre points as nodes
+   *
+   * The element spans the same space Q_k as the QkLocalFiniteElement and has
+   * the same local keys, but the nodes of the shape functions are the
+   * tensor products of the k+1 Gauss-Lobatto points.  These are the points
+   * of the QkGLLQuadratureRule returned by quadratureRule(), in the order of
+   * the shape functions.  Hence
+   * - the mass matrix assembled with this rule is diagonal, its entries
+   *   being the quadrature weights,
+   * - the values of the shape functions at the quadrature points form the
+   *   identity, and
+   * - functions known at the quadrature points are interpolated without
+   *   evaluation, see QkGLLLocalInterpolation::interpolateNodalValues().
+   *
+   * In contrast to the equidistant nodes, the interpolation stays well
+   * conditioned for high orders.
+   *
+   * \tparam D type used for domain coordinates
+   * \tparam R type used for function values
+   * \tparam d dimension of the reference element
+   * \tparam k polynomial order, at least 1
+   */
+  template<class D, class R, int d, int k>
+  class QkGLLLocalFiniteElement {
+
+    static_assert(k >= 1, "QkGLLLocalFiniteElement needs a polynomial order of at least 1");
+
+    typedef QkGLLLocalBasis<D,R,k,d> LocalBasis;
+    typedef QkLocalCoefficients<k,d> LocalCoefficients;
+    typedef QkGLLLocalInterpolation<k,d,LocalBasis> LocalInterpolation;
+
+  public:
+
+    typedef LocalFiniteElementTraits<LocalBasis,LocalCoefficients,LocalInterpolation> Traits;
+
+    //! \brief The quadrature rule whose points are the nodes
+    typedef QkGLLQuadratureRule<D,d,R> QuadratureRule;
+
+    QkGLLLocalFiniteElement ()
+    {}
+
+    const typename Traits::LocalBasisType& localBasis () const
+    {
+      return basis;
+    }
+
+    const typename Traits::LocalCoefficientsType& localCoefficients () const
+    {
+      return coefficients;
+    }
+
+    const typename Traits::LocalInterpolationType& localInterpolation () const
+    {
+      return interpolation;
+    }
+
+    /** \brief Number of shape functions in this finite element */
+    static constexpr unsigned int size ()
+    {
+      return Traits::LocalBasisType::size();
+    }
+
+    static constexpr GeometryType type ()
+    {
+      return GeometryTypes::cube(d);
+    }
+
+    /** \brief The Gauss-Lobatto rule of order 2k-1 whose ith point is the
+     *         node of the ith shape function
+     */
+    static const QuadratureRule& quadratureRule ()
+    {
+      static const QuadratureRule rule(k);
+      return rule;
+    }
+
+  private:
+    LocalBasis basis;
+    LocalCoefficients coefficients;
+    LocalInterpolation interpolation;
+  };
+
+}
+
+#endif
@@ -0,0 +1,124 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+
+#ifndef DUNE_LOCALFUNCTIONS_QKGLLLOCALBASIS_HH
+#define DUNE_LOCALFUNCTIONS_QKGLLLOCALBASIS_HH
+
+#include <array>
+#include <vector>
+
+#include <dune/localfunctions/lagrange/lobattopoints.hh>
+#include <dune/localfunctions/lagrange/qk/qklocalbasis.hh>
+
+
+namespace Dune
+{
+  namespace Impl
+  {
+
+    // The Gauss-Lobatto-Legendre nodes of the QkGLLLocalBasis
+    struct QkGaussLobattoNodes
+    {
+      // The k+1 Gauss-Lobatto points in [0,1], computed once
+      template<class R, int k>
+      static const std::array<R,k+1>& nodes ()
+      {
+        static const std::array<R,k+1> nodes = [] () {
+            const std::vector<R> lobatto = lobattoNodes<R>(k);
+            std::array<R,k+1> nodes;
+            for (int i=0; i<=k; i++)
+              nodes[i] = lobatto[i];
+            return nodes;
+          } ();
+        return nodes;
+      }
+
+      // The barycentric weights 1/prod_{l!=i} (x_i-x_l) of the nodes
+      template<class R, int k>
+      static const std::array<R,k+1>& weights ()
+      {
+        static const std::array<R,k+1> weights = [] () {
+            const std::array<R,k+1>& x = nodes<R,k>();
+            std::array<R,k+1> weights;
+            for (int i=0; i<=k; i++)
+            {
+              R product(1);
+              for (int l=0; l<=k; l++)
+                if (l != i)
+                  product *= x[i] - x[l];
+              weights[i] = R(1) / product;
+            }
+            return weights;
+          } ();
+        return weights;
+      }
+
+      // Values and first two derivatives of all k+1 Lagrange polynomials on the
+      // Gauss-Lobatto points, tabulated at a single point.  By the first barycentric
+      // form, the ith polynomial is its barycentric weight times the product of the
+      // linear factors (x-x_l), l!=i.  As for the equidistant nodes, these products
+      // are assembled from prefix and suffix products in O(k) operations, which
+      // needs no special case at the nodes.
+      template<class D, class R, int k>
+      static void tabulate (D x, int diffOrder,
+                            std::array<R,k+1>& p,
+                            std::array<R,k+1>& dp,
+                            std::array<R,k+1>& ddp)
+      {
+        const std::array<R,k+1>& nodes = QkGaussLobattoNodes::nodes<R,k>();
+        const std::array<R,k+1>& weights = QkGaussLobattoNodes::weights<R,k>();
+
+        // prefix[l] and suffix[l] hold the products over the factors 0..l-1 and l..k
+        // together with their first and second derivatives
+        std::array<R,k+2> prefix, dprefix, ddprefix, suffix, dsuffix, ddsuffix;
+
+        prefix[0] = R(1); dprefix[0] = R(0); ddprefix[0] = R(0);
+        for (int l=0; l<=k; l++)
+        {
+          R a = x-nodes[l];
+          ddprefix[l+1] = ddprefix[l]*a + 2*dprefix[l];
+          dprefix[l+1] = dprefix[l]*a + prefix[l];
+          prefix[l+1] = prefix[l]*a;
+        }
+
+        suffix[k+1] = R(1); dsuffix[k+1] = R(0); ddsuffix[k+1] = R(0);
+        for (int l=k; l>=0; l--)
+        {
+          R a = x-nodes[l];
+          ddsuffix[l] = ddsuffix[l+1]*a + 2*dsuffix[l+1];
+          dsuffix[l] = dsuffix[l+1]*a + suffix[l+1];
+          suffix[l] = suffix[l+1]*a;
+        }
+
+        for (int i=0; i<=k; i++)
+        {
+          p[i] = weights[i] * prefix[i] * suffix[i+1];
+          if (diffOrder > 0)
+            dp[i] = weights[i] * (dprefix[i] * suffix[i+1] + prefix[i] * dsuffix[i+1]);
+          if (diffOrder > 1)
+            ddp[i] = weights[i] * (ddprefix[i] * suffix[i+1] + 2 * dprefix[i] * dsuffix[i+1] + prefix[i] * ddsuffix[i+1]);
+        }
+      }
+    };
+
+  } // namespace Impl
+
+  /**@ingroup LocalBasisImplementation
+     \brief Lagrange shape functions of order k on the reference cube with
+            the Gauss-Lobatto-Legendre points as nodes.
+
+     The spectral element basis, see QkGLLLocalFiniteElement.  It provides
+     the same methods as the QkLocalBasis, i.e., the evaluation by sum
+     factorization of the 1d polynomials.
+
+     \tparam D Type to represent the field in the domain.
+     \tparam R Type to represent the field in the range, also used for the
+               nodes, hence it has to be a scalar field
+     \tparam k Polynomial degree, at least 1
+     \tparam d Dimension of the cube
+   */
+  template<class D, class R, int k, int d>
+  using QkGLLLocalBasis = QkLocalBasis<D,R,k,d,Impl::QkGaussLobattoNodes>;
+}
+
+#endif
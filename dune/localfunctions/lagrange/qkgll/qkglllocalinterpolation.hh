@@ -0,0 +1,70 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+
+#ifndef DUNE_LOCALFUNCTIONS_QKGLLLOCALINTERPOLATION_HH
+#define DUNE_LOCALFUNCTIONS_QKGLLLOCALINTERPOLATION_HH
+
+#include <cassert>
+#include <vector>
+
+#include <dune/common/power.hh>
+
+#include <dune/localfunctions/lagrange/qkgll/qkglllocalbasis.hh>
+
+
+namespace Dune
+{
+  /** \brief Interpolation in the nodes of the QkGLLLocalBasis
+   *
+   * The nodes are the points of the QkGLLQuadratureRule in the same order.
+   * Hence values of a function at these quadrature points, which are
+   * usually known anyway, are the coefficients of its interpolation, see
+   * interpolateNodalValues().
+   */
+  template<int k, int d, class LB>
+  class QkGLLLocalInterpolation
+  {
+    static const int size = StaticPower<k+1,d>::power;
+
+  public:
+
+    //! \brief Local interpolation of a function
+    template<typename F, typename C>
+    void interpolate (const F& f, std::vector<C>& out) const
+    {
+      typedef typename LB::Traits::RangeFieldType RF;
+      const std::array<RF,k+1>& nodes = Impl::QkGaussLobattoNodes::nodes<RF,k>();
+
+      typename LB::Traits::DomainType x;
+      typename LB::Traits::RangeType y;
+
+      out.resize(size);
+      for (int i=0; i<size; i++)
+      {
+        // the coordinates of the ith node, the first direction running fastest
+        for (int j=0, rest=i; j<d; j++, rest /= k+1)
+          x[j] = nodes[rest % (k+1)];
+
+        f.evaluate(x,y); out[i] = y;
+      }
+    }
+
+    /** \brief Local interpolation of a function given by its values at the
+     *         points of the QkGLLQuadratureRule
+     *
+     * No function is evaluated, the coefficients are the given values.
+     */
+    template<typename C>
+    void interpolateNodalValues (const std::vector<typename LB::Traits::RangeType>& values,
+                                 std::vector<C>& out) const
+    {
+      assert(values.size() == std::size_t(size));
+      out.resize(size);
+      for (int i=0; i<size; i++)
+        out[i] = values[i];
+    }
+  };
+
+}
+
+#endif
@@ -0,0 +1,84 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+
+#ifndef DUNE_LOCALFUNCTIONS_QKGLLQUADRATURE_HH
+#define DUNE_LOCALFUNCTIONS_QKGLLQUADRATURE_HH
+
+#include <cstddef>
+#include <vector>
+
+#include <dune/common/fvector.hh>
+
+#include <dune/geometry/quadraturerules.hh>
+#include <dune/geometry/type.hh>
+
+#include <dune/localfunctions/lagrange/lobattopoints.hh>
+#include <dune/localfunctions/utility/field.hh>
+
+
+namespace Dune
+{
+  /** \brief Tensor product Gauss-Lobatto quadrature on the reference cube
+   *         whose points are the nodes of the QkGLLLocalBasis of order k
+   *
+   * The ith quadrature point is the node of the ith shape function, the
+   * first direction running fastest.  The rule with (k+1)^d points is exact
+   * for polynomials of degree 2k-1 in each variable.  Used for the mass
+   * matrix of the QkGLLLocalFiniteElement, it yields the diagonal matrix
+   * of the weights, since the shape functions vanish at all other points.
+   *
+   * The nodes and the weights are computed in the field R of the basis,
+   * like the nodes of the QkGLLLocalBasis, and then converted to ct.
+   * Hence the points are the nodes of the basis even if ct differs from R.
+   *
+   * \tparam ct coordinate type of the rule
+   * \tparam d  dimension of the cube
+   * \tparam R  range field of the QkGLLLocalBasis whose nodes are the points
+   */
+  template<class ct, int d, class R = ct>
+  class QkGLLQuadratureRule
+    : public QuadratureRule<ct,d>
+  {
+    typedef QuadratureRule<ct,d> Base;
+
+  public:
+    explicit QkGLLQuadratureRule (int k)
+      : Base(GeometryTypes::cube(d), 2*k-1)
+    {
+      // the weight of the point x_j in [0,1] is 1/(k(k+1) P_k(2x_j-1)^2)
+      const std::vector<R> nodes = lobattoNodes<R>(k);
+      std::vector<ct> points(k+1), weights(k+1);
+      for (int j=0; j<=k; j++)
+      {
+        const R t = R(2)*nodes[j] - R(1);
+        R q(1), p(t);
+        for (int l=2; l<=k; l++)
+        {
+          const R r = (R(2*l-1) * t * p - R(l-1) * q) / R(l);
+          q = p;
+          p = r;
+        }
+        field_cast(nodes[j], points[j]);
+        field_cast(R(1) / (R(k) * R(k+1) * p * p), weights[j]);
+      }
+
+      std::size_t size = 1;
+      for (int j=0; j<d; j++)
+        size *= k+1;
+      this->reserve(size);
+      for (std::size_t i=0; i<size; i++)
+      {
+        FieldVector<ct,d> x;
+        ct weight(1);
+        for (int j=0, rest=i; j<d; j++, rest /= k+1)
+        {
+          x[j] = points[rest % (k+1)];
+          weight *= weights[rest % (k+1)];
+        }
+        this->push_back(QuadraturePoint<ct,d>(x, weight));
+      }
+    }
+  };
+}
+
+#endif
@@ -64,7 +64,8 @@ namespace Dune {
     void evaluateFunction(const typename Traits::DomainLocal& in,
                           std::vector<typename Traits::Range>& out) const
     {
-      std::vector<typename Backend::Traits::Range> backendValues;
+      // reuse the scratch buffer of this thread instead of allocating it anew
+      static thread_local std::vector<typename Backend::Traits::Range> backendValues;
       backend->evaluateFunction(in, backendValues);
       out.assign(size(), typename Traits::Range(0));
       for(std::size_t d = 0; d < dimR; ++d)
@@ -76,7 +77,8 @@ namespace Dune {
     void evaluateJacobian(const typename Traits::DomainLocal& in,
                           std::vector<typename Traits::Jacobian>& out) const
     {
-      std::vector<typename Backend::Traits::Jacobian> backendValues;
+      // reuse the scratch buffer of this thread instead of allocating it anew
+      static thread_local std::vector<typename Backend::Traits::Jacobian> backendValues;
       backend->evaluateJacobian(in, backendValues);
       out.assign(size(), typename Traits::Jacobian(0));
       for(std::size_t d = 0; d < dimR; ++d)
@@ -3,6 +3,8 @@
 #ifndef DUNE_LOCALFUNCTIONS_MONOMIAL_MONOMIALLOCALINTERPOLATION_HH
 #define DUNE_LOCALFUNCTIONS_MONOMIAL_MONOMIALLOCALINTERPOLATION_HH
 
+#include <array>
+#include <cstddef>
 #include <vector>
 
 #include <dune/common/fvector.hh>
@@ -24,7 +26,6 @@ namespace Dune
     typedef typename LB::Traits::RangeFieldType RF;
 
     typedef QuadratureRule<DF,dimD> QR;
-    typedef typename QR::iterator QRiterator;
 
   public:
     MonomialLocalInterpolation (const GeometryType &gt_,
@@ -37,16 +38,25 @@ namespace Dune
         DUNE_THROW(Exception, "size template parameter does not match size of "
                    "local basis");
 
-      const QRiterator qrend = qr.end();
-      for(QRiterator qrit = qr.begin(); qrit != qrend; ++qrit) {
-        std::vector<R> base;
-        lb.evaluateFunction(qrit->position(),base);
+      std::vector<std::vector<R> > base(qr.size());
+      for(std::size_t q = 0; q < qr.size(); ++q) {
+        lb.evaluateFunction(qr[q].position(),base[q]);
 
         for(unsigned int i = 0; i < size; ++i)
           for(unsigned int j = 0; j < size; ++j)
-            Minv[i][j] += qrit->weight() * base[i] * base[j];
+            Minv[i][j] += qr[q].weight() * base[q][i] * base[q][j];
       }
       Minv.invert();
+
+      // Store the weighted rows of Minv*base for every quadrature point, so
+      // that interpolate() neither evaluates the basis nor allocates
+      projection.resize(qr.size());
+      for(std::size_t q = 0; q < qr.size(); ++q)
+        for(unsigned int i = 0; i < size; ++i) {
+          projection[q][i] = 0;
+          for(unsigned int j = 0; j < size; ++j)
+            projection[q][i].axpy(Minv[i][j] * qr[q].weight(), base[q][j]);
+        }
     }
 
     /** \brief Determine coefficients interpolating a given function
@@ -62,18 +72,12 @@ namespace Dune
       out.clear();
       out.resize(size, 0);
 
-      const QRiterator qrend = qr.end();
-      for(QRiterator qrit = qr.begin(); qrit != qrend; ++qrit) {
-        //TODO: mass matrix
+      for(std::size_t q = 0; q < qr.size(); ++q) {
         R y;
-        f.evaluate(qrit->position(),y);
-
-        std::vector<R> base;
-        lb.evaluateFunction(qrit->position(),base);
+        f.evaluate(qr[q].position(),y);
 
         for(unsigned int i = 0; i < size; ++i)
-          for(unsigned int j = 0; j < size; ++j)
-            out[i] += Minv[i][j] * qrit->weight() * y * base[j];
+          out[i] += y * projection[q][i];
       }
     }
 
@@ -82,6 +86,7 @@ namespace Dune
     const LB &lb;
     FieldMatrix<RF, size, size> Minv;
     const QR &qr;
+    std::vector<std::array<R, size> > projection;
   };
 
 }
@@ -6,6 +6,7 @@
 #include <dune/localfunctions/utility/localfiniteelement.hh>
 #include <dune/localfunctions/utility/dglocalcoefficients.hh>
 #include <dune/localfunctions/utility/l2interpolation.hh>
+#include <dune/localfunctions/orthonormal/dubinerbasis.hh>
 #include <dune/localfunctions/orthonormal/orthonormalbasis.hh>
 
 namespace Dune
@@ -47,6 +48,41 @@ namespace Dune
     {}
   };
 
+
+  /**
+   * \brief Orthonormal basis functions on simplices evaluated by
+   *        recurrences
+   *
+   * The same space as the OrthonormalLocalFiniteElement on simplices, but
+   * the basis is the Dubiner basis (see Dune::DubinerBasis).  It needs no
+   * coefficient matrix and hence no high precision compute field, and it
+   * is evaluated in O(size()) operations.
+   *
+   * \ingroup Orthonormal
+   *
+   * \tparam dimDomain dimension of reference elements
+   * \tparam D domain for basis functions
+   * \tparam R range for basis functions
+   **/
+  template< unsigned int dimDomain, class D, class R >
+  class DubinerLocalFiniteElement
+    : public GenericLocalFiniteElement< DubinerBasisFactory< dimDomain, D, R >,
+          DGLocalCoefficientsFactory< DubinerBasisFactory< dimDomain, D, R > >,
+          LocalL2InterpolationFactory< DubinerBasisFactory< dimDomain, D, R >,true > >
+  {
+    typedef GenericLocalFiniteElement< DubinerBasisFactory< dimDomain, D, R >,
+        DGLocalCoefficientsFactory< DubinerBasisFactory< dimDomain, D, R > >,
+        LocalL2InterpolationFactory< DubinerBasisFactory< dimDomain, D, R >,true > > Base;
+  public:
+    using typename Base::Traits;
+
+    /** \brief construct the element of the given order on a simplex
+     */
+    DubinerLocalFiniteElement ( const GeometryType &gt, unsigned int order )
+      : Base(gt, order)
+    {}
+  };
+
 }
 
 #endif
@@ -0,0 +1,381 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#ifndef DUNE_DUBINERBASIS_HH
+#define DUNE_DUBINERBASIS_HH
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+#include <dune/common/fmatrix.hh>
+#include <dune/common/fvector.hh>
+
+#include <dune/geometry/topologyfactory.hh>
+#include <dune/geometry/type.hh>
+
+#include <dune/localfunctions/common/localbasis.hh>
+#include <dune/localfunctions/utility/field.hh>
+
+namespace Dune
+{
+
+  // DubinerBasis
+  // ------------
+
+  /**
+   * @brief Orthonormal basis of Pk on the reference simplex evaluated by
+   *        three-term recurrences
+   *
+   * The basis functions are the products of Jacobi polynomials in the
+   * collapsed coordinates of the simplex (Dubiner or Koornwinder basis).
+   * With s_k = 1 - x_{k+1} - ... - x_{dim-1}, the basis function with
+   * index (n_0, ..., n_{dim-1}) is
+   * \f[
+   *   \phi_n(x) = c_n \prod_{k=0}^{dim-1} s_k^{n_k} P_{n_k}^{(a_k,0)}( 2x_k/s_k - 1 ),
+   *   \qquad a_k = 2(n_0 + \dots + n_{k-1}) + k,
+   * \f]
+   * where c_n normalizes the function in L2 of the reference simplex.
+   * Each factor is a polynomial in x_k and s_k, which is computed by the
+   * homogenized recurrence of the Jacobi polynomials, so that the
+   * evaluation is well defined at the collapsed vertex as well.
+   *
+   * In contrast to the OrthonormalBasisFactory, there is no coefficient
+   * matrix.  Nothing has to be computed on construction, and all basis
+   * functions and their derivatives at a point are evaluated in O(size())
+   * operations, which is stable in double precision for any order.  The
+   * functions are ordered by their total degree, so that the first
+   * (k+dim)!/(k!dim!) of them span Pk.
+   *
+   * The evaluation uses a thread-local scratch buffer, hence one basis
+   * object can be evaluated by several threads at the same time.
+   *
+   * \tparam dim dimension of the reference simplex
+   * \tparam D   field type of the domain
+   * \tparam R   field type of the range, used for the computation
+   **/
+  template< unsigned int dim, class D = double, class R = double >
+  class DubinerBasis
+  {
+    typedef DubinerBasis< dim, D, R > This;
+
+  public:
+    typedef R StorageField;
+
+    static const unsigned int dimension = dim;
+    static const unsigned int dimRange = 1;
+
+    typedef LocalBasisTraits< D, dim, FieldVector< D, dim >, R, 1, FieldVector< R, 1 >,
+        FieldMatrix< R, 1, dim > > Traits;
+    typedef FieldVector< R, dim > DomainVector;
+
+    explicit DubinerBasis ( unsigned int order )
+      : order_( order ),
+        coefficients_( dim*(order+1)*(order+1) )
+    {
+      // recurrence coefficients for every level k and every offset
+      // N = n_0 + ... + n_{k-1}, see Coefficients
+      for( unsigned int k = 0; k < dim; ++k )
+        for( unsigned int offset = 0; offset <= order; ++offset )
+        {
+          const R a = R( 2*offset + k );
+          for( unsigned int n = 1; n + offset <= order; ++n )
+          {
+            Coefficients &c = coefficients_[ index( k, offset, n ) ];
+            if( n == 1 )
+            {
+              // P_1^{(a,0)}(t) = ((a+2)t + a)/2
+              c.A = (a + R( 2 )) / R( 2 );
+              c.B = a / R( 2 );
+              c.C = R( 0 );
+            }
+            else
+            {
+              const R m = R( n );
+              const R den = R( 2 ) * m * (m + a) * (R( 2 )*m + a - R( 2 ));
+              c.A = (R( 2 )*m + a - R( 1 )) * (R( 2 )*m + a) * (R( 2 )*m + a - R( 2 )) / den;
+              c.B = (R( 2 )*m + a - R( 1 )) * a * a / den;
+              c.C = R( 2 ) * (m + a - R( 1 )) * (m - R( 1 )) * (R( 2 )*m + a) / den;
+            }
+          }
+        }
+
+      // multi-indices ordered by total degree
+      for( unsigned int degree = 0; degree <= order; ++degree )
+      {
+        std::array< unsigned int, dim > n;
+        addIndices( dim, degree, n );
+      }
+    }
+
+    unsigned int order () const
+    {
+      return order_;
+    }
+
+    unsigned int size () const
+    {
+      return indices_.size();
+    }
+
+    //! \brief Evaluate all shape functions
+    void evaluateFunction ( const typename Traits::DomainType &x,
+                            std::vector< typename Traits::RangeType > &out ) const
+    {
+      out.resize( size() );
+      evaluate( x, out );
+    }
+
+    //! \brief Evaluate Jacobian of all shape functions
+    void evaluateJacobian ( const typename Traits::DomainType &x,
+                            std::vector< typename Traits::JacobianType > &out ) const
+    {
+      out.resize( size() );
+      jacobian( x, out );
+    }
+
+    //! \brief Evaluate partial derivatives of order at most one of all shape functions
+    void partial ( const std::array< unsigned int, dim > &order,
+                   const typename Traits::DomainType &in,
+                   std::vector< typename Traits::RangeType > &out ) const
+    {
+      const unsigned int totalOrder = std::accumulate( order.begin(), order.end(), 0u );
+      if( totalOrder == 0 )
+        evaluateFunction( in, out );
+      else if( totalOrder == 1 )
+      {
+        const unsigned int direction = std::find( order.begin(), order.end(), 1u ) - order.begin();
+        std::vector< typename Traits::JacobianType > jacobians;
+        evaluateJacobian( in, jacobians );
+        out.resize( size() );
+        for( unsigned int i = 0; i < size(); ++i )
+          out[ i ] = jacobians[ i ][ 0 ][ direction ];
+      }
+      else
+        DUNE_THROW( NotImplemented, "Desired derivative order is not implemented" );
+    }
+
+    /** \brief evaluate all basis functions at x
+     *
+     * \param x       point in the reference simplex, any vector type with
+     *                dim components
+     * \param values  container of at least size() vectors, values[ i ][ 0 ]
+     *                is set to the value of basis function i
+     */
+    template< class DVector, class RVector >
+    void evaluate ( const DVector &x, RVector &values ) const
+    {
+      assert( values.size() >= size() );
+      std::vector< R > &table = scratch();
+      fillTable< false >( convert( x ), table );
+      for( unsigned int i = 0; i < size(); ++i )
+      {
+        const Index &index = indices_[ i ];
+        R value = index.norm;
+        for( unsigned int k = 0; k < dim; ++k )
+          value *= table[ index.entry[ k ] ];
+        field_cast( value, values[ i ][ 0 ] );
+      }
+    }
+
+    /** \brief evaluate the gradients of all basis functions at x
+     *
+     * \param x       point in the reference simplex, any vector type with
+     *                dim components
+     * \param values  container of at least size() matrices, values[ i ][ 0 ]
+     *                is set to the gradient of basis function i
+     */
+    template< class DVector, class JVector >
+    void jacobian ( const DVector &x, JVector &values ) const
+    {
+      assert( values.size() >= size() );
+      std::vector< R > &table = scratch();
+      fillTable< true >( convert( x ), table );
+      for( unsigned int i = 0; i < size(); ++i )
+      {
+        const Index &index = indices_[ i ];
+        // product rule, the factor k is stored with its gradient in
+        // table[ (dim+1)*entry, ..., (dim+1)*entry + dim ]
+        R value = index.norm;
+        FieldVector< R, dim > gradient( R( 0 ) );
+        for( unsigned int k = 0; k < dim; ++k )
+        {
+          const R *factor = &(table[ (dim+1)*index.entry[ k ] ]);
+          gradient *= factor[ 0 ];
+          for( unsigned int j = 0; j < dim; ++j )
+            gradient[ j ] += value * factor[ j+1 ];
+          value *= factor[ 0 ];
+        }
+        for( unsigned int j = 0; j < dim; ++j )
+          field_cast( gradient[ j ], values[ i ][ 0 ][ j ] );
+      }
+    }
+
+  private:
+    // Q_n = (A (2x - s) + B s) Q_{n-1} - C s^2 Q_{n-2} with
+    // Q_n = s^n P_n^{(a,0)}(2x/s - 1)
+    struct Coefficients
+    {
+      R A, B, C;
+    };
+
+    struct Index
+    {
+      // position of the factor of each level in the table of fillTable()
+      std::array< unsigned int, dim > entry;
+      R norm;
+    };
+
+    unsigned int index ( unsigned int k, unsigned int offset, unsigned int n ) const
+    {
+      return (k*(order_+1) + offset)*(order_+1) + n;
+    }
+
+    // append all multi-indices with n_0 + ... + n_{level-1} = degree,
+    // n_level, ..., n_{dim-1} being given
+    void addIndices ( unsigned int level, unsigned int degree, std::array< unsigned int, dim > &n )
+    {
+      if( level == 1 )
+      {
+        n[ 0 ] = degree;
+        Index idx;
+        unsigned int offset = 0;
+        R normSquared( 1 );
+        for( unsigned int k = 0; k < dim; ++k )
+        {
+          idx.entry[ k ] = index( k, offset, n[ k ] );
+          normSquared *= R( 2*n[ k ] + 2*offset + k + 1 );
+          offset += n[ k ];
+        }
+        using std::sqrt;
+        idx.norm = sqrt( normSquared );
+        indices_.push_back( idx );
+        return;
+      }
+      for( unsigned int m = 0; m <= degree; ++m )
+      {
+        n[ level-1 ] = m;
+        addIndices( level-1, degree-m, n );
+      }
+    }
+
+    // the factors Q_n of all levels and offsets at x, followed by their
+    // gradients if jacobian is true
+    template< bool jacobian >
+    void fillTable ( const DomainVector &x, std::vector< R > &table ) const
+    {
+      const unsigned int stride = (jacobian ? dim+1 : 1);
+      table.resize( stride*coefficients_.size() );
+
+      R s( 1 );
+      for( unsigned int k = dim; k-- > 0; )
+      {
+        // the first level only occurs with offset 0
+        const unsigned int maxOffset = (k == 0 ? 0 : order_);
+        for( unsigned int offset = 0; offset <= maxOffset; ++offset )
+        {
+          R *q = &(table[ stride*index( k, offset, 0 ) ]);
+          q[ 0 ] = R( 1 );
+          for( unsigned int j = 0; j < stride-1; ++j )
+            q[ j+1 ] = R( 0 );
+          for( unsigned int n = 1; n + offset <= order_; ++n )
+          {
+            const Coefficients &c = coefficients_[ index( k, offset, n ) ];
+            R *qn = q + stride*n;
+            const R *q1 = qn - stride;
+            const R linear = c.A * (R( 2 )*x[ k ] - s) + c.B * s;
+            qn[ 0 ] = linear * q1[ 0 ];
+            if( n > 1 )
+              qn[ 0 ] -= c.C * s * s * q1[ -int( stride ) ];
+            if( !jacobian )
+              continue;
+
+            // d x_k / d x_j = delta_kj and d s / d x_j = -1 for j > k
+            for( unsigned int j = 0; j < dim; ++j )
+            {
+              const R dLinear = (j == k ? R( 2 )*c.A : (j > k ? c.A - c.B : R( 0 )));
+              qn[ j+1 ] = dLinear * q1[ 0 ] + linear * q1[ j+1 ];
+              if( n > 1 )
+              {
+                const R *q2 = q1 - stride;
+                const R ds = (j > k ? R( -1 ) : R( 0 ));
+                qn[ j+1 ] -= c.C * (R( 2 ) * s * ds * q2[ 0 ] + s * s * q2[ j+1 ]);
+              }
+            }
+          }
+        }
+        s -= x[ k ];
+      }
+    }
+
+    template< class DVector >
+    static DomainVector convert ( const DVector &x )
+    {
+      DomainVector y;
+      for( unsigned int k = 0; k < dim; ++k )
+        field_cast( x[ k ], y[ k ] );
+      return y;
+    }
+
+    static std::vector< R > &scratch ()
+    {
+      static thread_local std::vector< R > table;
+      return table;
+    }
+
+    unsigned int order_;
+    std::vector< Coefficients > coefficients_;
+    std::vector< Index > indices_;
+  };
+
+
+
+  // DubinerBasisFactory
+  // -------------------
+
+  template< unsigned int dim, class D, class R >
+  struct DubinerBasisFactory;
+
+  template< unsigned int dim, class D, class R >
+  struct DubinerBasisFactoryTraits
+  {
+    static const unsigned int dimension = dim;
+    typedef unsigned int Key;
+    typedef const DubinerBasis< dim, D, R > Object;
+    typedef DubinerBasisFactory< dim, D, R > Factory;
+  };
+
+  /**
+   * @brief A factory for the DubinerBasis, the key is the order
+   *
+   * This factory can replace the OrthonormalBasisFactory on simplices,
+   * e.g., in the DubinerLocalFiniteElement or an L2LocalFiniteElement.
+   * Requesting a basis for any other topology throws a NotImplemented
+   * exception.
+   **/
+  template< unsigned int dim, class D = double, class R = double >
+  struct DubinerBasisFactory
+    : public TopologyFactory< DubinerBasisFactoryTraits< dim, D, R > >
+  {
+    static const unsigned int dimension = dim;
+    typedef R StorageField;
+    typedef DubinerBasisFactoryTraits< dim, D, R > Traits;
+
+    typedef typename Traits::Key Key;
+    typedef typename Traits::Object Object;
+
+    template< class Topology >
+    static Object *createObject ( const Key &order )
+    {
+      if( !Impl::IsSimplex< Topology >::value )
+        DUNE_THROW( NotImplemented, "DubinerBasis is only available on simplices" );
+      return new Object( order );
+    }
+  };
+
+}
+
+#endif // #ifndef DUNE_DUBINERBASIS_HH
@@ -7,6 +7,8 @@
 
 #include <dune/geometry/topologyfactory.hh>
 
+#include <dune/localfunctions/utility/coeffmatrixcache.hh>
+#include <dune/localfunctions/utility/concurrentregistry.hh>
 #include <dune/localfunctions/utility/polynomialbasis.hh>
 #include <dune/localfunctions/orthonormal/orthonormalcompute.hh>
 
@@ -64,14 +66,22 @@ namespace Dune
     {
       const typename Traits::MonomialBasisType &monomialBasis = *Traits::MonomialBasisProviderType::template create< SimplexTopology >( order );
 
-      static typename Traits::CoefficientMatrix _coeffs;
-      if( _coeffs.size() <= monomialBasis.size() )
-      {
-        ONBCompute::ONBMatrix< Topology, ComputeField > matrix( order );
-        _coeffs.fill( matrix );
-      }
-
-      return new Basis( monomialBasis, _coeffs, monomialBasis.size() );
+      // the coefficients are computed once per order and shared by all
+      // bases of that order, possibly created from several threads
+      static ConcurrentRegistry< unsigned int, const typename Traits::CoefficientMatrix > coefficients;
+      const typename Traits::CoefficientMatrix &coeffs = *coefficients.get( order, [ order, &monomialBasis ] () {
+          auto coeffs = std::make_shared< typename Traits::CoefficientMatrix >();
+          if( !(CoeffMatrixCache::load< typename Traits::Factory, Topology, StorageField >( order, *coeffs )
+                && coeffs->size() >= monomialBasis.size()) )
+          {
+            ONBCompute::ONBMatrix< Topology, ComputeField > matrix( order );
+            coeffs->fill( matrix );
+            CoeffMatrixCache::store< typename Traits::Factory, Topology, StorageField >( order, *coeffs );
+          }
+          return coeffs;
+        } );
+
+      return new Basis( monomialBasis, coeffs, monomialBasis.size() );
     }
   };
 
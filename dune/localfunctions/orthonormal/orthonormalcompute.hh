@@ -3,12 +3,14 @@
 #ifndef DUNE_ORTHONORMALCOMPUTE_HH
 #define DUNE_ORTHONORMALCOMPUTE_HH
 
+#include <array>
 #include <cassert>
 #include <iostream>
 #include <fstream>
 #include <iomanip>
 #include <map>
 
+#include <dune/common/exceptions.hh>
 #include <dune/common/fmatrix.hh>
 
 #include <dune/geometry/type.hh>
@@ -85,9 +87,36 @@ namespace ONBCompute
 
 
 
+  // Orthonormalization
+  // ------------------
+
+  //! the method used by ONBMatrix to orthonormalize the monomials
+  enum Orthonormalization
+  {
+    //! Cholesky factorization of the Gram matrix, O(N^3) (the default)
+    cholesky,
+    //! modified Gram-Schmidt procedure, O(N^4)
+    gramSchmidt,
+    //! modified Gram-Schmidt procedure with one reorthogonalization, O(N^4)
+    gramSchmidtReorthogonalized
+  };
+
+
+
   // ONBMatrix
   // ---------
 
+  /**
+   * \brief coefficients of the orthonormal basis with respect to the
+   *        monomials
+   *
+   * Column i contains the coefficients of the i-th orthonormal function,
+   * which is a combination of the first i+1 monomials.  Hence the matrix
+   * C is upper triangular and C^T S C = I for the Gram matrix S of the
+   * monomials.  This is S = R^T R with the Cholesky factor R and
+   * C = R^{-1}, which is how C is computed by default.  The Gram-Schmidt
+   * procedure computes the same matrix and may be chosen instead.
+   */
   template< class Topology, class scalar_t >
   class ONBMatrix
     : public Dune::LFEMatrix< scalar_t >
@@ -99,7 +128,7 @@ namespace ONBCompute
     typedef std::vector< scalar_t > vec_t;
     typedef Dune::LFEMatrix< scalar_t > mat_t;
 
-    explicit ONBMatrix ( unsigned int order )
+    explicit ONBMatrix ( unsigned int order, Orthonormalization method = cholesky )
     {
       // get all multiindecies for monomial basis
       const unsigned int dim = Topology::dimension;
@@ -115,22 +144,45 @@ namespace ONBCompute
       // set bounds of data
       Base::resize( size, size );
       S.resize( size, size );
-      d.resize( size );
 
       // setup matrix for bilinear form x^T S y: S_ij = int_A x^(i+j)
+      // S_ij only depends on the exponent of x^(i+j), so the integral is
+      // computed once per exponent and S is filled symmetrically
+      typedef std::array< int, dim > Exponent;
+      std::vector< Exponent > exponents( size );
+      for( std::size_t i = 0; i < size; ++i )
+        for( unsigned int k = 0; k < dim; ++k )
+          exponents[ i ][ k ] = y[ i ][ 0 ].z( k );
+
+      std::map< Exponent, scalar_t > integrals;
       scalar_t p, q;
       for( std::size_t i = 0; i < size; ++i )
       {
-        for( std::size_t j = 0; j < size; ++j )
+        for( std::size_t j = 0; j <= i; ++j )
         {
-          Integral< Topology >::compute( y[ i ][ 0 ] * y[ j ][ 0 ], p, q );
-          S( i, j ) = p;
-          S( i, j ) /= q;
+          Exponent exponent;
+          for( unsigned int k = 0; k < dim; ++k )
+            exponent[ k ] = exponents[ i ][ k ] + exponents[ j ][ k ];
+
+          auto it = integrals.find( exponent );
+          if( it == integrals.end() )
+          {
+            MI alpha;
+            for( unsigned int k = 0; k < dim; ++k )
+              alpha.set( k, exponent[ k ] );
+            Integral< Topology >::compute( alpha, p, q );
+            it = integrals.emplace( exponent, p / q ).first;
+          }
+          S( i, j ) = it->second;
+          S( j, i ) = it->second;
         }
       }
 
       // orthonormalize
-      gramSchmidt();
+      if( method == cholesky )
+        choleskyInverse();
+      else
+        gramSchmidt( method == gramSchmidtReorthogonalized ? 2 : 1 );
     }
 
     template< class Vector >
@@ -165,7 +217,7 @@ namespace ONBCompute
         Base::operator()( i, coldest ) -= s * Base::operator()( i, colsrc );
     }
 
-    void gramSchmidt ()
+    void gramSchmidt ( unsigned int passes )
     {
       // setup identity
       const std::size_t N = Base::rows();
@@ -175,23 +227,70 @@ namespace ONBCompute
           Base::operator()( i, j ) = scalar_t( i == j ? 1 : 0 );
       }
 
-      // perform Gram-Schmidt procedure
+      // perform Gram-Schmidt procedure, projecting out the previous
+      // functions passes times
       scalar_t s;
       sprod( 0, 0, s );
       vmul( 0, 0, scalar_t( 1 ) / sqrt( s ) );
       for( std::size_t i = 1; i < N; ++i )
       {
-        for( std::size_t k = 0; k < i; ++k )
+        for( unsigned int pass = 0; pass < passes; ++pass )
         {
-          sprod( i, k, s );
-          vsub( i, k, i, s );
+          for( std::size_t k = 0; k < i; ++k )
+          {
+            sprod( i, k, s );
+            vsub( i, k, i, s );
+          }
         }
         sprod( i, i, s );
         vmul( i, i, scalar_t( 1 ) / sqrt( s ) );
       }
     }
 
-    vec_t d;
+    void choleskyInverse ()
+    {
+      const std::size_t N = Base::rows();
+
+      // S = L L^T, L is stored in the lower triangle of S
+      for( std::size_t j = 0; j < N; ++j )
+      {
+        scalar_t *lj = S.rowPtr( j );
+        for( std::size_t k = 0; k < j; ++k )
+          lj[ j ] -= lj[ k ] * lj[ k ];
+        if( !(lj[ j ] > scalar_t( 0 )) )
+          DUNE_THROW( Dune::MathError, "Gram matrix of the monomials is not positive definite" );
+        lj[ j ] = sqrt( lj[ j ] );
+        const scalar_t hr = scalar_t( 1 ) / lj[ j ];
+        for( std::size_t i = j+1; i < N; ++i )
+        {
+          scalar_t *li = S.rowPtr( i );
+          for( std::size_t k = 0; k < j; ++k )
+            li[ j ] -= li[ k ] * lj[ k ];
+          li[ j ] *= hr;
+        }
+      }
+
+      // C = R^{-1} for R = L^T by backward substitution, row by row:
+      // C_ii = 1/R_ii and C_i. = -(sum_{k>i} R_ik C_k.) / R_ii
+      for( std::size_t i = N; i-- > 0; )
+      {
+        scalar_t *ci = Base::rowPtr( i );
+        for( std::size_t j = 0; j < N; ++j )
+          ci[ j ] = scalar_t( 0 );
+        for( std::size_t k = i+1; k < N; ++k )
+        {
+          const scalar_t &rik = S( k, i );
+          const scalar_t *ck = Base::rowPtr( k );
+          for( std::size_t j = k; j < N; ++j )
+            ci[ j ] -= rik * ck[ j ];
+        }
+        const scalar_t hr = scalar_t( 1 ) / S( i, i );
+        for( std::size_t j = i+1; j < N; ++j )
+          ci[ j ] *= hr;
+        ci[ i ] = hr;
+      }
+    }
+
     mat_t S;
   };
 
@@ -42,7 +42,7 @@ namespace Dune
     }
 
     //! \brief number of shape functions
-    unsigned int size () const
+    static constexpr unsigned int size ()
     {
       return 3;
     }
@@ -2,6 +2,8 @@
 // vi: set et ts=4 sw=2 sts=2:
 #include <config.h>
 
+#include <array>
+#include <cstddef>
 #include <iostream>
 #include <typeinfo>
 #include <fenv.h>
@@ -98,6 +100,41 @@ bool testPk(const FE& local_fe)
   return true;
 }
 
+// Check that the allocation-free evaluation into a std::array agrees with
+// the evaluation into a std::vector
+template <class FE>
+bool testFixedSizeEvaluation(const FE& local_fe)
+{
+  typedef typename FE::Traits::LocalBasisType LB;
+  typedef typename LB::Traits Traits;
+  constexpr std::size_t size = LB::size();
+  static_assert(FE::size() == size, "size() of element and basis differ");
+
+  std::vector<typename Traits::RangeType> values;
+  std::vector<typename Traits::JacobianType> jacobians;
+  std::array<typename Traits::RangeType,size> fixedValues;
+  std::array<typename Traits::JacobianType,size> fixedJacobians;
+
+  const auto& quad = QuadratureRules<double,Traits::dimDomain>::rule(local_fe.type(), 3);
+  for (const auto& qp : quad)
+  {
+    local_fe.localBasis().evaluateFunction(qp.position(), values);
+    local_fe.localBasis().evaluateFunction(qp.position(), fixedValues);
+    local_fe.localBasis().evaluateJacobian(qp.position(), jacobians);
+    local_fe.localBasis().evaluateJacobian(qp.position(), fixedJacobians);
+    for (std::size_t i = 0; i < size; ++i)
+      if (std::abs(values[i] - fixedValues[i]) > epsilon
+          or (jacobians[i][0] - fixedJacobians[i][0]).infinity_norm() > epsilon)
+      {
+        std::cerr << "Bug in fixed-size evaluation of local finite element type "
+                  << typeid(FE).name() << " for shape function " << i << std::endl;
+        return false;
+      }
+  }
+
+  return true;
+}
+
 int main (int argc, char *argv[])
 {
 #if __linux__ \
@@ -133,6 +170,8 @@ int main (int argc, char *argv[])
   success &= testPk(pk32d);
   Pk2DLocalFiniteElement<double,double,4> pk42d;
   success &= testPk(pk42d);
+  Pk2DLocalFiniteElement<double,double,8> pk82d;
+  success &= testPk(pk82d);
 
   Pk3DLocalFiniteElement<double,double,1> pk13d;
   success &= testPk(pk13d);
@@ -142,6 +181,17 @@ int main (int argc, char *argv[])
   success &= testPk(pk33d);
   Pk3DLocalFiniteElement<double,double,4> pk43d;
   success &= testPk(pk43d);
+  Pk3DLocalFiniteElement<double,double,8> pk83d;
+  success &= testPk(pk83d);
+
+  success &= testFixedSizeEvaluation(p11d);
+  success &= testFixedSizeEvaluation(p13d);
+  success &= testFixedSizeEvaluation(pk32d);
+  success &= testFixedSizeEvaluation(pk43d);
+  success &= testFixedSizeEvaluation(Pk3DLocalFiniteElement<double,double,0>());
+  success &= testFixedSizeEvaluation(Q1LocalFiniteElement<double,double,3>());
+  success &= testFixedSizeEvaluation(QkLocalFiniteElement<double,double,2,3>());
+  success &= testFixedSizeEvaluation(PkLocalFiniteElement<double,double,1,3>());
 
   //////////////////////////////////////////////////////////
   //   Run the standard tests
@@ -187,7 +237,7 @@ int main (int argc, char *argv[])
   PyramidP2LocalFiniteElement<double,double> pyramidp2fem;
   TEST_FE2(pyramidp2fem, DisableJacobian);
 
-  Hybrid::forEach(std::make_index_sequence<3>{},[&success](auto i)
+  Hybrid::forEach(std::make_index_sequence<9>{},[&success](auto i)
   {
     PkLocalFiniteElement<double,double,1,i> pklfem;
     TEST_FE(pklfem);
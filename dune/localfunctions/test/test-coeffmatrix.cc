@@ -0,0 +1,180 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#include <config.h>
+
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include <dune/geometry/type.hh>
+#include <dune/geometry/quadraturerules.hh>
+
+#include <dune/localfunctions/lagrange/equidistantpoints.hh>
+#include <dune/localfunctions/lagrange/lagrangebasis.hh>
+#include <dune/localfunctions/raviartthomas/raviartthomassimplex/raviartthomassimplexbasis.hh>
+#include <dune/localfunctions/utility/coeffmatrix.hh>
+
+/**
+ * \file
+ * \brief Checks that bases using the DenseCoeffMatrix and the
+ *        AdaptiveCoeffMatrix evaluate to the same values as with the
+ *        SparseCoeffMatrix, and that the evaluation at many points at
+ *        once agrees with the evaluation point by point.  The scalar
+ *        Lagrange and the vector valued Raviart-Thomas bases cover the
+ *        block sizes 1 and dim.
+ */
+
+const double TOL = 1e-8;
+
+template <class Basis1, class Basis2>
+bool compare(const Dune::GeometryType& gt, const Basis1& basis1, const Basis2& basis2)
+{
+  const int dim = Basis1::dimension;
+  std::vector<typename Basis1::Traits::RangeType> values1, values2;
+  std::vector<Dune::FieldMatrix<double,Basis1::dimRange,dim> > jacobians1, jacobians2;
+  std::vector<Dune::FieldVector<Dune::FieldVector<double,dim>,Basis1::dimRange> > gradients1(basis1.size()), gradients2(basis2.size());
+  std::vector<Dune::FieldVector<Dune::LFETensor<double,dim,2>,Basis1::dimRange> > hessians1(basis1.size()), hessians2(basis2.size());
+  for (const auto& qp : Dune::QuadratureRules<double,dim>::rule(gt, 3))
+  {
+    basis1.evaluateFunction(qp.position(), values1);
+    basis2.evaluateFunction(qp.position(), values2);
+    basis1.evaluateJacobian(qp.position(), jacobians1);
+    basis2.evaluateJacobian(qp.position(), jacobians2);
+    basis1.template evaluateSingle<1>(qp.position(), gradients1);
+    basis2.template evaluateSingle<1>(qp.position(), gradients2);
+    basis1.template evaluateSingle<2>(qp.position(), hessians1);
+    basis2.template evaluateSingle<2>(qp.position(), hessians2);
+    for (std::size_t i = 0; i < values1.size(); ++i)
+    {
+      if ((values1[i] - values2[i]).infinity_norm() > TOL)
+        return false;
+      for (unsigned int r = 0; r < Basis1::dimRange; ++r)
+      {
+        if ((jacobians1[i][r] - jacobians2[i][r]).infinity_norm() > TOL
+            || (gradients1[i][r] - gradients2[i][r]).infinity_norm() > TOL)
+          return false;
+        for (unsigned int k = 0; k < Dune::LFETensor<double,dim,2>::size; ++k)
+          if (std::abs(hessians1[i][r].block()[k] - hessians2[i][r].block()[k]) > TOL)
+            return false;
+      }
+    }
+  }
+  return true;
+}
+
+template <class Basis>
+bool compareAtPoints(const Dune::GeometryType& gt, const Basis& basis)
+{
+  const int dim = Basis::dimension;
+  std::vector<typename Basis::Traits::DomainType> points;
+  for (const auto& qp : Dune::QuadratureRules<double,dim>::rule(gt, 12))
+    points.push_back(qp.position());
+
+  std::vector<typename Basis::Traits::RangeType> values, batchedValues;
+  std::vector<typename Basis::Traits::JacobianType> jacobians, batchedJacobians;
+  basis.evaluateFunction(points, batchedValues);
+  basis.evaluateJacobian(points, batchedJacobians);
+  if (batchedValues.size() != points.size()*basis.size()
+      || batchedJacobians.size() != points.size()*basis.size())
+    return false;
+  for (std::size_t p = 0; p < points.size(); ++p)
+  {
+    basis.evaluateFunction(points[p], values);
+    basis.evaluateJacobian(points[p], jacobians);
+    for (std::size_t i = 0; i < values.size(); ++i)
+    {
+      if ((values[i] - batchedValues[p*basis.size()+i]).infinity_norm() > TOL)
+        return false;
+      for (unsigned int r = 0; r < Basis::dimRange; ++r)
+        if ((jacobians[i][r] - batchedJacobians[p*basis.size()+i][r]).infinity_norm() > TOL)
+          return false;
+    }
+  }
+  return true;
+}
+
+template <class BasisFactory, class Topology>
+bool test(unsigned int order)
+{
+  const int dim = Topology::dimension;
+  typedef typename BasisFactory::Basis Basis;
+  typedef typename Basis::CoefficientMatrix Adaptive;
+  typedef typename Adaptive::Sparse Sparse;
+  typedef typename Adaptive::Dense Dense;
+  typedef Dune::StandardEvaluator<typename Basis::Basis> Evaluator;
+
+  bool success = true;
+  Dune::GeometryType gt(Topology::id, dim);
+  const Basis& basis = *BasisFactory::template create<Topology>(order);
+
+  Dune::PolynomialBasisWithMatrix<Evaluator,Sparse> sparse(basis.basis());
+  sparse.fill(Dune::CoeffMatrixRows<Adaptive>(basis.matrix()));
+  Dune::PolynomialBasisWithMatrix<Evaluator,Dense> dense(basis.basis());
+  dense.fill(Dune::CoeffMatrixRows<Adaptive>(basis.matrix()));
+
+  // the factory chooses the storage by the fill ratio
+  const double fillRatio = double(sparse.matrix().nonZeros())
+                           / (sparse.matrix().size()*Adaptive::blockSize*sparse.matrix().baseSize());
+  if (basis.matrix().isDense() != (fillRatio >= Adaptive::denseFillRatio()))
+  {
+    std::cout << "Wrong storage chosen for " << Topology::name() << " with order " << order
+              << " and fill ratio " << fillRatio << std::endl;
+    success = false;
+  }
+
+  if (!compare(gt, sparse, dense) || !compare(gt, sparse, basis))
+  {
+    std::cout << "Dense evaluation differs from sparse evaluation for "
+              << Topology::name() << " with order " << order << std::endl;
+    success = false;
+  }
+
+  if (!compareAtPoints(gt, sparse) || !compareAtPoints(gt, dense) || !compareAtPoints(gt, basis))
+  {
+    std::cout << "Evaluation at several points differs from pointwise evaluation for "
+              << Topology::name() << " with order " << order << std::endl;
+    success = false;
+  }
+
+  // saving and loading keeps the storage
+  std::stringstream data;
+  basis.matrix().save(data);
+  Basis loaded(basis.basis());
+  if (!loaded.load(data) || loaded.matrix().isDense() != basis.matrix().isDense()
+      || !compare(gt, basis, loaded))
+  {
+    std::cout << "Saving and loading the coefficients failed for "
+              << Topology::name() << " with order " << order << std::endl;
+    success = false;
+  }
+
+  BasisFactory::release(&basis);
+  return success;
+}
+
+template <int dim>
+using Lagrange = Dune::LagrangeBasisFactory<Dune::EquidistantPointSet,dim,double,double>;
+
+template <int dim>
+using RaviartThomas = Dune::RaviartThomasBasisFactory<dim,double,double>;
+
+int main ( int argc, char **argv )
+{
+  using namespace Dune::Impl;
+
+  bool success = true;
+  success &= test<Lagrange<2>, Pyramid<Pyramid<Point> > >(2);
+  success &= test<Lagrange<2>, Pyramid<Pyramid<Point> > >(8);
+  success &= test<Lagrange<3>, Prism<Prism<Prism<Point> > > >(1);
+  success &= test<Lagrange<3>, Prism<Prism<Prism<Point> > > >(4);
+  success &= test<Lagrange<3>, Pyramid<Pyramid<Pyramid<Point> > > >(6);
+
+  // vector valued, i.e., blockSize dim
+  success &= test<RaviartThomas<2>, Pyramid<Pyramid<Point> > >(1);
+  success &= test<RaviartThomas<2>, Pyramid<Pyramid<Point> > >(4);
+  success &= test<RaviartThomas<3>, Pyramid<Pyramid<Pyramid<Point> > > >(2);
+
+  return success ? 0 : 1;
+}
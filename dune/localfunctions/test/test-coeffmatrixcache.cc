@@ -0,0 +1,129 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#include <config.h>
+
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include <dune/geometry/type.hh>
+#include <dune/geometry/quadraturerules.hh>
+
+#include <dune/localfunctions/lagrange/equidistantpoints.hh>
+#include <dune/localfunctions/lagrange/lagrangebasis.hh>
+#include <dune/localfunctions/utility/coeffmatrixcache.hh>
+
+/**
+ * \file
+ * \brief Stores the coefficients of a Lagrange basis in the
+ *        CoeffMatrixCache, reads them back and checks that a corrupted
+ *        cache file is detected.
+ */
+
+const double TOL = 1e-12;
+
+template <class Topology, class Basis1, class Basis2>
+bool compare(const Basis1& basis1, const Basis2& basis2)
+{
+  const int dim = Topology::dimension;
+  if (basis1.size() != basis2.size())
+    return false;
+
+  Dune::GeometryType gt(Topology::id, dim);
+  std::vector<Dune::FieldVector<double,1> > values1, values2;
+  for (const auto& qp : Dune::QuadratureRules<double,dim>::rule(gt, 4))
+  {
+    basis1.evaluateFunction(qp.position(), values1);
+    basis2.evaluateFunction(qp.position(), values2);
+    for (std::size_t i = 0; i < values1.size(); ++i)
+      if (std::abs(values1[i][0] - values2[i][0]) > TOL)
+        return false;
+  }
+  return true;
+}
+
+template <class Topology>
+bool test(unsigned int order)
+{
+  typedef Dune::LagrangeBasisFactory<Dune::EquidistantPointSet,Topology::dimension,double,double> BasisFactory;
+  typedef typename BasisFactory::Traits::Factory Factory;
+  typedef typename BasisFactory::Basis Basis;
+
+  bool success = true;
+
+  const std::string file = Dune::CoeffMatrixCache::fileName<Factory,Topology,double>(order);
+  std::remove(file.c_str());
+
+  // the first creation computes the coefficients and stores them
+  const Basis& basis = *BasisFactory::template create<Topology>(order);
+  if (!std::ifstream(file))
+  {
+    std::cout << "No cache file " << file << " has been written for "
+              << Topology::name() << " with order " << order << std::endl;
+    success = false;
+  }
+
+  // the coefficients can be read back and give the same basis
+  Basis loaded(basis.basis());
+  if (!Dune::CoeffMatrixCache::load<Factory,Topology,double>(order, loaded)
+      || !compare<Topology>(basis, loaded))
+  {
+    std::cout << "Reading the cached coefficients for " << Topology::name()
+              << " with order " << order << " failed" << std::endl;
+    success = false;
+  }
+
+  // the factory uses the cached coefficients
+  const Basis& cached = *BasisFactory::template create<Topology>(order);
+  if (!compare<Topology>(basis, cached))
+  {
+    std::cout << "Basis created from the cache differs for " << Topology::name()
+              << " with order " << order << std::endl;
+    success = false;
+  }
+  BasisFactory::release(&cached);
+
+  // a corrupted file is rejected and replaced
+  {
+    std::fstream f(file, std::ios::in | std::ios::out | std::ios::binary);
+    f.seekg(-1, std::ios::end);
+    char c = f.get();
+    f.seekp(-1, std::ios::end);
+    f.put(c ^ 0x5a);
+  }
+  Basis corrupted(basis.basis());
+  if (Dune::CoeffMatrixCache::load<Factory,Topology,double>(order, corrupted))
+  {
+    std::cout << "Corrupted cache file has not been detected" << std::endl;
+    success = false;
+  }
+  const Basis& recomputed = *BasisFactory::template create<Topology>(order);
+  if (!compare<Topology>(basis, recomputed)
+      || !Dune::CoeffMatrixCache::load<Factory,Topology,double>(order, corrupted))
+  {
+    std::cout << "Coefficients have not been recomputed after detecting a corrupted cache file" << std::endl;
+    success = false;
+  }
+  BasisFactory::release(&recomputed);
+
+  BasisFactory::release(&basis);
+  std::remove(file.c_str());
+  return success;
+}
+
+int main ( int argc, char **argv )
+{
+  using namespace Dune::Impl;
+
+  Dune::CoeffMatrixCache::setDirectory(".");
+
+  bool success = true;
+  success &= test<Pyramid<Pyramid<Point> > >(4);
+  success &= test<Prism<Prism<Prism<Point> > > >(2);
+  success &= test<Pyramid<Pyramid<Pyramid<Point> > > >(3);
+
+  return success ? 0 : 1;
+}
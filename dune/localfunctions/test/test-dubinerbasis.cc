@@ -0,0 +1,131 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#include <config.h>
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+
+#include <dune/geometry/type.hh>
+#include <dune/geometry/quadraturerules.hh>
+
+#include <dune/localfunctions/orthonormal.hh>
+
+#include "test-localfe.hh"
+
+/**
+ * \file
+ * \brief Checks the DubinerBasis and the DubinerLocalFiniteElement on
+ *        simplices.
+ */
+
+// the basis is orthonormal on the reference simplex
+template <int dim>
+bool testOrthonormality(unsigned int order)
+{
+  const Dune::DubinerBasis<dim> basis(order);
+  const unsigned int size = basis.size();
+
+  std::vector< Dune::FieldVector< double, 1 > > y(size);
+  std::vector< double > m(size*size, 0.0);
+  for (const auto& qp : Dune::QuadratureRules<double,dim>::rule(Dune::GeometryTypes::simplex(dim), 2*order+1))
+  {
+    basis.evaluateFunction(qp.position(), y);
+    for (unsigned int i = 0; i < size; ++i)
+      for (unsigned int j = 0; j < size; ++j)
+        m[i*size+j] += qp.weight() * y[i] * y[j];
+  }
+
+  bool success = true;
+  for (unsigned int i = 0; i < size; ++i)
+    for (unsigned int j = 0; j < size; ++j)
+      if (std::abs(m[i*size+j] - double(i == j)) > 1e-10)
+      {
+        std::cout << "Dubiner basis in " << dim << "d of order " << order
+                  << ": (phi_" << i << ", phi_" << j << ") = " << m[i*size+j] << std::endl;
+        success = false;
+      }
+  return success;
+}
+
+// the first functions of degree at most k span the same space as the
+// orthonormal basis of order k, i.e., the matrix of their inner products
+// G_ij = (dubiner_i, onb_j) is orthogonal
+template <int dim>
+bool testSpan(unsigned int order)
+{
+  typedef typename Dune::Impl::SimplexTopology<dim>::type Topology;
+  typedef Dune::OrthonormalBasisFactory<dim,double,double> BasisFactory;
+  const typename BasisFactory::Object& onb = *BasisFactory::template create<Topology>(order);
+  const Dune::DubinerBasis<dim> basis(order + 1);
+  const unsigned int size = onb.size();
+
+  std::vector< Dune::FieldVector< double, 1 > > y(basis.size()), z(size);
+  std::vector< double > g(size*size, 0.0);
+  for (const auto& qp : Dune::QuadratureRules<double,dim>::rule(Dune::GeometryTypes::simplex(dim), 2*order+1))
+  {
+    basis.evaluateFunction(qp.position(), y);
+    onb.evaluate(qp.position(), z);
+    for (unsigned int i = 0; i < size; ++i)
+      for (unsigned int j = 0; j < size; ++j)
+        g[i*size+j] += qp.weight() * y[i] * z[j];
+  }
+  BasisFactory::release(&onb);
+
+  bool success = true;
+  for (unsigned int i = 0; i < size; ++i)
+    for (unsigned int j = 0; j < size; ++j)
+    {
+      double ggt = 0;
+      for (unsigned int k = 0; k < size; ++k)
+        ggt += g[i*size+k] * g[j*size+k];
+      if (std::abs(ggt - double(i == j)) > 1e-8)
+        success = false;
+    }
+  if (!success)
+    std::cout << "Dubiner basis in " << dim << "d of order " << order
+              << " does not span the same space as the orthonormal basis" << std::endl;
+  return success;
+}
+
+template <int dim>
+bool testDim(unsigned int maxOrder)
+{
+  bool success = true;
+  for (unsigned int order = 0; order <= maxOrder; ++order)
+    success &= testOrthonormality<dim>(order);
+  for (unsigned int order = 0; order <= 4; ++order)
+    success &= testSpan<dim>(order);
+  for (unsigned int order = 0; order <= 5; ++order)
+  {
+    Dune::DubinerLocalFiniteElement<dim,double,double> fe(Dune::GeometryTypes::simplex(dim), order);
+    TEST_FE(fe);
+  }
+  return success;
+}
+
+int main ( int argc, char **argv )
+{
+  bool success = true;
+
+  success &= testDim<1>(20);
+  success &= testDim<2>(16);
+  success &= testDim<3>(10);
+
+  // high orders are fine in double precision
+  success &= testOrthonormality<2>(30);
+
+  // the basis is only available on simplices
+  try
+  {
+    Dune::DubinerLocalFiniteElement<2,double,double> fe(Dune::GeometryTypes::quadrilateral, 2);
+    std::cout << "DubinerLocalFiniteElement created on a quadrilateral" << std::endl;
+    success = false;
+  }
+  catch (const Dune::NotImplemented&)
+  {}
+
+  return success ? 0 : 1;
+}
@@ -0,0 +1,167 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+
+#include <dune/geometry/quadraturerules.hh>
+#include <dune/geometry/type.hh>
+
+#include <dune/localfunctions/common/combinedevaluation.hh>
+#include <dune/localfunctions/lagrange.hh>
+#include <dune/localfunctions/lagrange/equidistantpoints.hh>
+#include <dune/localfunctions/lagrange/pk.hh>
+#include <dune/localfunctions/lagrange/qk/qklocalbasis.hh>
+#include <dune/localfunctions/lagrange/qkgll/qkglllocalbasis.hh>
+#include <dune/localfunctions/orthonormal.hh>
+
+/**
+ * \file
+ * \brief Compares evaluateCombination() with the contraction of the values
+ *        and Jacobians of all shape functions.
+ */
+
+double TOL = 1e-10;
+
+// A coefficient in [-1,1]
+double coefficient (std::size_t i)
+{
+  return std::sin(1.7*i + 0.3);
+}
+
+template<class Basis>
+bool testBasis (const Basis& basis, const Dune::GeometryType& gt, const std::string& name)
+{
+  typedef typename Basis::Traits Traits;
+  const int dim = Traits::dimDomain;
+  const std::size_t size = basis.size();
+  bool success = true;
+
+  std::vector<double> coefficients(size);
+  for (std::size_t i=0; i<size; i++)
+    coefficients[i] = coefficient(i);
+
+  std::vector<typename Traits::RangeType> values;
+  std::vector<typename Traits::JacobianType> jacobians;
+  for (const auto& qp : Dune::QuadratureRules<double,dim>::rule(gt, 5))
+  {
+    const auto& x = qp.position();
+    basis.evaluateFunction(x, values);
+    basis.evaluateJacobian(x, jacobians);
+    typename Traits::RangeType expectedValue(0);
+    typename Traits::JacobianType expectedJacobian(0);
+    for (std::size_t i=0; i<size; i++)
+    {
+      expectedValue.axpy(coefficients[i], values[i]);
+      expectedJacobian.axpy(coefficients[i], jacobians[i]);
+    }
+
+    typename Traits::RangeType value, valueOnly;
+    typename Traits::JacobianType jacobian;
+    Dune::evaluateCombination(basis, x, coefficients, valueOnly);
+    Dune::evaluateCombination(basis, x, coefficients, value, jacobian);
+
+    typename Traits::JacobianType jacobianError = jacobian;
+    jacobianError -= expectedJacobian;
+    if ((value - expectedValue).infinity_norm() > TOL
+        or (valueOnly - expectedValue).infinity_norm() > TOL
+        or jacobianError.infinity_norm() > TOL)
+    {
+      std::cout << name << ": combination at " << x << " yields " << value
+                << ", " << jacobian << " instead of " << expectedValue
+                << ", " << expectedJacobian << std::endl;
+      success = false;
+    }
+  }
+  return success;
+}
+
+template<int k, int d>
+bool testQk ()
+{
+  const std::string suffix = std::to_string(k) + " in " + std::to_string(d) + "d";
+  bool success = testBasis(Dune::QkLocalBasis<double,double,k,d>(), Dune::GeometryTypes::cube(d), "Q" + suffix);
+  success = testBasis(Dune::QkGLLLocalBasis<double,double,k,d>(), Dune::GeometryTypes::cube(d), "GLL Q" + suffix) and success;
+  return success;
+}
+
+template<int dim>
+bool testGeneric (const Dune::GeometryType& gt, unsigned int order)
+{
+  const std::string suffix = " of order " + std::to_string(order) + " on " + std::to_string(gt.id()) + " in " + std::to_string(dim) + "d";
+  bool success = true;
+
+  Dune::LagrangeLocalFiniteElement<Dune::EquidistantPointSet,dim,double,double> lagrange(gt, order);
+  const auto& lagrangeBasis = lagrange.localBasis();
+  success = testBasis(lagrangeBasis, gt, "Lagrange" + suffix) and success;
+
+  // with the coefficients prepared once
+  std::vector<double> coefficients(lagrangeBasis.size());
+  for (std::size_t i=0; i<coefficients.size(); i++)
+    coefficients[i] = coefficient(i);
+  const auto combination = lagrangeBasis.linearCombination(coefficients);
+  for (const auto& qp : Dune::QuadratureRules<double,dim>::rule(gt, 3))
+  {
+    typename std::decay_t<decltype(lagrangeBasis)>::Traits::RangeType value, expected;
+    combination.evaluate(qp.position(), value);
+    lagrangeBasis.evaluateCombination(qp.position(), coefficients, expected);
+    if ((value - expected).infinity_norm() > TOL)
+    {
+      std::cout << "Lagrange" << suffix << ": prepared combination yields "
+                << value << " instead of " << expected << std::endl;
+      success = false;
+    }
+  }
+
+  if (gt.isSimplex())
+  {
+    Dune::OrthonormalLocalFiniteElement<dim,double,double> orthonormal(gt, order);
+    success = testBasis(orthonormal.localBasis(), gt, "Orthonormal" + suffix) and success;
+  }
+  return success;
+}
+
+int main(int argc, char** argv)
+{
+  try
+  {
+    bool success = true;
+
+    success = testQk<0,2>() and success;
+    success = testQk<1,1>() and success;
+    success = testQk<4,1>() and success;
+    success = testQk<2,2>() and success;
+    success = testQk<3,2>() and success;
+    success = testQk<1,3>() and success;
+    success = testQk<3,3>() and success;
+
+    // the fallback by evaluateFunction() and evaluateJacobian()
+    success = testBasis(Dune::PkLocalFiniteElement<double,double,2,3>().localBasis(),
+                        Dune::GeometryTypes::triangle, "P3 in 2d") and success;
+    success = testBasis(Dune::PkLocalFiniteElement<double,double,3,2>().localBasis(),
+                        Dune::GeometryTypes::tetrahedron, "P2 in 3d") and success;
+
+    for (unsigned int order = 1; order <= 3; ++order)
+    {
+      success = testGeneric<2>(Dune::GeometryTypes::triangle, order) and success;
+      success = testGeneric<2>(Dune::GeometryTypes::quadrilateral, order) and success;
+      success = testGeneric<3>(Dune::GeometryTypes::tetrahedron, order) and success;
+      success = testGeneric<3>(Dune::GeometryTypes::prism, order) and success;
+    }
+
+    return success ? 0 : 1;
+  }
+  catch (const Dune::Exception& e)
+  {
+    std::cerr << e << std::endl;
+    throw;
+  }
+}
@@ -0,0 +1,148 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#include <config.h>
+
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#include <dune/localfunctions/utility/executor.hh>
+#include <dune/localfunctions/utility/lfematrix.hh>
+#include <dune/localfunctions/lagrange/equidistantpoints.hh>
+#include <dune/localfunctions/lagrange/lagrangebasis.hh>
+
+/**
+ * \file
+ * \brief Checks the LocalFiniteElementExecutor and that the parallel
+ *        construction of generic finite elements yields the same result as
+ *        the serial one.
+ */
+
+typedef Dune::LocalFiniteElementExecutor LFEExecutor;
+
+// every index of a range is visited exactly once
+bool testPartition()
+{
+  bool success = true;
+  for (std::size_t size : { 0, 1, 7, 1000 })
+  {
+    std::vector< std::atomic< int > > visits(size);
+    for (auto& v : visits)
+      v = 0;
+    LFEExecutor::parallelFor(0, size, LFEExecutor::minTaskCost, [&visits] (std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; ++i)
+          ++visits[i];
+      });
+    for (const auto& v : visits)
+      success &= (v == 1);
+  }
+  if (!success)
+    std::cout << "parallelFor does not visit every index once" << std::endl;
+  return success;
+}
+
+// exceptions of the tasks are passed on to the caller
+bool testException()
+{
+  try
+  {
+    LFEExecutor::parallelFor(0, 100, LFEExecutor::minTaskCost, [] (std::size_t first, std::size_t last) {
+        if (first <= 50 && 50 < last)
+          throw std::runtime_error("task failed");
+      });
+  }
+  catch (const std::runtime_error&)
+  {
+    return true;
+  }
+  std::cout << "Exception thrown by a task was lost" << std::endl;
+  return false;
+}
+
+template <class Field>
+Dune::LFEMatrix<Field> inverse(unsigned int n)
+{
+  Dune::LFEMatrix<Field> matrix;
+  matrix.resize(n, n);
+  for (unsigned int i = 0; i < n; ++i)
+    for (unsigned int j = 0; j < n; ++j)
+      matrix(i, j) = std::cos(1.3*i + 0.7*j) + (j == (11*i) % n ? n : 0);
+  if (!matrix.invert())
+    std::cout << "Matrix of size " << n << " singular" << std::endl;
+  return matrix;
+}
+
+// Lagrange basis of order 9 on the tetrahedron evaluated at some point
+std::vector< Dune::FieldVector< double, 1 > > lagrange()
+{
+  typedef Dune::Impl::Pyramid< Dune::Impl::Pyramid< Dune::Impl::Pyramid< Dune::Impl::Point > > > Topology;
+  typedef Dune::LagrangeBasisFactory<Dune::EquidistantPointSet,3,double,double> BasisFactory;
+  const typename BasisFactory::Object& basis = *BasisFactory::template create<Topology>(9);
+  std::vector< Dune::FieldVector< double, 1 > > values(basis.size());
+  basis.evaluate(Dune::FieldVector< double, 3 >{ 0.2, 0.3, 0.1 }, values);
+  BasisFactory::release(&basis);
+  return values;
+}
+
+// the parallel parts are independent of each other, so the result does not
+// depend on the number of threads
+bool testConstruction()
+{
+  LFEExecutor::setNumThreads(1);
+  const Dune::LFEMatrix<double> serial = inverse<double>(300);
+  const auto serialValues = lagrange();
+
+  bool success = true;
+  for (unsigned int numThreads : { 2u, 3u, 0u })
+  {
+    LFEExecutor::setNumThreads(numThreads);
+    const Dune::LFEMatrix<double> parallel = inverse<double>(300);
+    for (unsigned int i = 0; i < serial.rows(); ++i)
+      for (unsigned int j = 0; j < serial.cols(); ++j)
+        success &= (serial(i, j) == parallel(i, j));
+    success &= (lagrange() == serialValues);
+  }
+  if (!success)
+    std::cout << "Parallel construction differs from the serial one" << std::endl;
+  return success;
+}
+
+// a custom executor is used for all parallel parts
+bool testCustomExecutor()
+{
+  std::size_t calls = 0;
+  LFEExecutor::setExecutor([&calls] (std::size_t n, const std::function< void (std::size_t) >& task) {
+      ++calls;
+      for (std::size_t i = n; i-- > 0; )
+        task(i);
+    }, 4);
+  const Dune::LFEMatrix<double> matrix = inverse<double>(200);
+  LFEExecutor::setExecutor(LFEExecutor::Executor(), 1);
+
+  LFEExecutor::setNumThreads(1);
+  const Dune::LFEMatrix<double> serial = inverse<double>(200);
+
+  bool success = (calls > 0) && (LFEExecutor::concurrency() == 1);
+  for (unsigned int i = 0; i < serial.rows(); ++i)
+    for (unsigned int j = 0; j < serial.cols(); ++j)
+      success &= (serial(i, j) == matrix(i, j));
+  if (!success)
+    std::cout << "Custom executor not used correctly" << std::endl;
+  return success;
+}
+
+int main ( int argc, char **argv )
+{
+  bool success = true;
+
+  LFEExecutor::setNumThreads(4);
+  success &= testPartition();
+  success &= testException();
+  success &= testConstruction();
+  success &= testCustomExecutor();
+
+  return success ? 0 : 1;
+}
@@ -0,0 +1,147 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#include <config.h>
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include <dune/geometry/type.hh>
+#include <dune/geometry/quadraturerules.hh>
+
+#include <dune/localfunctions/utility/field.hh>
+#include <dune/localfunctions/lagrange/equidistantpoints.hh>
+#include <dune/localfunctions/lagrange/lagrangebasis.hh>
+#include <dune/localfunctions/orthonormal/orthonormalbasis.hh>
+
+/**
+ * \file
+ * \brief Checks the arithmetic of DoubleDoubleField and Float128Field and
+ *        their use as ComputeField of the generic finite elements.
+ */
+
+// |x| in double precision
+template <class Field>
+double error(const Field& x)
+{
+  return std::abs(Dune::field_cast<double>(x));
+}
+
+template <class Field>
+bool testArithmetic(const char* name, double tolerance)
+{
+  bool success = true;
+  const Field two(2), three(3);
+
+  const Field third = Dune::Unity<Field>() / three;
+  const Field root = sqrt(two);
+  const Field eps = Field(1.0) / Field(1u << 30) / Field(1u << 30);
+  if (error(third*three - Field(1)) > tolerance
+      || error(root*root - two) > tolerance
+      || error((Field(1) + eps) - Field(1) - eps) > tolerance*tolerance
+      || !(Field(1) + eps > Field(1))
+      || error(abs(-third) - third) > 0
+      || !(Field(0) == Dune::Zero<Field>()) || !(third > Dune::Zero<Field>()))
+  {
+    std::cout << "Arithmetic of " << name << " inaccurate" << std::endl;
+    success = false;
+  }
+  // 1/3 is not exactly representable, it must not be rounded to double
+  if (error(third - Field(1.0/3.0)) < 1e-20)
+  {
+    std::cout << name << " has the accuracy of double only" << std::endl;
+    success = false;
+  }
+  return success;
+}
+
+template <class Topology, class ComputeField>
+bool testOrthonormal(unsigned int order)
+{
+  typedef Dune::OrthonormalBasisFactory<Topology::dimension,double,ComputeField> BasisFactory;
+  const typename BasisFactory::Object& basis = *BasisFactory::template create<Topology>(order);
+  const unsigned int size = basis.size();
+
+  std::vector< Dune::FieldVector< double, 1 > > y(size);
+  std::vector< double > m(size*size, 0.0);
+  for (const auto& qp : Dune::QuadratureRules<double,Topology::dimension>::rule(Dune::GeometryType(Topology::id, Topology::dimension), 2*order+1))
+  {
+    basis.evaluate(qp.position(), y);
+    for (unsigned int i = 0; i < size; ++i)
+      for (unsigned int j = 0; j < size; ++j)
+        m[i*size+j] += qp.weight() * y[i] * y[j];
+  }
+
+  bool success = true;
+  for (unsigned int i = 0; i < size; ++i)
+    for (unsigned int j = 0; j < size; ++j)
+      if (std::abs(m[i*size+j] - double(i == j)) > 1e-11)
+        success = false;
+  if (!success)
+    std::cout << "Orthonormal basis for " << Topology::name() << " of order " << order << " not orthonormal" << std::endl;
+  BasisFactory::release(&basis);
+  return success;
+}
+
+template <class Topology, class ComputeField>
+bool testLagrange(unsigned int order)
+{
+  typedef Dune::LagrangeBasisFactory<Dune::EquidistantPointSet,Topology::dimension,double,ComputeField> BasisFactory;
+  typedef Dune::LagrangeCoefficientsFactory<Dune::EquidistantPointSet,Topology::dimension,double> PointsFactory;
+  const typename BasisFactory::Object& basis = *BasisFactory::template create<Topology>(order);
+  const typename PointsFactory::Object& points = *PointsFactory::template create<Topology>(order);
+
+  bool success = true;
+  std::vector< Dune::FieldVector< double, 1 > > y(basis.size());
+  for (unsigned int index = 0; index < points.size(); ++index)
+  {
+    basis.evaluate(points[index].point(), y);
+    for (unsigned int i = 0; i < y.size(); ++i)
+      if (std::abs(y[i] - double(i == index)) > 1e-10)
+        success = false;
+  }
+  if (!success)
+    std::cout << "Lagrange basis for " << Topology::name() << " of order " << order << " not nodal" << std::endl;
+  PointsFactory::release(&points);
+  BasisFactory::release(&basis);
+  return success;
+}
+
+template <class ComputeField>
+bool testGeneric()
+{
+  using namespace Dune::Impl;
+  bool success = true;
+  success &= testOrthonormal<Pyramid<Pyramid<Point> >, ComputeField>(8);
+  success &= testOrthonormal<Pyramid<Pyramid<Pyramid<Point> > >, ComputeField>(6);
+  success &= testLagrange<Pyramid<Pyramid<Point> >, ComputeField>(8);
+  success &= testLagrange<Prism<Pyramid<Pyramid<Point> > >, ComputeField>(4);
+  return success;
+}
+
+int main ( int argc, char **argv )
+{
+  bool success = true;
+
+  success &= testArithmetic<Dune::DoubleDoubleField>("DoubleDoubleField", 1e-30);
+  success &= testGeneric<Dune::DoubleDoubleField>();
+
+#if DUNE_LOCALFUNCTIONS_HAVE_FLOAT128
+  success &= testArithmetic<Dune::Float128Field>("Float128Field", 1e-32);
+  success &= testGeneric<Dune::Float128Field>();
+
+  // conversion between the two fields keeps about 106 bits
+  const Dune::Float128Field third = Dune::Float128Field(1) / Dune::Float128Field(3);
+  Dune::DoubleDoubleField dd;
+  Dune::Float128Field back;
+  Dune::field_cast(third, dd);
+  Dune::field_cast(dd, back);
+  if (error(back - third) > 1e-31)
+  {
+    std::cout << "Conversion between Float128Field and DoubleDoubleField inaccurate" << std::endl;
+    success = false;
+  }
+#endif
+
+  return success ? 0 : 1;
+}
@@ -0,0 +1,125 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#include <config.h>
+
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <vector>
+
+#include <dune/common/fvector.hh>
+
+#include <dune/geometry/type.hh>
+#include <dune/geometry/quadraturerules.hh>
+
+#include <dune/localfunctions/orthonormal/orthonormalbasis.hh>
+#include <dune/localfunctions/utility/l2interpolation.hh>
+
+/**
+ * \file
+ * \brief Tests the LocalL2Interpolation for single functions and for
+ *        several functions given by their values at the quadrature points.
+ */
+
+const double TOL = 1e-10;
+
+// A polynomial of degree 3, scaled by a factor
+template <int dim>
+struct Polynomial
+{
+  typedef Dune::FieldVector<double,dim> DomainType;
+  typedef Dune::FieldVector<double,1> RangeType;
+
+  explicit Polynomial (double scale) : scale_(scale) {}
+
+  void evaluate (const DomainType& x, RangeType& y) const
+  {
+    y = 1.0 + x[0] - 2.0*x[0]*x[dim-1] + x[dim-1]*x[dim-1]*x[dim-1];
+    y *= scale_;
+  }
+
+  double scale_;
+};
+
+template <class Topology, bool onb>
+bool test(unsigned int order)
+{
+  const int dim = Topology::dimension;
+  typedef Dune::OrthonormalBasisFactory<dim,double,double> BasisFactory;
+  typedef Dune::LocalL2InterpolationFactory<BasisFactory,onb> InterpolationFactory;
+  typedef typename InterpolationFactory::Object Interpolation;
+
+  const Interpolation& interpolation = *InterpolationFactory::template create<Topology>(order);
+  const auto& basis = interpolation.basis();
+  const auto& quadrature = interpolation.quadrature();
+  const std::size_t size = basis.size();
+
+  bool success = true;
+
+  // The projection reproduces polynomials of the order of the basis
+  std::vector<double> coefficients;
+  interpolation.interpolate(Polynomial<dim>(1.0), coefficients);
+
+  Dune::GeometryType gt(Topology::id, dim);
+  std::vector<Dune::FieldVector<double,1> > values;
+  for (const auto& qp : Dune::QuadratureRules<double,dim>::rule(gt, 4))
+  {
+    basis.evaluateFunction(qp.position(), values);
+    double u = 0;
+    for (std::size_t i = 0; i < size; ++i)
+      u += coefficients[i]*values[i][0];
+    Dune::FieldVector<double,1> f;
+    Polynomial<dim>(1.0).evaluate(qp.position(), f);
+    if (std::abs(u - f[0]) > TOL)
+    {
+      std::cout << "Interpolation on " << Topology::name() << " (onb=" << onb << ")"
+                << " does not reproduce the polynomial at " << qp.position()
+                << ": " << u << " vs. " << f[0] << std::endl;
+      success = false;
+    }
+  }
+
+  // Interpolating several functions at once yields the same coefficients
+  const std::size_t numFunctions = 5;
+  std::vector<Dune::FieldVector<double,1> > samples(numFunctions*quadrature.size());
+  for (std::size_t f = 0; f < numFunctions; ++f)
+    for (std::size_t q = 0; q < quadrature.size(); ++q)
+      Polynomial<dim>(f+1.0).evaluate(quadrature[q].position(), samples[f*quadrature.size()+q]);
+
+  std::vector<double> allCoefficients;
+  interpolation.interpolate(samples, allCoefficients);
+  if (allCoefficients.size() != numFunctions*size)
+  {
+    std::cout << "Interpolation of several functions returns wrong number of coefficients" << std::endl;
+    success = false;
+  }
+  else
+    for (std::size_t f = 0; f < numFunctions; ++f)
+    {
+      interpolation.interpolate(Polynomial<dim>(f+1.0), coefficients);
+      for (std::size_t i = 0; i < size; ++i)
+        if (std::abs(coefficients[i] - allCoefficients[f*size+i]) > TOL)
+        {
+          std::cout << "Coefficient " << i << " of function " << f << " on " << Topology::name()
+                    << " (onb=" << onb << ") differs: " << coefficients[i]
+                    << " vs. " << allCoefficients[f*size+i] << std::endl;
+          success = false;
+        }
+    }
+
+  InterpolationFactory::release(&interpolation);
+  return success;
+}
+
+int main ( int argc, char **argv )
+{
+  using namespace Dune::Impl;
+
+  bool success = true;
+  success &= test<Pyramid<Pyramid<Point> >, true>(3);
+  success &= test<Pyramid<Pyramid<Point> >, false>(3);
+  success &= test<Pyramid<Pyramid<Pyramid<Point> > >, true>(3);
+  success &= test<Pyramid<Pyramid<Pyramid<Point> > >, false>(3);
+
+  return success ? 0 : 1;
+}
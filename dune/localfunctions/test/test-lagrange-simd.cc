@@ -0,0 +1,186 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <type_traits>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+#include <dune/common/typetraits.hh>
+
+#include <dune/geometry/quadraturerules.hh>
+#include <dune/geometry/type.hh>
+
+#include <dune/localfunctions/lagrange/p1/p1localbasis.hh>
+#include <dune/localfunctions/lagrange/pk1d/pk1dlocalbasis.hh>
+#include <dune/localfunctions/lagrange/pk2d/pk2dlocalbasis.hh>
+#include <dune/localfunctions/lagrange/pk3d/pk3dlocalbasis.hh>
+#include <dune/localfunctions/lagrange/q1/q1localbasis.hh>
+#include <dune/localfunctions/lagrange/qk/qklocalbasis.hh>
+
+/** \file
+ * \brief Evaluate Lagrange bases with a vector type for the coordinates,
+ *        such that each lane holds a different evaluation point
+ *
+ * Lanes is a minimal portable stand-in for a SIMD vector type.  It only
+ * provides element-wise arithmetic, no comparisons or branches, which is
+ * what the bases have to get along with.
+ */
+
+template<class T, std::size_t W>
+class Lanes
+{
+public:
+  static const std::size_t size = W;
+
+  Lanes () : v_() {}
+
+  template<class S, class = std::enable_if_t<std::is_arithmetic<S>::value> >
+  Lanes (S s) { v_.fill(T(s)); }
+
+  T& operator[] (std::size_t l) { return v_[l]; }
+  const T& operator[] (std::size_t l) const { return v_[l]; }
+
+  Lanes& operator+= (const Lanes& o) { for (std::size_t l=0; l<W; l++) v_[l] += o.v_[l]; return *this; }
+  Lanes& operator-= (const Lanes& o) { for (std::size_t l=0; l<W; l++) v_[l] -= o.v_[l]; return *this; }
+  Lanes& operator*= (const Lanes& o) { for (std::size_t l=0; l<W; l++) v_[l] *= o.v_[l]; return *this; }
+  Lanes& operator/= (const Lanes& o) { for (std::size_t l=0; l<W; l++) v_[l] /= o.v_[l]; return *this; }
+
+  Lanes operator- () const { Lanes r; for (std::size_t l=0; l<W; l++) r.v_[l] = -v_[l]; return r; }
+
+  friend Lanes operator+ (Lanes a, const Lanes& b) { return a += b; }
+  friend Lanes operator- (Lanes a, const Lanes& b) { return a -= b; }
+  friend Lanes operator* (Lanes a, const Lanes& b) { return a *= b; }
+  friend Lanes operator/ (Lanes a, const Lanes& b) { return a /= b; }
+
+private:
+  std::array<T,W> v_;
+};
+
+namespace Dune
+{
+  template<class T, std::size_t W>
+  struct IsNumber<Lanes<T,W> > : public std::true_type {};
+}
+
+typedef Lanes<double,4> Lane;
+
+double TOL = 1e-10;
+
+// Evaluate LaneBasis at W points at once and compare the results lane by lane
+// with ScalarBasis evaluated at each point separately
+template<class ScalarBasis, class LaneBasis>
+bool testLanes (const ScalarBasis& scalarBasis, const LaneBasis& laneBasis,
+                Dune::GeometryType type, const std::string& name, unsigned int diffOrder = 1)
+{
+  const int dim = ScalarBasis::Traits::dimDomain;
+  bool success = true;
+
+  const auto& rule = Dune::QuadratureRules<double,dim>::rule(type, 4);
+
+  for (std::size_t first=0; first<rule.size(); first+=Lane::size)
+  {
+    typename LaneBasis::Traits::DomainType x;
+    for (std::size_t l=0; l<Lane::size; l++)
+      for (int j=0; j<dim; j++)
+        x[j][l] = rule[std::min(first+l, rule.size()-1)].position()[j];
+
+    std::vector<typename LaneBasis::Traits::RangeType> laneValues;
+    std::vector<typename LaneBasis::Traits::JacobianType> laneJacobians;
+    laneBasis.evaluateFunction(x, laneValues);
+    laneBasis.evaluateJacobian(x, laneJacobians);
+
+    std::vector<std::vector<typename LaneBasis::Traits::RangeType> > lanePartials;
+    std::vector<std::array<unsigned int,dim> > orders;
+    for (int j=0; j<dim; j++)
+      for (int m=j; m<dim and diffOrder>1; m++)
+      {
+        std::array<unsigned int,dim> order;
+        order.fill(0);
+        order[j]++;
+        order[m]++;
+        orders.push_back(order);
+        lanePartials.emplace_back();
+        laneBasis.partial(order, x, lanePartials.back());
+      }
+
+    for (std::size_t l=0; l<Lane::size; l++)
+    {
+      const auto& position = rule[std::min(first+l, rule.size()-1)].position();
+      std::vector<typename ScalarBasis::Traits::RangeType> values;
+      std::vector<typename ScalarBasis::Traits::JacobianType> jacobians;
+      scalarBasis.evaluateFunction(position, values);
+      scalarBasis.evaluateJacobian(position, jacobians);
+
+      for (std::size_t i=0; i<scalarBasis.size(); i++)
+      {
+        if (std::abs(values[i][0] - laneValues[i][0][l]) > TOL)
+        {
+          std::cout << name << ": value of shape function " << i << " in lane " << l
+                    << " is " << laneValues[i][0][l] << " instead of " << values[i][0] << std::endl;
+          success = false;
+        }
+        for (int j=0; j<dim; j++)
+          if (std::abs(jacobians[i][0][j] - laneJacobians[i][0][j][l]) > TOL)
+          {
+            std::cout << name << ": derivative " << j << " of shape function " << i << " in lane " << l
+                      << " is " << laneJacobians[i][0][j][l] << " instead of " << jacobians[i][0][j] << std::endl;
+            success = false;
+          }
+      }
+
+      for (std::size_t o=0; o<orders.size(); o++)
+      {
+        scalarBasis.partial(orders[o], position, values);
+        for (std::size_t i=0; i<scalarBasis.size(); i++)
+          if (std::abs(values[i][0] - lanePartials[o][i][0][l]) > TOL)
+          {
+            std::cout << name << ": second derivative " << o << " of shape function " << i << " in lane " << l
+                      << " is " << lanePartials[o][i][0][l] << " instead of " << values[i][0] << std::endl;
+            success = false;
+          }
+      }
+    }
+  }
+
+  return success;
+}
+
+int main ()
+try
+{
+  using namespace Dune;
+  bool success = true;
+
+  success = testLanes(P1LocalBasis<double,double,2>(), P1LocalBasis<Lane,Lane,2>(),
+                      GeometryTypes::triangle, "P1 2d", 2) and success;
+  success = testLanes(P1LocalBasis<double,double,3>(), P1LocalBasis<Lane,Lane,3>(),
+                      GeometryTypes::tetrahedron, "P1 3d") and success;
+  success = testLanes(Q1LocalBasis<double,double,2>(), Q1LocalBasis<Lane,Lane,2>(),
+                      GeometryTypes::quadrilateral, "Q1 2d") and success;
+  success = testLanes(Q1LocalBasis<double,double,3>(), Q1LocalBasis<Lane,Lane,3>(),
+                      GeometryTypes::hexahedron, "Q1 3d") and success;
+  success = testLanes(Pk1DLocalBasis<double,double,3>(), Pk1DLocalBasis<Lane,Lane,3>(),
+                      GeometryTypes::line, "P3 1d") and success;
+  success = testLanes(Pk2DLocalBasis<double,double,3>(), Pk2DLocalBasis<Lane,Lane,3>(),
+                      GeometryTypes::triangle, "P3 2d", 2) and success;
+  success = testLanes(Pk3DLocalBasis<double,double,3>(), Pk3DLocalBasis<Lane,Lane,3>(),
+                      GeometryTypes::tetrahedron, "P3 3d") and success;
+  success = testLanes(QkLocalBasis<double,double,3,2>(), QkLocalBasis<Lane,Lane,3,2>(),
+                      GeometryTypes::quadrilateral, "Q3 2d", 2) and success;
+  success = testLanes(QkLocalBasis<double,double,2,3>(), QkLocalBasis<Lane,Lane,2,3>(),
+                      GeometryTypes::hexahedron, "Q2 3d", 2) and success;
+
+  return success ? 0 : 1;
+}
+catch (const Dune::Exception& e)
+{
+  std::cerr << e << std::endl;
+  throw;
+}
@@ -0,0 +1,157 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#include <config.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#if HAVE_GMP
+#include <dune/common/gmpfield.hh>
+#endif
+
+#include <dune/localfunctions/utility/field.hh>
+#include <dune/localfunctions/utility/lfematrix.hh>
+
+/**
+ * \file
+ * \brief Checks the inversion of an LFEMatrix by LU decomposition, with and
+ *        without mixed precision iterative refinement.
+ */
+
+// a matrix dominated by a permuted diagonal, so that pivoting is needed
+template <class Field>
+void testMatrix(Dune::LFEMatrix<Field>& matrix, unsigned int n)
+{
+  matrix.resize(n, n);
+  for (unsigned int i = 0; i < n; ++i)
+    for (unsigned int j = 0; j < n; ++j)
+    {
+      matrix(i, j) = Field(std::cos(1.3*i + 0.7*j));
+      if (j == (11*i) % n)
+        matrix(i, j) += Field(int(n));
+    }
+}
+
+// max_ij |(AX - I)_ij|
+template <class Field>
+double residual(const Dune::LFEMatrix<Field>& a, const Dune::LFEMatrix<Field>& x)
+{
+  double error = 0;
+  for (unsigned int i = 0; i < a.rows(); ++i)
+    for (unsigned int j = 0; j < x.cols(); ++j)
+    {
+      Field sum = (i == j ? Field(-1) : Field(0));
+      for (unsigned int k = 0; k < a.cols(); ++k)
+        sum += a(i, k) * x(k, j);
+      error = std::max(error, std::abs(Dune::field_cast<double>(sum)));
+    }
+  return error;
+}
+
+template <class Field, class LowField>
+bool test(unsigned int n, double tolerance)
+{
+  bool success = true;
+
+  Dune::LFEMatrix<Field> a;
+  testMatrix(a, n);
+
+  Dune::LFEMatrix<Field> inverse = a;
+  if (!inverse.invert() || residual(a, inverse) > tolerance)
+  {
+    std::cout << "invert() failed for size " << n << std::endl;
+    success = false;
+  }
+
+  Dune::LFEMatrix<Field> refined = a;
+  if (!refined.template invertRefined<LowField>() || residual(a, refined) > tolerance)
+  {
+    std::cout << "invertRefined() failed for size " << n << std::endl;
+    success = false;
+  }
+
+  // solve for a single right hand side
+  Dune::LFELUDecomposition<Field> lu;
+  Dune::LFEMatrix<Field> b;
+  b.resize(n, 1);
+  for (unsigned int i = 0; i < n; ++i)
+    b(i, 0) = Field(int(i));
+  Dune::LFEMatrix<Field> x = b;
+  if (!lu.factorize(a))
+  {
+    std::cout << "factorize() failed for size " << n << std::endl;
+    return false;
+  }
+  lu.solve(x);
+  for (unsigned int i = 0; i < n; ++i)
+  {
+    Field sum = -b(i, 0);
+    for (unsigned int k = 0; k < n; ++k)
+      sum += a(i, k) * x(k, 0);
+    if (std::abs(Dune::field_cast<double>(sum)) > tolerance*n)
+    {
+      std::cout << "solve() failed for size " << n << std::endl;
+      success = false;
+      break;
+    }
+  }
+  return success;
+}
+
+bool testSingular()
+{
+  Dune::LFEMatrix<double> a;
+  a.resize(40, 40);
+  for (unsigned int i = 0; i < a.rows(); ++i)
+    for (unsigned int j = 0; j < a.cols(); ++j)
+      a(i, j) = (j == 35 ? 0.0 : double(i+j+1));
+  Dune::LFEMatrix<double> b = a;
+  if (a.invert() || b.invertRefined<float>())
+  {
+    std::cout << "Singular matrix not detected" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+bool testResize()
+{
+  Dune::LFEMatrix<double> a;
+  a.resize(3, 4);
+  for (unsigned int i = 0; i < a.rows(); ++i)
+    for (unsigned int j = 0; j < a.cols(); ++j)
+      a(i, j) = 10*i + j;
+  a.resize(5, 2);
+  for (unsigned int i = 0; i < 3; ++i)
+    for (unsigned int j = 0; j < 2; ++j)
+      if (a(i, j) != 10*i + j || a.rowPtr(i)[j] != a(i, j))
+      {
+        std::cout << "resize() lost entries" << std::endl;
+        return false;
+      }
+  return true;
+}
+
+int main ( int argc, char **argv )
+{
+  bool success = true;
+
+  success &= testResize();
+  success &= testSingular();
+
+  // sizes below, at and above the block size of the LU decomposition
+  for (unsigned int n : { 1u, 7u, 32u, 75u })
+  {
+    success &= test<double, float>(n, 1e-13);
+    success &= test<long double, double>(n, 1e-16);
+  }
+  success &= test<double, double>(150, 1e-13);
+
+#if HAVE_GMP
+  for (unsigned int n : { 7u, 40u })
+    success &= test<Dune::GMPField<256>, double>(n, 1e-70);
+#endif
+
+  return success ? 0 : 1;
+}
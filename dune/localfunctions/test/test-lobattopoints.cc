@@ -0,0 +1,244 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#include <config.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include <dune/geometry/type.hh>
+#include <dune/geometry/quadraturerules.hh>
+#include <dune/geometry/referenceelements.hh>
+
+#include <dune/localfunctions/lagrange.hh>
+#include <dune/localfunctions/lagrange/equidistantpoints.hh>
+#include <dune/localfunctions/lagrange/lobattopoints.hh>
+
+#include "test-localfe.hh"
+
+/**
+ * \file
+ * \brief Checks the LobattoPointSet: the points lie on the same faces as
+ *        the equidistant ones, the points on a face coincide with the
+ *        points of the face, and the Lagrange basis can be built in
+ *        double precision.
+ */
+
+typedef std::array< double, 4 > Facet;
+
+// the facets f(x) = f[0] + f[1]*x[0] + f[2]*x[1] + f[3]*x[2] >= 0 of the
+// reference elements
+std::vector< Facet > facets ( const Dune::GeometryType& gt )
+{
+  if (gt.dim() == 1)
+    return { { 0, 1, 0, 0 }, { 1, -1, 0, 0 } };
+  if (gt.isTriangle())
+    return { { 0, 1, 0, 0 }, { 0, 0, 1, 0 }, { 1, -1, -1, 0 } };
+  if (gt.isQuadrilateral())
+    return { { 0, 1, 0, 0 }, { 1, -1, 0, 0 }, { 0, 0, 1, 0 }, { 1, 0, -1, 0 } };
+  if (gt.isTetrahedron())
+    return { { 0, 1, 0, 0 }, { 0, 0, 1, 0 }, { 0, 0, 0, 1 }, { 1, -1, -1, -1 } };
+  if (gt.isHexahedron())
+    return { { 0, 1, 0, 0 }, { 1, -1, 0, 0 }, { 0, 0, 1, 0 }, { 1, 0, -1, 0 }, { 0, 0, 0, 1 }, { 1, 0, 0, -1 } };
+  if (gt.isPrism())
+    return { { 0, 1, 0, 0 }, { 0, 0, 1, 0 }, { 1, -1, -1, 0 }, { 0, 0, 0, 1 }, { 1, 0, 0, -1 } };
+  // pyramid with apex (0, 0, 1)
+  return { { 0, 1, 0, 0 }, { 0, 0, 1, 0 }, { 0, 0, 0, 1 }, { 1, -1, 0, -1 }, { 1, 0, -1, -1 } };
+}
+
+template <class Vector>
+double facetValue ( const Facet& f, const Vector& x )
+{
+  double value = f[0];
+  for (unsigned int k = 0; k < x.size(); ++k)
+    value += f[k+1] * x[k];
+  return value;
+}
+
+// the points carry the local keys of the equidistant points and lie on the
+// same facets, in particular inside the reference element
+template <int dim>
+bool testFacets ( const Dune::GeometryType& gt, unsigned int order )
+{
+  Dune::EquidistantPointSet< double, dim > equidistant(order);
+  Dune::LobattoPointSet< double, dim > lobatto(order);
+  equidistant.build(gt);
+  lobatto.build(gt);
+
+  bool success = (equidistant.size() == lobatto.size());
+  for (unsigned int i = 0; success && i < lobatto.size(); ++i)
+  {
+    const Dune::LocalKey& key = lobatto.localKey(i);
+    const Dune::LocalKey& equidistantKey = equidistant.localKey(i);
+    success &= (key.subEntity() == equidistantKey.subEntity()) && (key.codim() == equidistantKey.codim())
+               && (key.index() == equidistantKey.index());
+    for (const Facet& f : facets(gt))
+    {
+      const double value = facetValue(f, lobatto[i].point());
+      const bool onFacet = (std::abs(facetValue(f, equidistant[i].point())) < 1e-12);
+      success &= (value > -1e-14) && (onFacet == (std::abs(value) < 1e-14));
+    }
+  }
+  if (!success)
+    std::cout << "Lobatto points of order " << order << " on " << gt << " do not match the equidistant ones" << std::endl;
+  return success;
+}
+
+// for order 0 the only point is the center of the reference element
+template <int dim>
+bool testOrderZero ( const Dune::GeometryType& gt )
+{
+  Dune::LobattoPointSet< double, dim > lobatto(0);
+  lobatto.build(gt);
+
+  const Dune::FieldVector< double, dim > center = Dune::ReferenceElements< double, dim >::general(gt).position(0, 0);
+  bool success = (lobatto.size() == 1);
+  if (success)
+  {
+    const Dune::LocalKey& key = lobatto.localKey(0);
+    success &= (key.subEntity() == 0) && (key.codim() == 0) && (key.index() == 0);
+    success &= ((lobatto[0].point() - center).infinity_norm() < 1e-14);
+  }
+  if (!success)
+    std::cout << "Lobatto point of order 0 on " << gt << " is not the center" << std::endl;
+  return success;
+}
+
+// the points of gt on the face x[fixed] = 0 coincide with the points of
+// faceType, the remaining coordinates being the coordinates of the face
+template <int dim>
+bool testFace ( const Dune::GeometryType& gt, unsigned int fixed, const Dune::GeometryType& faceType, unsigned int order )
+{
+  Dune::LobattoPointSet< double, dim > lobatto(order);
+  Dune::LobattoPointSet< double, dim-1 > face(order);
+  lobatto.build(gt);
+  face.build(faceType);
+
+  std::vector< Dune::FieldVector< double, dim-1 > > restricted;
+  for (const auto& p : lobatto)
+    if (std::abs(p.point()[fixed]) < 1e-14)
+    {
+      Dune::FieldVector< double, dim-1 > y;
+      for (unsigned int k = 0, l = 0; k < dim; ++k)
+        if (k != fixed)
+          y[l++] = p.point()[k];
+      restricted.push_back(y);
+    }
+
+  bool success = (restricted.size() == face.size());
+  for (const auto& p : face)
+  {
+    bool found = false;
+    for (const auto& y : restricted)
+      found |= ((y - p.point()).infinity_norm() < 1e-14);
+    success &= found;
+  }
+  if (!success)
+    std::cout << "Lobatto points of order " << order << " on " << gt << " differ from those of the face " << faceType << std::endl;
+  return success;
+}
+
+// the Lagrange basis built in double is nodal and its Lebesgue constant,
+// estimated at the points of a quadrature, is below maxLebesgue
+template <class Topology>
+bool testLagrange ( unsigned int order, double maxLebesgue )
+{
+  typedef Dune::LagrangeBasisFactory< Dune::LobattoPointSet, Topology::dimension, double, double > BasisFactory;
+  typedef Dune::LagrangeCoefficientsFactory< Dune::LobattoPointSet, Topology::dimension, double > PointsFactory;
+  const typename BasisFactory::Object& basis = *BasisFactory::template create<Topology>(order);
+  const typename PointsFactory::Object& points = *PointsFactory::template create<Topology>(order);
+
+  double error = 0;
+  std::vector< Dune::FieldVector< double, 1 > > y(basis.size());
+  for (unsigned int index = 0; index < points.size(); ++index)
+  {
+    basis.evaluate(points[index].point(), y);
+    for (unsigned int i = 0; i < y.size(); ++i)
+      error = std::max(error, std::abs(y[i] - double(i == index)));
+  }
+
+  double lebesgue = 0;
+  const Dune::GeometryType gt(Topology::id, Topology::dimension);
+  for (const auto& qp : Dune::QuadratureRules<double,Topology::dimension>::rule(gt, 2*order+6))
+  {
+    basis.evaluate(qp.position(), y);
+    double sum = 0;
+    for (const auto& v : y)
+      sum += std::abs(v[0]);
+    lebesgue = std::max(lebesgue, sum);
+  }
+  PointsFactory::release(&points);
+  BasisFactory::release(&basis);
+
+  if (error > 1e-8 || lebesgue > maxLebesgue)
+  {
+    std::cout << "Lagrange basis for Lobatto points on " << Topology::name() << " of order " << order
+              << ": nodal error " << error << ", Lebesgue constant " << lebesgue << std::endl;
+    return false;
+  }
+  return true;
+}
+
+int main ( int argc, char **argv )
+{
+  using namespace Dune::Impl;
+  using namespace Dune::GeometryTypes;
+  bool success = true;
+
+  // Gauss-Lobatto points of order 4
+  const std::vector< double > nodes = Dune::lobattoNodes< double >(4);
+  const std::vector< double > exact = { 0, (1 - std::sqrt(3./7.))/2, 0.5, (1 + std::sqrt(3./7.))/2, 1 };
+  for (unsigned int j = 0; j <= 4; ++j)
+    if (std::abs(nodes[j] - exact[j]) > 1e-15)
+    {
+      std::cout << "Gauss-Lobatto point " << j << " of order 4 is " << nodes[j] << " instead of " << exact[j] << std::endl;
+      success = false;
+    }
+
+  success &= testOrderZero<1>(line);
+  success &= testOrderZero<2>(triangle);
+  success &= testOrderZero<2>(quadrilateral);
+  for (const Dune::GeometryType& gt : { tetrahedron, hexahedron, prism, pyramid })
+    success &= testOrderZero<3>(gt);
+
+  for (unsigned int order = 1; order <= 9; ++order)
+  {
+    success &= testFacets<1>(line, order);
+    success &= testFacets<2>(triangle, order);
+    success &= testFacets<2>(quadrilateral, order);
+    success &= testFacets<3>(tetrahedron, order);
+    success &= testFacets<3>(hexahedron, order);
+    success &= testFacets<3>(prism, order);
+    success &= testFacets<3>(pyramid, order);
+
+    success &= testFace<2>(triangle, 1, line, order);
+    success &= testFace<3>(tetrahedron, 2, triangle, order);
+    success &= testFace<3>(tetrahedron, 0, triangle, order);
+    success &= testFace<3>(hexahedron, 2, quadrilateral, order);
+    success &= testFace<3>(prism, 2, triangle, order);
+    success &= testFace<3>(prism, 1, quadrilateral, order);
+    success &= testFace<3>(pyramid, 2, quadrilateral, order);
+    success &= testFace<3>(pyramid, 1, triangle, order);
+    success &= testFace<3>(pyramid, 0, triangle, order);
+  }
+
+  // the equidistant points have Lebesgue constants 71, 40, 11, 39 and 25
+  success &= testLagrange< Pyramid< Pyramid< Point > > >(10, 8);
+  success &= testLagrange< Pyramid< Pyramid< Pyramid< Point > > > >(8, 15);
+  success &= testLagrange< Prism< Prism< Prism< Point > > > >(4, 5);
+  success &= testLagrange< Prism< Pyramid< Pyramid< Point > > > >(6, 8);
+  success &= testLagrange< Pyramid< Prism< Prism< Point > > > >(6, 10);
+
+  for (unsigned int order = 1; order <= 3; ++order)
+  {
+    for (const Dune::GeometryType& gt : { tetrahedron, hexahedron, prism })
+    {
+      Dune::LagrangeLocalFiniteElement< Dune::LobattoPointSet, 3, double, double > fe(gt, order);
+      TEST_FE(fe);
+    }
+  }
+
+  return success ? 0 : 1;
+}
@@ -19,6 +19,7 @@
 #include <dune/geometry/quadraturerules.hh>
 #include <dune/geometry/referenceelements.hh>
 
+#include <dune/localfunctions/common/batchedevaluation.hh>
 #include <dune/localfunctions/common/virtualinterface.hh>
 #include <dune/localfunctions/common/virtualwrappers.hh>
 
@@ -194,6 +195,87 @@ bool testJacobian(const FE& fe, unsigned order = 2)
   return success;
 }
 
+// check whether the batched evaluation at several points agrees with the
+// evaluation point by point
+template<class FE>
+bool testBatchedEvaluation(const FE& fe, bool checkJacobian, unsigned order = 2)
+{
+  typedef typename FE::Traits::LocalBasisType LB;
+  typedef typename LB::Traits::DomainType DomainType;
+
+  bool success = true;
+
+  const Dune::QuadratureRule<double,LB::Traits::dimDomain> quad =
+    Dune::QuadratureRules<double,LB::Traits::dimDomain>::rule(fe.type(),order);
+
+  std::vector<DomainType> points;
+  for (size_t i=0; i<quad.size(); i++)
+    points.push_back(quad[i].position());
+
+  const std::size_t size = fe.localBasis().size();
+
+  std::vector<typename LB::Traits::RangeType> values, batchedValues;
+  Dune::evaluateFunctionAtPoints(fe.localBasis(), points, batchedValues);
+  if (batchedValues.size() != points.size()*size)
+  {
+    std::cout << "Bug in batched evaluateFunction() for finite element type "
+              << Dune::className(fe) << std::endl;
+    std::cout << "    Result has size " << batchedValues.size()
+              << " instead of " << points.size()*size << std::endl;
+    return false;
+  }
+
+  for (size_t p=0; p<points.size(); p++)
+  {
+    fe.localBasis().evaluateFunction(points[p], values);
+    for (size_t i=0; i<size; i++)
+      for (size_t k=0; k<values[i].size(); k++)
+        if (std::abs(values[i][k] - batchedValues[p*size+i][k]) > TOL)
+        {
+          std::cout << "Bug in batched evaluateFunction() for finite element type "
+                    << Dune::className(fe) << std::endl;
+          std::cout << "    Shape function " << i << " at position " << points[p]
+                    << ": batched value " << batchedValues[p*size+i]
+                    << " differs from " << values[i] << std::endl;
+          success = false;
+        }
+  }
+
+  if (not checkJacobian)
+    return success;
+
+  std::vector<typename LB::Traits::JacobianType> jacobians, batchedJacobians;
+  Dune::evaluateJacobianAtPoints(fe.localBasis(), points, batchedJacobians);
+  if (batchedJacobians.size() != points.size()*size)
+  {
+    std::cout << "Bug in batched evaluateJacobian() for finite element type "
+              << Dune::className(fe) << std::endl;
+    std::cout << "    Result has size " << batchedJacobians.size()
+              << " instead of " << points.size()*size << std::endl;
+    return false;
+  }
+
+  for (size_t p=0; p<points.size(); p++)
+  {
+    fe.localBasis().evaluateJacobian(points[p], jacobians);
+    for (size_t i=0; i<size; i++)
+      for (size_t k=0; k<jacobians[i].N(); k++)
+        for (size_t l=0; l<jacobians[i].M(); l++)
+          if (std::abs(jacobians[i][k][l] - batchedJacobians[p*size+i][k][l]) > TOL)
+          {
+            std::cout << "Bug in batched evaluateJacobian() for finite element type "
+                      << Dune::className(fe) << std::endl;
+            std::cout << "    Shape function " << i << " at position " << points[p]
+                      << ": batched derivative (" << k << "," << l << ") "
+                      << batchedJacobians[p*size+i][k][l]
+                      << " differs from " << jacobians[i][k][l] << std::endl;
+            success = false;
+          }
+  }
+
+  return success;
+}
+
 /** \brief Helper class to test the 'partial' method
  *
  * It implements a static loop over the available diff orders
@@ -624,6 +706,11 @@ bool testFE(const FE& fe, char disabledTests = DisableNone, unsigned int diffOrd
     success = TestPartial::test(fe, TOL, jacobianTOL, diffOrder, quadOrder) and success;
   }
 
+  if (not (disabledTests & DisableEvaluate))
+  {
+    success = testBatchedEvaluation<FE>(fe, not (disabledTests & DisableJacobian), quadOrder) and success;
+  }
+
   if (not (disabledTests & DisableVirtualInterface))
   {
     typedef typename FE::Traits::LocalBasisType::Traits ImplementationLBTraits;
@@ -642,6 +729,10 @@ bool testFE(const FE& fe, char disabledTests = DisableNone, unsigned int diffOrd
       // make sure diffOrder is 0
       success = (diffOrder == 0) and success;
     }
+    if (not (disabledTests & DisableEvaluate))
+    {
+      success = testBatchedEvaluation<VirtualFEInterface>(virtualFE, not (disabledTests & DisableJacobian), quadOrder) and success;
+    }
   }
 
   return success;
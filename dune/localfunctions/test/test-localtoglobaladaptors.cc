@@ -0,0 +1,237 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+#include <dune/common/fvector.hh>
+
+#include <dune/geometry/axisalignedcubegeometry.hh>
+#include <dune/geometry/multilineargeometry.hh>
+#include <dune/geometry/quadraturerules.hh>
+#include <dune/geometry/type.hh>
+
+#include <dune/localfunctions/common/tabulationcache.hh>
+#include <dune/localfunctions/lagrange/qk.hh>
+#include <dune/localfunctions/monomial.hh>
+
+/**
+ * \file
+ * \brief Compares the batched evaluation of ScalarLocalToGlobalBasisAdaptor
+ *        with the evaluation point by point, on affine and non-affine
+ *        geometries, and the gradients on an axis-aligned cube with those
+ *        on the same cube given as a multi-linear geometry.
+ */
+
+const double TOL = 1e-12;
+
+template<class Basis, class Points>
+bool testBasis (const Basis& basis, const Points& points, const std::string& name)
+{
+  typedef typename Basis::Traits Traits;
+  const std::size_t size = basis.size();
+  bool success = true;
+
+  std::vector<typename Traits::Range> values, batchedValues;
+  std::vector<typename Traits::Jacobian> jacobians, batchedJacobians;
+  basis.evaluateFunction(points, batchedValues);
+  basis.evaluateJacobian(points, batchedJacobians);
+  if (batchedValues.size() != points.size()*size or batchedJacobians.size() != points.size()*size)
+  {
+    std::cout << name << ": batched evaluation yields the wrong number of entries" << std::endl;
+    return false;
+  }
+
+  for (std::size_t p=0; p<points.size(); p++)
+  {
+    basis.evaluateFunction(points[p], values);
+    basis.evaluateJacobian(points[p], jacobians);
+    for (std::size_t i=0; i<size; i++)
+    {
+      typename Traits::Jacobian difference = batchedJacobians[p*size+i];
+      difference -= jacobians[i];
+      if ((batchedValues[p*size+i] - values[i]).infinity_norm() > TOL
+          or difference.infinity_norm() > TOL)
+      {
+        std::cout << name << ": batched evaluation of shape function " << i
+                  << " at " << points[p] << " yields " << batchedValues[p*size+i]
+                  << ", " << batchedJacobians[p*size+i] << " instead of "
+                  << values[i] << ", " << jacobians[i] << std::endl;
+        success = false;
+      }
+    }
+  }
+  return success;
+}
+
+template<class FE, class Geometry>
+bool testElement (const FE& fe, const Geometry& geometry, const std::string& name)
+{
+  static const int dim = Geometry::mydimension;
+  const auto& rule = Dune::QuadratureRules<double,dim>::rule(geometry.type(), 4);
+  std::vector<Dune::FieldVector<double,dim> > points;
+  for (const auto& qp : rule)
+    points.push_back(qp.position());
+
+  const auto& basis = fe.basis();
+  bool success = testBasis(basis, points, name);
+
+  // the local Jacobians may be taken from a cached tabulation
+  typedef typename FE::Traits::Basis::Traits Traits;
+  std::vector<typename Traits::Jacobian> jacobians, transformed;
+  basis.evaluateJacobian(points, jacobians);
+  auto tabulation = Dune::LocalBasisTabulationCache<typename std::decay_t<decltype(fe.localBasis())>::Traits>
+                    ::instance().get(fe.localBasis(), rule);
+  basis.transformJacobians(points, tabulation->jacobians(0), transformed);
+  for (std::size_t i=0; i<jacobians.size(); i++)
+  {
+    auto difference = transformed[i];
+    difference -= jacobians[i];
+    if (difference.infinity_norm() > TOL)
+    {
+      std::cout << name << ": transformed tabulation differs at entry " << i << std::endl;
+      success = false;
+    }
+  }
+  return success;
+}
+
+// Global-valued finite element of a local one, exposing the local basis as well
+template<class LocalFE, class Geometry>
+struct GlobalFE : public Dune::ScalarLocalToGlobalFiniteElementAdaptor<LocalFE,Geometry>
+{
+  GlobalFE (const LocalFE& localFE, const Geometry& geometry)
+    : Dune::ScalarLocalToGlobalFiniteElementAdaptor<LocalFE,Geometry>(localFE, geometry),
+      localFE_(localFE)
+  {}
+
+  const typename LocalFE::Traits::LocalBasisType& localBasis () const
+  {
+    return localFE_.localBasis();
+  }
+
+  const LocalFE& localFE_;
+};
+
+template<class LocalFE, class Geometry>
+bool test (const LocalFE& localFE, const Geometry& geometry, const std::string& name)
+{
+  return testElement(GlobalFE<LocalFE,Geometry>(localFE, geometry), geometry, name);
+}
+
+// The global gradients on two geometries of the same element agree
+template<class LocalFE, class Geometry, class ReferenceGeometry>
+bool compareGeometries (const LocalFE& localFE, const Geometry& geometry,
+                        const ReferenceGeometry& referenceGeometry, const std::string& name)
+{
+  static const int dim = Geometry::mydimension;
+  std::vector<Dune::FieldVector<double,dim> > points;
+  for (const auto& qp : Dune::QuadratureRules<double,dim>::rule(geometry.type(), 4))
+    points.push_back(qp.position());
+
+  const Dune::ScalarLocalToGlobalFiniteElementAdaptor<LocalFE,Geometry> fe(localFE, geometry);
+  const Dune::ScalarLocalToGlobalFiniteElementAdaptor<LocalFE,ReferenceGeometry> referenceFE(localFE, referenceGeometry);
+  typedef typename decltype(fe)::Traits::Basis::Traits Traits;
+  std::vector<typename Traits::Jacobian> jacobians, batchedJacobians, referenceJacobians;
+  fe.basis().evaluateJacobian(points, batchedJacobians);
+
+  bool success = true;
+  for (std::size_t p=0; p<points.size(); p++)
+  {
+    fe.basis().evaluateJacobian(points[p], jacobians);
+    referenceFE.basis().evaluateJacobian(points[p], referenceJacobians);
+    for (std::size_t i=0; i<jacobians.size(); i++)
+    {
+      typename Traits::Jacobian difference = jacobians[i], batchedDifference = batchedJacobians[p*jacobians.size()+i];
+      difference -= referenceJacobians[i];
+      batchedDifference -= referenceJacobians[i];
+      if (difference.infinity_norm() > TOL or batchedDifference.infinity_norm() > TOL)
+      {
+        std::cout << name << ": gradient of shape function " << i << " at " << points[p]
+                  << " is " << jacobians[i] << " instead of " << referenceJacobians[i] << std::endl;
+        success = false;
+      }
+    }
+  }
+  return success;
+}
+
+int main(int argc, char** argv)
+{
+  try
+  {
+    bool success = true;
+
+    // affine geometries
+    std::vector<Dune::FieldVector<double,2> > corners2d(3);
+    corners2d[0] = {0.1, 0.2};
+    corners2d[1] = {1.0, 0.4};
+    corners2d[2] = {0.3, 1.1};
+    const Dune::MultiLinearGeometry<double,2,2> triangle(Dune::GeometryTypes::triangle, corners2d);
+    success = test(Dune::MonomialLocalFiniteElement<double,double,2,3>(Dune::GeometryTypes::triangle), triangle,
+                   "monomial P3 on a triangle") and success;
+
+    corners2d.push_back({1.2, 1.3});
+    const Dune::MultiLinearGeometry<double,2,2> parallelogram(Dune::GeometryTypes::quadrilateral, corners2d);
+    success = test(Dune::QkLocalFiniteElement<double,double,2,2>(), parallelogram, "Q2 on a parallelogram") and success;
+
+    std::vector<Dune::FieldVector<double,3> > corners3d(4);
+    corners3d[0] = {0.0, 0.0, 0.0};
+    corners3d[1] = {1.0, 0.2, 0.1};
+    corners3d[2] = {0.3, 1.0, 0.2};
+    corners3d[3] = {0.1, 0.4, 0.9};
+    const Dune::MultiLinearGeometry<double,3,3> tetrahedron(Dune::GeometryTypes::tetrahedron, corners3d);
+    success = test(Dune::MonomialLocalFiniteElement<double,double,3,2>(Dune::GeometryTypes::tetrahedron), tetrahedron,
+                   "monomial P2 on a tetrahedron") and success;
+
+    // a non-affine quadrilateral
+    corners2d[0] = {0.0, 0.0};
+    corners2d[1] = {1.0, 0.2};
+    corners2d[2] = {0.1, 1.0};
+    corners2d[3] = {1.3, 1.4};
+    const Dune::MultiLinearGeometry<double,2,2> quadrilateral(Dune::GeometryTypes::quadrilateral, corners2d);
+    if (quadrilateral.affine())
+      DUNE_THROW(Dune::Exception, "The test quadrilateral should not be affine");
+    success = test(Dune::QkLocalFiniteElement<double,double,2,2>(), quadrilateral, "Q2 on non-affine quadrilateral") and success;
+    success = test(Dune::MonomialLocalFiniteElement<double,double,2,2>(Dune::GeometryTypes::quadrilateral), quadrilateral,
+                   "monomial P2 on non-affine quadrilateral") and success;
+
+    // a triangle embedded in 3d
+    corners3d.resize(3);
+    const Dune::MultiLinearGeometry<double,2,3> surfaceTriangle(Dune::GeometryTypes::triangle, corners3d);
+    success = test(Dune::MonomialLocalFiniteElement<double,double,2,2>(Dune::GeometryTypes::triangle), surfaceTriangle,
+                   "monomial P2 on a triangle in 3d") and success;
+
+    // axis-aligned cubes, whose Jacobians are diagonal matrices
+    const Dune::FieldVector<double,2> lower2d = {0.5, -1.0}, upper2d = {0.75, 1.0};
+    const Dune::AxisAlignedCubeGeometry<double,2,2> rectangle(lower2d, upper2d);
+    corners2d = {lower2d, {upper2d[0], lower2d[1]}, {lower2d[0], upper2d[1]}, upper2d};
+    const Dune::MultiLinearGeometry<double,2,2> multiLinearRectangle(Dune::GeometryTypes::quadrilateral, corners2d);
+    success = test(Dune::QkLocalFiniteElement<double,double,2,2>(), rectangle, "Q2 on an axis-aligned rectangle") and success;
+    success = compareGeometries(Dune::QkLocalFiniteElement<double,double,2,2>(), rectangle, multiLinearRectangle,
+                                "Q2 on an axis-aligned rectangle") and success;
+
+    const Dune::FieldVector<double,3> lower3d = {0.0, 1.0, 2.0}, upper3d = {0.5, 3.0, 2.25};
+    const Dune::AxisAlignedCubeGeometry<double,3,3> box(lower3d, upper3d);
+    corners3d.resize(8);
+    for (int c=0; c<8; c++)
+      for (int j=0; j<3; j++)
+        corners3d[c][j] = ((c >> j) & 1) ? upper3d[j] : lower3d[j];
+    const Dune::MultiLinearGeometry<double,3,3> multiLinearBox(Dune::GeometryTypes::hexahedron, corners3d);
+    success = compareGeometries(Dune::QkLocalFiniteElement<double,double,3,2>(), box, multiLinearBox,
+                                "Q2 on an axis-aligned box") and success;
+
+    return success ? 0 : 1;
+  }
+  catch (const Dune::Exception& e)
+  {
+    std::cerr << e << std::endl;
+    throw;
+  }
+}
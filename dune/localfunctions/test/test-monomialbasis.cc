@@ -0,0 +1,125 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#include <config.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <vector>
+
+#include <dune/geometry/type.hh>
+#include <dune/geometry/quadraturerules.hh>
+
+#include <dune/localfunctions/utility/monomialbasis.hh>
+
+/**
+ * \file
+ * \brief Checks that the evaluation of a MonomialBasis at several points
+ *        at once agrees with the evaluation point by point, and that the
+ *        sizes are tabulated up to the highest order without overflow.
+ */
+
+const double TOL = 1e-12;
+
+template <class Basis>
+bool compare(const Basis& basis, const std::vector<typename Basis::DomainVector>& points,
+             unsigned int deriv, std::size_t block)
+{
+  std::vector<double> values(block), table(block*points.size());
+  basis.evaluatePoints(deriv, points.data(), points.size(), table.data());
+  for (std::size_t p = 0; p < points.size(); ++p)
+  {
+    basis.evaluate(deriv, points[p], values.data());
+    for (std::size_t i = 0; i < block; ++i)
+      if (std::abs(values[i] - table[i*points.size()+p]) > TOL*std::max(1.0, std::abs(values[i])))
+        return false;
+  }
+  return true;
+}
+
+template <class Topology>
+bool test(unsigned int order, unsigned int maxDeriv, bool withApex = false)
+{
+  const int dim = Topology::dimension;
+  typedef Dune::MonomialBasis<Topology,double> Basis;
+  typedef Dune::MonomialBasisProvider<dim,double> Provider;
+
+  std::vector<typename Basis::DomainVector> points;
+  for (const auto& qp : Dune::QuadratureRules<double,dim>::rule(Dune::GeometryType(Topology::id, dim), 7))
+    points.push_back(qp.position());
+  if (withApex)
+  {
+    typename Basis::DomainVector apex(0);
+    apex[dim-1] = 1;
+    points.push_back(apex);
+  }
+
+  bool success = true;
+  const Basis basis(order);
+  const auto& virtualBasis = *Provider::template create<Topology>(order);
+  for (unsigned int deriv = 0; deriv <= maxDeriv; ++deriv)
+  {
+    const std::size_t block = basis.derivSize(deriv)*basis.size();
+    if (!compare(basis, points, deriv, block) || !compare(virtualBasis, points, deriv, block))
+    {
+      std::cout << "Evaluation at several points differs for " << Topology::name()
+                << " with order " << order << " and derivative " << deriv << std::endl;
+      success = false;
+    }
+  }
+  Provider::release(&virtualBasis);
+  return success;
+}
+
+// compare the number of monomials with the closed formula binomial(k+d,d)
+// for the simplex and (k+1)^d for the cube
+template <class Topology>
+bool testSizes(unsigned int simplexDim, unsigned int cubeDim, unsigned int maxOrder)
+{
+  const Dune::MonomialBasisSize<Topology> &size = Dune::MonomialBasisSize<Topology>::instance();
+  if (size.maxOrder() != maxOrder)
+  {
+    std::cout << "Sizes of topology " << Topology::id << " tabulated up to order "
+              << size.maxOrder() << " instead of " << maxOrder << std::endl;
+    return false;
+  }
+  for (unsigned int k = 0; k <= size.maxOrder(); ++k)
+  {
+    unsigned long long expected = 1;
+    for (unsigned int i = 1; i <= simplexDim; ++i)
+      expected = expected*(k+i)/i;
+    for (unsigned int i = 0; i < cubeDim; ++i)
+      expected *= k+1;
+    if (size(k) != expected)
+    {
+      std::cout << "Wrong size " << size(k) << " instead of " << expected
+                << " of topology " << Topology::id << " and order " << k << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+int main ( int argc, char **argv )
+{
+  using namespace Dune::Impl;
+
+  bool success = true;
+  success &= test<Prism<Point> >(6, 2);
+  success &= test<Pyramid<Pyramid<Point> > >(5, 2);
+  success &= test<Prism<Prism<Point> > >(4, 2);
+  success &= test<Pyramid<Pyramid<Pyramid<Point> > > >(6, 2);
+  success &= test<Prism<Pyramid<Pyramid<Point> > > >(3, 2);
+  success &= test<Prism<Prism<Prism<Point> > > >(3, 2);
+  // derivatives are not implemented for pyramids over non simplex bases
+  success &= test<Pyramid<Prism<Prism<Point> > > >(4, 0, true);
+
+  success &= testSizes<Point>(0, 0, Dune::monomialBasisOrderLimit);
+  success &= testSizes<Pyramid<Pyramid<Pyramid<Point> > > >(3, 0, Dune::monomialBasisOrderLimit);
+  success &= testSizes<Pyramid<Pyramid<Pyramid<Pyramid<Point> > > > >(4, 0, 564);
+  success &= testSizes<Prism<Prism<Prism<Point> > > >(0, 3, Dune::monomialBasisOrderLimit);
+  success &= testSizes<Prism<Prism<Prism<Prism<Point> > > > >(0, 4, 254);
+
+  return success ? 0 : 1;
+}
@@ -2,12 +2,16 @@
 // vi: set et ts=4 sw=2 sts=2:
 #include <config.h>
 
+#include <algorithm>
+#include <cmath>
+
 #include <dune/geometry/type.hh>
 #include <dune/geometry/quadraturerules.hh>
 
 #include <dune/localfunctions/utility/field.hh>
 #include <dune/localfunctions/utility/basisprint.hh>
 #include <dune/localfunctions/orthonormal/orthonormalbasis.hh>
+#include <dune/localfunctions/orthonormal/orthonormalcompute.hh>
 
 /**
  * \file
@@ -99,6 +103,33 @@ bool test(unsigned int order)
   return ret;
 }
 
+// the Gram-Schmidt procedures yield the same coefficients as the default
+// Cholesky factorization
+template <class Topology>
+bool testMethods(unsigned int order)
+{
+  const ONBCompute::ONBMatrix< Topology, ComputeField > cholesky( order );
+  bool ret = true;
+  for( ONBCompute::Orthonormalization method : { ONBCompute::gramSchmidt, ONBCompute::gramSchmidtReorthogonalized } )
+  {
+    const ONBCompute::ONBMatrix< Topology, ComputeField > other( order, method );
+    double max = 0, diff = 0;
+    for( unsigned int i = 0; i < cholesky.rows(); ++i )
+      for( unsigned int j = 0; j < cholesky.cols(); ++j )
+      {
+        max = std::max( max, std::abs( Dune::field_cast< double >( cholesky( i, j ) ) ) );
+        diff = std::max( diff, std::abs( Dune::field_cast< double >( ComputeField( cholesky( i, j ) - other( i, j ) ) ) ) );
+      }
+    if( diff > 1e-8*max )
+    {
+      std::cout << "Orthonormalization method " << method << " differs by " << diff/max
+                << " for " << Topology::name() << " with order " << order << std::endl;
+      ret = false;
+    }
+  }
+  return ret;
+}
+
 #ifdef CHECKDIM
   #if CHECKDIM==1
       #define CHECKDIM1
@@ -143,6 +174,7 @@ int main ( int argc, char **argv )
 #ifdef CHECKDIM2
   tests &= test<Prism<Prism<Point> > > (order);
   tests &= test<Pyramid<Pyramid<Point> > >(order);
+  tests &= testMethods<Pyramid<Pyramid<Point> > >(order);
 #endif
 
 #ifdef CHECKDIM3
@@ -150,6 +182,7 @@ int main ( int argc, char **argv )
   tests &= test<Prism<Pyramid<Pyramid<Point> > > >(order);
   tests &= test<Pyramid<Prism<Prism<Point> > > >(order);
   tests &= test<Pyramid<Pyramid<Pyramid<Point> > > >(order);
+  tests &= testMethods<Pyramid<Prism<Prism<Point> > > >(order);
 #endif
 
 #ifdef CHECKDIM4
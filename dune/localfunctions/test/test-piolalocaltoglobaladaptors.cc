@@ -0,0 +1,380 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+#include <dune/common/fmatrix.hh>
+#include <dune/common/fvector.hh>
+
+#include <dune/geometry/axisalignedcubegeometry.hh>
+#include <dune/geometry/multilineargeometry.hh>
+#include <dune/geometry/quadraturerules.hh>
+#include <dune/geometry/type.hh>
+
+#include <dune/localfunctions/brezzidouglasmarini/brezzidouglasmarini1simplex2d.hh>
+#include <dune/localfunctions/common/piolalocaltoglobaladaptors.hh>
+#include <dune/localfunctions/raviartthomas/raviartthomas02d.hh>
+#include <dune/localfunctions/raviartthomas/raviartthomas0cube2d.hh>
+#include <dune/localfunctions/raviartthomas/raviartthomas0cube3d.hh>
+#include <dune/localfunctions/raviartthomas/raviartthomas1cube2d.hh>
+#include <dune/localfunctions/raviartthomas/raviartthomas1cube3d.hh>
+
+#include "test-fe.hh"
+
+/**
+ * \file
+ * \brief Tests the contravariant and covariant Piola adaptors: the batched
+ *        evaluation against the evaluation point by point, the divergence
+ *        and the curl against finite differences of the transformed shape
+ *        functions, the interpolation, and, on affine geometries, the
+ *        Jacobians.  On axis-aligned cubes all results are compared with
+ *        those on the same cube given as a multi-linear geometry.
+ */
+
+const double eps = 1e-9;
+const double delta = 1e-5;
+
+// Global gradients of all shape functions at x by central differences of
+// the transformed values in local coordinates
+template<class Basis, class Geometry>
+std::vector<typename Basis::Traits::Jacobian>
+finiteDifferences (const Basis& basis, const Geometry& geometry,
+                   const typename Basis::Traits::DomainLocal& x)
+{
+  typedef typename Basis::Traits Traits;
+  static const int dim = Traits::dimDomainLocal;
+
+  std::vector<typename Traits::Jacobian> localDerivatives(basis.size()), out(basis.size());
+  std::vector<typename Traits::Range> up, down;
+  for (int m=0; m<dim; m++)
+  {
+    auto upPos = x, downPos = x;
+    upPos[m] += delta;
+    downPos[m] -= delta;
+    basis.evaluateFunction(upPos, up);
+    basis.evaluateFunction(downPos, down);
+    for (std::size_t i=0; i<basis.size(); i++)
+      for (int a=0; a<dim; a++)
+        localDerivatives[i][a][m] = (up[i][a] - down[i][a]) / (2*delta);
+  }
+
+  // the derivatives in local direction m are the global gradients times
+  // the mth column of the Jacobian of the geometry
+  const Dune::FieldMatrix<double,dim,dim> jit = geometry.jacobianInverseTransposed(x);
+  for (std::size_t i=0; i<basis.size(); i++)
+    for (int a=0; a<dim; a++)
+      for (int b=0; b<dim; b++)
+      {
+        out[i][a][b] = 0;
+        for (int m=0; m<dim; m++)
+          out[i][a][b] += localDerivatives[i][a][m] * jit[b][m];
+      }
+  return out;
+}
+
+template<class T>
+double distance (const T& a, const T& b)
+{
+  T difference = a;
+  difference -= b;
+  return difference.infinity_norm();
+}
+
+double distance (double a, double b)
+{
+  return std::abs(a - b);
+}
+
+// Compare the batched results with those of the single points
+template<class Basis, class Points, class Evaluate, class Value>
+bool compareBatched (const Basis& basis, const Points& points, Evaluate&& evaluate,
+                     std::vector<Value>& batched, const std::string& name)
+{
+  bool success = true;
+  evaluate(points, batched);
+  std::vector<Value> single;
+  for (std::size_t p=0; p<points.size(); p++)
+  {
+    evaluate(points[p], single);
+    for (std::size_t i=0; i<basis.size(); i++)
+      if (distance(batched[p*basis.size()+i], single[i]) > eps)
+      {
+        std::cout << name << ": batched evaluation of shape function " << i
+                  << " at " << points[p] << " differs" << std::endl;
+        success = false;
+      }
+  }
+  return success;
+}
+
+template<class Basis, class Geometry, class Points>
+bool testContravariant (const Basis& basis, const Geometry& geometry, const Points& points,
+                        const std::string& name)
+{
+  typedef typename Basis::Traits Traits;
+  static const int dim = Traits::dimDomainLocal;
+  bool success = true;
+
+  std::vector<typename Traits::Range> values;
+  std::vector<typename Traits::Jacobian> jacobians;
+  std::vector<typename Traits::RangeField> divergences;
+  success = compareBatched(basis, points, [&](const auto& x, auto& out) { basis.evaluateFunction(x, out); },
+                           values, name + " values") and success;
+  success = compareBatched(basis, points, [&](const auto& x, auto& out) { basis.evaluateJacobian(x, out); },
+                           jacobians, name + " Jacobians") and success;
+  success = compareBatched(basis, points, [&](const auto& x, auto& out) { basis.evaluateDivergence(x, out); },
+                           divergences, name + " divergences") and success;
+
+  for (std::size_t p=0; p<points.size(); p++)
+  {
+    const auto gradients = finiteDifferences(basis, geometry, points[p]);
+    for (std::size_t i=0; i<basis.size(); i++)
+    {
+      double divergence = 0;
+      for (int a=0; a<dim; a++)
+        divergence += gradients[i][a][a];
+      if (std::abs(divergences[p*basis.size()+i] - divergence) > eps/delta)
+      {
+        std::cout << name << ": divergence of shape function " << i << " at " << points[p]
+                  << " is " << divergences[p*basis.size()+i] << " instead of " << divergence << std::endl;
+        success = false;
+      }
+    }
+  }
+  return success;
+}
+
+template<class Basis, class Geometry, class Points>
+bool testCovariant (const Basis& basis, const Geometry& geometry, const Points& points,
+                    const std::string& name)
+{
+  typedef typename Basis::Traits Traits;
+  static const int dim = Traits::dimDomainLocal;
+  bool success = true;
+
+  std::vector<typename Traits::Range> values;
+  std::vector<typename Traits::Jacobian> jacobians;
+  std::vector<typename Basis::Curl> curls;
+  success = compareBatched(basis, points, [&](const auto& x, auto& out) { basis.evaluateFunction(x, out); },
+                           values, name + " values") and success;
+  success = compareBatched(basis, points, [&](const auto& x, auto& out) { basis.evaluateJacobian(x, out); },
+                           jacobians, name + " Jacobians") and success;
+  success = compareBatched(basis, points, [&](const auto& x, auto& out) { basis.evaluateCurl(x, out); },
+                           curls, name + " curls") and success;
+
+  for (std::size_t p=0; p<points.size(); p++)
+  {
+    const auto gradients = finiteDifferences(basis, geometry, points[p]);
+    for (std::size_t i=0; i<basis.size(); i++)
+    {
+      typename Basis::Curl curl;
+      if (dim == 2)
+        curl[0] = gradients[i][1][0] - gradients[i][0][1];
+      else
+        for (std::size_t a=0; a<curl.size(); a++)
+          curl[a] = gradients[i][(a+2)%dim][(a+1)%dim] - gradients[i][(a+1)%dim][(a+2)%dim];
+      if (distance(curls[p*basis.size()+i], curl) > eps/delta)
+      {
+        std::cout << name << ": curl of shape function " << i << " at " << points[p]
+                  << " is " << curls[p*basis.size()+i] << " instead of " << curl << std::endl;
+        success = false;
+      }
+    }
+  }
+  return success;
+}
+
+template<class LocalFE, class Geometry>
+bool test (const LocalFE& localFE, const Geometry& geometry, const std::string& name)
+{
+  static const int dim = Geometry::mydimension;
+  std::vector<Dune::FieldVector<double,dim> > points;
+  for (const auto& qp : Dune::QuadratureRules<double,dim>::rule(geometry.type(), 3))
+    points.push_back(qp.position());
+
+  const Dune::ContravariantPiolaLocalToGlobalAdaptor<LocalFE,Geometry> contravariant(localFE, geometry);
+  const Dune::CovariantPiolaLocalToGlobalAdaptor<LocalFE,Geometry> covariant(localFE, geometry);
+
+  bool success = testContravariant(contravariant.basis(), geometry, points, name + " contravariant");
+  success = testCovariant(covariant.basis(), geometry, points, name + " covariant") and success;
+
+  // the interpolation reproduces the transformed shape functions
+  success = testInterpolation(contravariant, eps) and success;
+  success = testInterpolation(covariant, eps) and success;
+
+  // the Jacobians are exact on affine geometries only
+  if (geometry.affine())
+  {
+    success = testJacobian(geometry, contravariant, eps, delta) and success;
+    success = testJacobian(geometry, covariant, eps, delta) and success;
+  }
+  return success;
+}
+
+// A global vector field, evaluated in local coordinates
+template<int dim>
+struct VectorField
+{
+  void evaluate (const Dune::FieldVector<double,dim>& x, Dune::FieldVector<double,dim>& y) const
+  {
+    for (int a=0; a<dim; a++)
+      y[a] = 1.0 + a + x[a]*x[(a+1)%dim];
+  }
+};
+
+// Compare the results of an adaptor on two geometries of the same element
+template<class Adaptor, class ReferenceAdaptor, class Points, class Evaluate>
+bool compareAdaptors (const Adaptor& adaptor, const ReferenceAdaptor& reference, const Points& points,
+                      Evaluate&& evaluate, const std::string& name)
+{
+  bool success = true;
+  auto values = evaluate(adaptor.basis(), points);
+  auto referenceValues = evaluate(reference.basis(), points);
+  for (std::size_t k=0; k<values.size(); k++)
+    if (distance(values[k], referenceValues[k]) > eps)
+    {
+      std::cout << name << ": entry " << k << " is " << values[k]
+                << " instead of " << referenceValues[k] << std::endl;
+      success = false;
+    }
+
+  std::vector<double> coefficients, referenceCoefficients;
+  adaptor.interpolation().interpolate(VectorField<Points::value_type::dimension>(), coefficients);
+  reference.interpolation().interpolate(VectorField<Points::value_type::dimension>(), referenceCoefficients);
+  for (std::size_t i=0; i<coefficients.size(); i++)
+    if (std::abs(coefficients[i] - referenceCoefficients[i]) > eps)
+    {
+      std::cout << name << ": interpolation coefficient " << i << " is " << coefficients[i]
+                << " instead of " << referenceCoefficients[i] << std::endl;
+      success = false;
+    }
+  return success;
+}
+
+template<class LocalFE, class Geometry, class ReferenceGeometry>
+bool compareGeometries (const LocalFE& localFE, const Geometry& geometry,
+                        const ReferenceGeometry& referenceGeometry, const std::string& name)
+{
+  static const int dim = Geometry::mydimension;
+  std::vector<Dune::FieldVector<double,dim> > points;
+  for (const auto& qp : Dune::QuadratureRules<double,dim>::rule(geometry.type(), 3))
+    points.push_back(qp.position());
+
+  const Dune::ContravariantPiolaLocalToGlobalAdaptor<LocalFE,Geometry> contravariant(localFE, geometry);
+  const Dune::ContravariantPiolaLocalToGlobalAdaptor<LocalFE,ReferenceGeometry> referenceContravariant(localFE, referenceGeometry);
+  const Dune::CovariantPiolaLocalToGlobalAdaptor<LocalFE,Geometry> covariant(localFE, geometry);
+  const Dune::CovariantPiolaLocalToGlobalAdaptor<LocalFE,ReferenceGeometry> referenceCovariant(localFE, referenceGeometry);
+
+  auto values = [](const auto& basis, const auto& x) {
+    std::vector<typename std::decay_t<decltype(basis)>::Traits::Range> out;
+    basis.evaluateFunction(x, out);
+    return out;
+  };
+  auto jacobians = [](const auto& basis, const auto& x) {
+    std::vector<typename std::decay_t<decltype(basis)>::Traits::Jacobian> out;
+    basis.evaluateJacobian(x, out);
+    return out;
+  };
+  auto divergences = [](const auto& basis, const auto& x) {
+    std::vector<typename std::decay_t<decltype(basis)>::Traits::RangeField> out;
+    basis.evaluateDivergence(x, out);
+    return out;
+  };
+  auto curls = [](const auto& basis, const auto& x) {
+    std::vector<typename std::decay_t<decltype(basis)>::Curl> out;
+    basis.evaluateCurl(x, out);
+    return out;
+  };
+
+  bool success = compareAdaptors(contravariant, referenceContravariant, points, values, name + " contravariant values");
+  success = compareAdaptors(contravariant, referenceContravariant, points, jacobians, name + " contravariant Jacobians") and success;
+  success = compareAdaptors(contravariant, referenceContravariant, points, divergences, name + " divergences") and success;
+  success = compareAdaptors(covariant, referenceCovariant, points, values, name + " covariant values") and success;
+  success = compareAdaptors(covariant, referenceCovariant, points, jacobians, name + " covariant Jacobians") and success;
+  success = compareAdaptors(covariant, referenceCovariant, points, curls, name + " curls") and success;
+  return success;
+}
+
+int main(int argc, char** argv)
+{
+  try
+  {
+    bool success = true;
+
+    typedef Dune::MultiLinearGeometry<double,2,2> Geometry2d;
+    typedef Dune::MultiLinearGeometry<double,3,3> Geometry3d;
+
+    std::vector<Dune::FieldVector<double,2> > corners2d(3);
+    corners2d[0] = {0.1, 0.2};
+    corners2d[1] = {1.0, 0.4};
+    corners2d[2] = {0.3, 1.1};
+    const Geometry2d triangle(Dune::GeometryTypes::triangle, corners2d);
+    success = test(Dune::RT02DLocalFiniteElement<double,double>(), triangle, "RT0 on a triangle") and success;
+    success = test(Dune::BDM1Simplex2DLocalFiniteElement<double,double>(), triangle, "BDM1 on a triangle") and success;
+
+    // a negatively oriented triangle
+    std::swap(corners2d[1], corners2d[2]);
+    const Geometry2d reflected(Dune::GeometryTypes::triangle, corners2d);
+    success = test(Dune::RT02DLocalFiniteElement<double,double>(), reflected, "RT0 on a reflected triangle") and success;
+    success = test(Dune::BDM1Simplex2DLocalFiniteElement<double,double>(), reflected, "BDM1 on a reflected triangle") and success;
+
+    corners2d = {{0.0, 0.0}, {1.0, 0.2}, {0.1, 1.0}, {1.3, 1.4}};
+    const Geometry2d quadrilateral(Dune::GeometryTypes::quadrilateral, corners2d);
+    if (quadrilateral.affine())
+      DUNE_THROW(Dune::Exception, "The test quadrilateral should not be affine");
+    success = test(Dune::RT0Cube2DLocalFiniteElement<double,double>(0), quadrilateral, "RT0 on a quadrilateral") and success;
+    success = test(Dune::RT1Cube2DLocalFiniteElement<double,double>(0), quadrilateral, "RT1 on a quadrilateral") and success;
+
+    corners2d[3] = {1.1, 1.2};
+    const Geometry2d parallelogram(Dune::GeometryTypes::quadrilateral, corners2d);
+    success = test(Dune::RT0Cube2DLocalFiniteElement<double,double>(0), parallelogram, "RT0 on a parallelogram") and success;
+
+    std::vector<Dune::FieldVector<double,3> > corners3d(8);
+    for (int c=0; c<8; c++)
+      for (int j=0; j<3; j++)
+        corners3d[c][j] = ((c >> j) & 1) + 0.1*j*((c >> ((j+1)%3)) & 1);
+    const Geometry3d parallelepiped(Dune::GeometryTypes::hexahedron, corners3d);
+    success = test(Dune::RT0Cube3DLocalFiniteElement<double,double>(0), parallelepiped, "RT0 on a parallelepiped") and success;
+    success = test(Dune::RT1Cube3DLocalFiniteElement<double,double>(0), parallelepiped, "RT1 on a parallelepiped") and success;
+
+    corners3d[7] = {1.2, 1.3, 1.1};
+    const Geometry3d hexahedron(Dune::GeometryTypes::hexahedron, corners3d);
+    if (hexahedron.affine())
+      DUNE_THROW(Dune::Exception, "The test hexahedron should not be affine");
+    success = test(Dune::RT0Cube3DLocalFiniteElement<double,double>(0), hexahedron, "RT0 on a hexahedron") and success;
+    success = test(Dune::RT1Cube3DLocalFiniteElement<double,double>(0), hexahedron, "RT1 on a hexahedron") and success;
+
+    // axis-aligned cubes, whose Jacobians are diagonal matrices
+    const Dune::FieldVector<double,2> lower2d = {0.5, -1.0}, upper2d = {0.75, 1.0};
+    const Dune::AxisAlignedCubeGeometry<double,2,2> rectangle(lower2d, upper2d);
+    corners2d = {lower2d, {upper2d[0], lower2d[1]}, {lower2d[0], upper2d[1]}, upper2d};
+    const Geometry2d multiLinearRectangle(Dune::GeometryTypes::quadrilateral, corners2d);
+    success = test(Dune::RT1Cube2DLocalFiniteElement<double,double>(0), rectangle, "RT1 on an axis-aligned rectangle") and success;
+    success = compareGeometries(Dune::RT1Cube2DLocalFiniteElement<double,double>(0), rectangle, multiLinearRectangle,
+                                "RT1 on an axis-aligned rectangle") and success;
+
+    const Dune::FieldVector<double,3> lower3d = {0.0, 1.0, 2.0}, upper3d = {0.5, 3.0, 2.25};
+    const Dune::AxisAlignedCubeGeometry<double,3,3> box(lower3d, upper3d);
+    for (int c=0; c<8; c++)
+      for (int j=0; j<3; j++)
+        corners3d[c][j] = ((c >> j) & 1) ? upper3d[j] : lower3d[j];
+    const Geometry3d multiLinearBox(Dune::GeometryTypes::hexahedron, corners3d);
+    success = compareGeometries(Dune::RT1Cube3DLocalFiniteElement<double,double>(0), box, multiLinearBox,
+                                "RT1 on an axis-aligned box") and success;
+
+    return success ? 0 : 1;
+  }
+  catch (const Dune::Exception& e)
+  {
+    std::cerr << e << std::endl;
+    throw;
+  }
+}
@@ -0,0 +1,169 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#include <config.h>
+
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include <dune/geometry/type.hh>
+#include <dune/geometry/quadraturerules.hh>
+
+#include <dune/localfunctions/orthonormal/orthonormalbasis.hh>
+
+/**
+ * \file
+ * \brief Evaluates one PolynomialBasis object from several threads at the
+ *        same time and compares the results to a serial evaluation, and
+ *        evaluates several bases in turn in one thread.
+ */
+
+const double TOL = 1e-12;
+
+template <class Values>
+bool compare(const Values& reference, const Values& values)
+{
+  if (reference.size() != values.size())
+    return false;
+  for (std::size_t i = 0; i < reference.size(); ++i)
+    if ((reference[i] - values[i]).infinity_norm() > TOL)
+      return false;
+  return true;
+}
+
+template <class Topology>
+bool test(unsigned int order, unsigned int numThreads)
+{
+  const int dim = Topology::dimension;
+  typedef Dune::OrthonormalBasisFactory<dim,double,double> BasisFactory;
+  typedef typename BasisFactory::Object Basis;
+  typedef typename Basis::Traits Traits;
+  typedef Dune::FieldVector<double,Basis::dimRange*dim> FlatJacobian;
+
+  const Basis& basis = *BasisFactory::template create<Topology>(order);
+
+  Dune::GeometryType gt(Topology::id, dim);
+  const auto& quadrature = Dune::QuadratureRules<double,dim>::rule(gt, 2*order+1);
+
+  // serial reference values, flattened Jacobians for easy comparison
+  std::vector<std::vector<typename Traits::RangeType> > values(quadrature.size());
+  std::vector<std::vector<FlatJacobian> > jacobians(quadrature.size());
+  std::vector<typename Traits::JacobianType> jacobian;
+  for (std::size_t q = 0; q < quadrature.size(); ++q)
+  {
+    basis.evaluateFunction(quadrature[q].position(), values[q]);
+    basis.evaluateJacobian(quadrature[q].position(), jacobian);
+    for (const auto& j : jacobian)
+      jacobians[q].push_back(reinterpret_cast<const FlatJacobian&>(j));
+  }
+
+  // every thread alternates between the thread-local and an explicit workspace
+  std::vector<char> success(numThreads, true);
+  std::vector<std::thread> threads;
+  for (unsigned int t = 0; t < numThreads; ++t)
+    threads.emplace_back([&, t]()
+    {
+      typename Basis::Workspace workspace(basis);
+      std::vector<typename Traits::RangeType> y;
+      std::vector<typename Traits::JacobianType> dy;
+      std::vector<FlatJacobian> flat;
+      for (unsigned int repeat = 0; repeat < 20; ++repeat)
+        for (std::size_t q = 0; q < quadrature.size(); ++q)
+        {
+          if ((q+t) % 2)
+          {
+            basis.evaluateFunction(quadrature[q].position(), y);
+            basis.evaluateJacobian(quadrature[q].position(), dy);
+          }
+          else
+          {
+            basis.evaluateFunction(quadrature[q].position(), y, workspace);
+            basis.evaluateJacobian(quadrature[q].position(), dy, workspace);
+          }
+          flat.clear();
+          for (const auto& j : dy)
+            flat.push_back(reinterpret_cast<const FlatJacobian&>(j));
+          if (!compare(values[q], y) or !compare(jacobians[q], flat))
+            success[t] = false;
+        }
+    });
+  for (auto& thread : threads)
+    thread.join();
+
+  BasisFactory::release(&basis);
+
+  bool ret = true;
+  for (unsigned int t = 0; t < numThreads; ++t)
+    if (!success[t])
+    {
+      std::cout << "Concurrent evaluation of " << Topology::name() << " with order " << order
+                << " differs from serial evaluation in thread " << t << std::endl;
+      ret = false;
+    }
+  return ret;
+}
+
+// Evaluates numBases bases of consecutive orders in turn in one thread,
+// and recreates one of them in between, with the thread-local workspaces
+template <class Topology>
+bool testSwitching(unsigned int order, unsigned int numBases)
+{
+  const int dim = Topology::dimension;
+  typedef Dune::OrthonormalBasisFactory<dim,double,double> BasisFactory;
+  typedef typename BasisFactory::Object Basis;
+  typedef typename Basis::Traits Traits;
+
+  Dune::GeometryType gt(Topology::id, dim);
+  const auto& quadrature = Dune::QuadratureRules<double,dim>::rule(gt, 2*(order+numBases)+1);
+
+  std::vector<const Basis*> bases(numBases);
+  std::vector<std::vector<std::vector<typename Traits::RangeType> > > values(numBases);
+  for (unsigned int b = 0; b < numBases; ++b)
+  {
+    bases[b] = BasisFactory::template create<Topology>(order+b);
+    typename Basis::Workspace workspace(*bases[b]);
+    values[b].resize(quadrature.size());
+    for (std::size_t q = 0; q < quadrature.size(); ++q)
+      bases[b]->evaluateFunction(quadrature[q].position(), values[b][q], workspace);
+  }
+
+  bool success = true;
+  std::vector<typename Traits::RangeType> y;
+  for (unsigned int repeat = 0; repeat < 2; ++repeat)
+  {
+    for (std::size_t q = 0; q < quadrature.size(); ++q)
+      for (unsigned int b = 0; b < numBases; ++b)
+      {
+        bases[b]->evaluateFunction(quadrature[q].position(), y);
+        success = compare(values[b][q], y) and success;
+      }
+    BasisFactory::release(bases.back());
+    bases.back() = BasisFactory::template create<Topology>(order+numBases-1);
+  }
+  for (const Basis* basis : bases)
+    BasisFactory::release(basis);
+
+  if (!success)
+    std::cout << "Evaluation of " << numBases << " bases on " << Topology::name()
+              << " in turn differs from the evaluation with explicit workspaces" << std::endl;
+  return success;
+}
+
+int main ( int argc, char **argv )
+{
+  using namespace Dune::Impl;
+
+  const unsigned int numThreads = 8;
+
+  bool success = true;
+  success &= testSwitching<Pyramid<Pyramid<Point> > >(1, 2);
+  success &= testSwitching<Pyramid<Pyramid<Point> > >(1, 7);
+  success &= testSwitching<Prism<Pyramid<Pyramid<Point> > > >(2, 2);
+  success &= test<Pyramid<Pyramid<Point> > >(4, numThreads);
+  success &= test<Prism<Prism<Point> > >(3, numThreads);
+  success &= test<Pyramid<Pyramid<Pyramid<Point> > > >(3, numThreads);
+
+  return success ? 0 : 1;
+}
@@ -0,0 +1,114 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#include <config.h>
+
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+
+#include <dune/geometry/type.hh>
+#include <dune/geometry/quadraturerules.hh>
+
+#include <dune/localfunctions/lagrange.hh>
+#include <dune/localfunctions/lagrange/equidistantpoints.hh>
+#include <dune/localfunctions/orthonormal.hh>
+#include <dune/localfunctions/utility/prewarm.hh>
+
+/**
+ * \file
+ * \brief Prewarms several generic finite elements concurrently and checks
+ *        that the elements created afterwards agree with the bases created
+ *        directly by the factories.
+ */
+
+const double TOL = 1e-10;
+
+// A finite element which cannot be built
+struct Failing
+{
+  Failing (const Dune::GeometryType&, unsigned int)
+  {
+    DUNE_THROW(Dune::NotImplemented, "Failing cannot be built");
+  }
+};
+
+template <class FE, class BasisFactory>
+bool compare(const Dune::GeometryType& gt, unsigned int order)
+{
+  const int dim = FE::Traits::LocalBasisType::Traits::dimDomain;
+  FE finiteElement(gt, order);
+  const auto& basis = *BasisFactory::create(gt, order);
+
+  bool success = true;
+  std::vector<typename FE::Traits::LocalBasisType::Traits::RangeType> values1, values2;
+  for (const auto& qp : Dune::QuadratureRules<double,dim>::rule(gt, 3))
+  {
+    finiteElement.localBasis().evaluateFunction(qp.position(), values1);
+    basis.evaluateFunction(qp.position(), values2);
+    for (std::size_t i = 0; i < values1.size(); ++i)
+      if ((values1[i] - values2[i]).infinity_norm() > TOL)
+        success = false;
+  }
+  if (!success)
+    std::cout << "Prewarmed element " << gt << " of order " << order
+              << " differs from the basis of the factory" << std::endl;
+
+  BasisFactory::release(&basis);
+  return success;
+}
+
+int main ( int argc, char **argv )
+{
+  typedef Dune::LagrangeLocalFiniteElement<Dune::EquidistantPointSet,3,double,double> Lagrange;
+  typedef Dune::LagrangeBasisFactory<Dune::EquidistantPointSet,3,double,double> LagrangeBasisFactory;
+  typedef Dune::OrthonormalLocalFiniteElement<2,double,double> Orthonormal;
+  typedef Dune::OrthonormalBasisFactory<2,double,double> OrthonormalBasisFactory;
+
+  const Dune::GeometryType types3d[] = { Dune::GeometryTypes::simplex(3), Dune::GeometryTypes::cube(3),
+                                         Dune::GeometryTypes::prism, Dune::GeometryTypes::pyramid };
+  const Dune::GeometryType types2d[] = { Dune::GeometryTypes::simplex(2), Dune::GeometryTypes::cube(2) };
+
+  Dune::LocalFiniteElementPrewarm prewarm;
+  for (unsigned int order = 1; order <= 3; ++order)
+  {
+    for (const auto& gt : types3d)
+      prewarm.add<Lagrange>(gt, order, "lagrange");
+    for (const auto& gt : types2d)
+      prewarm.add<Orthonormal>(gt, order, "orthonormal");
+    prewarm.addFactory<Dune::MonomialBasisProvider<3,double> >(Dune::GeometryTypes::simplex(3), order);
+  }
+  prewarm.add<Failing>(Dune::GeometryTypes::simplex(2), 1, "failing");
+
+  bool success = true;
+
+  const auto timings = prewarm.run(4);
+  if (timings.size() != prewarm.size())
+  {
+    std::cout << "Prewarming returned " << timings.size() << " timings for "
+              << prewarm.size() << " items" << std::endl;
+    success = false;
+  }
+  for (const auto& timing : timings)
+  {
+    std::cout << timing.family << " " << timing.type << " order " << timing.order
+              << ": " << timing.seconds << "s" << std::endl;
+    if (timing.success != (timing.family != "failing") || timing.seconds < 0)
+    {
+      std::cout << "Unexpected result for " << timing.family << ": " << timing.message << std::endl;
+      success = false;
+    }
+  }
+
+  for (unsigned int order = 1; order <= 3; ++order)
+  {
+    for (const auto& gt : types3d)
+      success &= compare<Lagrange,LagrangeBasisFactory>(gt, order);
+    for (const auto& gt : types2d)
+      success &= compare<Orthonormal,OrthonormalBasisFactory>(gt, order);
+  }
+
+  return success ? 0 : 1;
+}
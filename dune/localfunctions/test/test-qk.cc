@@ -0,0 +1,117 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+#include <dune/common/fvector.hh>
+#include <dune/common/hybridutilities.hh>
+#include <dune/common/std/utility.hh>
+
+#include <dune/geometry/quadraturerules.hh>
+#include <dune/geometry/type.hh>
+
+#include <dune/localfunctions/lagrange/qk.hh>
+
+#include "test-localfe.hh"
+
+// Check that QkLocalBasis::evaluateAll agrees with evaluateFunction,
+// evaluateJacobian and partial
+template<int k, int dim>
+bool testEvaluateAll()
+{
+  typedef Dune::QkLocalFiniteElement<double,double,dim,k> FE;
+  typedef typename FE::Traits::LocalBasisType LB;
+  typedef typename LB::Traits Traits;
+
+  FE fe;
+  const LB& basis = fe.localBasis();
+
+  bool success = true;
+  std::vector<typename Traits::RangeType> values, allValues, partialValues;
+  std::vector<typename Traits::JacobianType> jacobians, allJacobians;
+  std::vector<typename LB::HessianType> allHessians;
+
+  const auto& quad = Dune::QuadratureRules<double,dim>::rule(fe.type(), 2*k+1);
+  for (const auto& qp : quad)
+  {
+    const auto& x = qp.position();
+    basis.evaluateFunction(x, values);
+    basis.evaluateJacobian(x, jacobians);
+    basis.evaluateAll(x, allValues, allJacobians, allHessians);
+
+    if (allValues.size() != basis.size() or allJacobians.size() != basis.size() or allHessians.size() != basis.size())
+    {
+      std::cout << "evaluateAll of Q" << k << " in " << dim << "d returns wrong number of entries" << std::endl;
+      return false;
+    }
+
+    for (std::size_t i=0; i<basis.size(); i++)
+    {
+      if (std::abs(values[i][0] - allValues[i][0]) > TOL)
+      {
+        std::cout << "Q" << k << " in " << dim << "d: value of shape function " << i
+                  << " at " << x << " differs: " << values[i][0] << " vs. " << allValues[i][0] << std::endl;
+        success = false;
+      }
+      for (int j=0; j<dim; j++)
+        if (std::abs(jacobians[i][0][j] - allJacobians[i][0][j]) > TOL)
+        {
+          std::cout << "Q" << k << " in " << dim << "d: derivative " << j << " of shape function " << i
+                    << " at " << x << " differs: " << jacobians[i][0][j] << " vs. " << allJacobians[i][0][j] << std::endl;
+          success = false;
+        }
+    }
+
+    for (int j=0; j<dim; j++)
+      for (int l=0; l<dim; l++)
+      {
+        std::array<unsigned int,dim> order;
+        order.fill(0);
+        order[j]++;
+        order[l]++;
+        basis.partial(order, x, partialValues);
+        for (std::size_t i=0; i<basis.size(); i++)
+          if (std::abs(partialValues[i][0] - allHessians[i][j][l]) > TOL)
+          {
+            std::cout << "Q" << k << " in " << dim << "d: second derivative (" << j << "," << l << ") of shape function " << i
+                      << " at " << x << " differs: " << partialValues[i][0] << " vs. " << allHessians[i][j][l] << std::endl;
+            success = false;
+          }
+      }
+  }
+
+  return success;
+}
+
+int main(int argc, char** argv)
+{
+  try
+  {
+    bool success = true;
+
+    Dune::Hybrid::forEach(Dune::Std::make_index_sequence<5>{}, [&success](auto k)
+    {
+      success = testEvaluateAll<k,1>() and success;
+      success = testEvaluateAll<k,2>() and success;
+      success = testEvaluateAll<k,3>() and success;
+    });
+
+    Dune::QkLocalFiniteElement<double,double,3,4> qk43dlfem;
+    TEST_FE3(qk43dlfem,DisableNone,2);
+
+    return success ? 0 : 1;
+  }
+  catch (const Dune::Exception& e)
+  {
+    std::cerr << e << std::endl;
+    throw;
+  }
+}
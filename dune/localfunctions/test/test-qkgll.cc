@@ -0,0 +1,181 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+#include <dune/common/fvector.hh>
+
+#include <dune/geometry/quadraturerules.hh>
+#include <dune/geometry/type.hh>
+
+#include <dune/localfunctions/lagrange/qkgll.hh>
+
+#include "test-localfe.hh"
+
+// The monomial prod_j x_j^p
+template<int dim>
+struct Monomial
+{
+  int p;
+
+  template<class X, class Y>
+  void evaluate (const X& x, Y& y) const
+  {
+    y = 1;
+    for (int j=0; j<dim; j++)
+      y *= std::pow(x[j], p);
+  }
+};
+
+// Check that the points of the quadrature rule are the nodes of the shape
+// functions, that the rule has the expected order, and that its weights
+// are the row sums of the exact mass matrix
+template<int k, int dim>
+bool testCollocation()
+{
+  typedef Dune::QkGLLLocalFiniteElement<double,double,dim,k> FE;
+  typedef typename FE::Traits::LocalBasisType::Traits::RangeType RangeType;
+
+  FE fe;
+  const auto& basis = fe.localBasis();
+  const auto& rule = FE::quadratureRule();
+
+  bool success = true;
+  if (rule.size() != fe.size() or rule.order() != 2*k-1)
+  {
+    std::cout << "Gauss-Lobatto rule of Q" << k << " in " << dim << "d has " << rule.size()
+              << " points and order " << rule.order() << std::endl;
+    return false;
+  }
+
+  // the shape functions are nodal in the quadrature points
+  std::vector<RangeType> values;
+  for (std::size_t q=0; q<rule.size(); q++)
+  {
+    basis.evaluateFunction(rule[q].position(), values);
+    for (std::size_t i=0; i<basis.size(); i++)
+      if (std::abs(values[i][0] - double(i == q)) > TOL)
+      {
+        std::cout << "Q" << k << " GLL in " << dim << "d: shape function " << i
+                  << " at quadrature point " << q << " is " << values[i][0] << std::endl;
+        success = false;
+      }
+  }
+
+  // the rule integrates prod_j x_j^(2k-1) exactly
+  double integral = 0;
+  for (const auto& qp : rule)
+  {
+    double y;
+    Monomial<dim>{2*k-1}.evaluate(qp.position(), y);
+    integral += qp.weight() * y;
+  }
+  if (std::abs(integral - std::pow(1.0/(2*k), dim)) > TOL)
+  {
+    std::cout << "Gauss-Lobatto rule of Q" << k << " in " << dim << "d is not of order " << 2*k-1 << std::endl;
+    success = false;
+  }
+
+  // the weights are the integrals of the shape functions, i.e., the rule
+  // lumps the exact mass matrix into its diagonal
+  std::vector<double> integrals(basis.size(), 0.0);
+  for (const auto& qp : Dune::QuadratureRules<double,dim>::rule(fe.type(), k))
+  {
+    basis.evaluateFunction(qp.position(), values);
+    for (std::size_t i=0; i<basis.size(); i++)
+      integrals[i] += qp.weight() * values[i][0];
+  }
+  for (std::size_t i=0; i<basis.size(); i++)
+    if (std::abs(integrals[i] - rule[i].weight()) > TOL)
+    {
+      std::cout << "Q" << k << " GLL in " << dim << "d: integral of shape function " << i << " is "
+                << integrals[i] << " instead of " << rule[i].weight() << std::endl;
+      success = false;
+    }
+
+  // interpolation from the values at the quadrature points needs no evaluation
+  std::vector<RangeType> nodalValues(rule.size());
+  for (std::size_t q=0; q<rule.size(); q++)
+    Monomial<dim>{k}.evaluate(rule[q].position(), nodalValues[q]);
+  std::vector<double> coefficients, nodalCoefficients;
+  fe.localInterpolation().interpolate(Monomial<dim>{k}, coefficients);
+  fe.localInterpolation().interpolateNodalValues(nodalValues, nodalCoefficients);
+  for (std::size_t i=0; i<basis.size(); i++)
+    if (coefficients[i] != nodalCoefficients[i])
+    {
+      std::cout << "Q" << k << " GLL in " << dim << "d: coefficient " << i
+                << " differs for the interpolation of nodal values" << std::endl;
+      success = false;
+    }
+
+  return success;
+}
+
+// With a range field different from the coordinate type the points of the
+// quadrature rule are still exactly the nodes of the shape functions
+template<class D, class R, int k, int dim>
+bool testMixedFields()
+{
+  typedef Dune::QkGLLLocalFiniteElement<D,R,dim,k> FE;
+  typedef typename FE::Traits::LocalBasisType::Traits::RangeType RangeType;
+
+  FE fe;
+  const auto& rule = FE::quadratureRule();
+
+  bool success = true;
+  std::vector<RangeType> values;
+  for (std::size_t q=0; q<rule.size(); q++)
+  {
+    fe.localBasis().evaluateFunction(rule[q].position(), values);
+    for (std::size_t i=0; i<values.size(); i++)
+      if ((i != q and values[i][0] != R(0)) or (i == q and std::abs(values[i][0] - R(1)) > 1e-5))
+      {
+        std::cout << "Q" << k << " GLL in " << dim << "d with mixed fields: shape function " << i
+                  << " at quadrature point " << q << " is " << values[i][0] << std::endl;
+        success = false;
+      }
+  }
+  return success;
+}
+
+int main(int argc, char** argv)
+{
+  try
+  {
+    bool success = true;
+
+    success = testCollocation<1,1>() and success;
+    success = testCollocation<4,1>() and success;
+    success = testCollocation<16,1>() and success;
+    success = testCollocation<1,2>() and success;
+    success = testCollocation<3,2>() and success;
+    success = testCollocation<8,2>() and success;
+    success = testCollocation<2,3>() and success;
+    success = testCollocation<5,3>() and success;
+    success = testMixedFields<double,float,7,1>() and success;
+    success = testMixedFields<double,float,4,2>() and success;
+
+    Dune::QkGLLLocalFiniteElement<double,double,1,6> qkgll61dlfem;
+    TEST_FE(qkgll61dlfem);
+
+    Dune::QkGLLLocalFiniteElement<double,double,2,5> qkgll52dlfem;
+    TEST_FE(qkgll52dlfem);
+
+    Dune::QkGLLLocalFiniteElement<double,double,3,4> qkgll43dlfem;
+    TEST_FE3(qkgll43dlfem,DisableNone,2);
+
+    return success ? 0 : 1;
+  }
+  catch (const Dune::Exception& e)
+  {
+    std::cerr << e << std::endl;
+    throw;
+  }
+}
@@ -0,0 +1,209 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+#include <dune/common/fvector.hh>
+
+#include <dune/geometry/quadraturerules.hh>
+#include <dune/geometry/type.hh>
+
+#include <dune/localfunctions/lagrange/qk/qklocalbasis.hh>
+#include <dune/localfunctions/lagrange/qk/qksumfactorization.hh>
+#include <dune/localfunctions/lagrange/qkgll/qkglllocalbasis.hh>
+#include <dune/localfunctions/lagrange/qkgll/qkgllquadrature.hh>
+
+/**
+ * \file
+ * \brief Compares the sum-factorized kernels of QkSumFactorization with the
+ *        matrices of shape function values and gradients at the quadrature
+ *        points.
+ */
+
+double TOL = 1e-11;
+
+// Two elements at once, standing in for a SIMD vector type
+struct Pair
+{
+  std::array<double,2> v;
+
+  Pair (double s = 0) : v{{s, s}} {}
+
+  Pair& operator+= (const Pair& o) { v[0] += o.v[0]; v[1] += o.v[1]; return *this; }
+  friend Pair operator* (double a, const Pair& b) { Pair r; r.v[0] = a*b.v[0]; r.v[1] = a*b.v[1]; return r; }
+};
+
+namespace Dune
+{
+  template<>
+  struct IsNumber<Pair> : public std::true_type {};
+}
+
+// A coefficient in [-1,1]
+double coefficient (std::size_t i, int seed)
+{
+  return std::sin(1.7*i + 0.3*seed);
+}
+
+template<int k, int d, class Basis, class Kernel>
+bool testKernel (const Basis& basis, const Kernel& kernel, const std::string& name)
+{
+  typedef typename Basis::Traits Traits;
+  const auto& rule = kernel.quadratureRule();
+  const std::size_t n = kernel.numPoints();
+  const std::size_t size = basis.size();
+  bool success = true;
+
+  std::vector<double> u(size), w(n);
+  std::vector<Dune::FieldVector<double,d> > g(n);
+  for (std::size_t i=0; i<size; i++)
+    u[i] = coefficient(i, 0);
+  for (std::size_t p=0; p<n; p++)
+  {
+    w[p] = coefficient(p, 1);
+    for (int j=0; j<d; j++)
+      g[p][j] = coefficient(p, 2+j);
+  }
+
+  std::vector<double> values, valuesOnly, integrated, integratedValues;
+  std::vector<Dune::FieldVector<double,d> > gradients;
+  kernel.interpolateToQuadrature(u, valuesOnly);
+  kernel.interpolateToQuadrature(u, values, gradients);
+  kernel.integrateFromQuadrature(w, integratedValues);
+  kernel.integrateFromQuadrature(w, g, integrated);
+
+  // the same with the matrices
+  std::vector<double> expectedIntegrated(size, 0.0), expectedIntegratedValues(size, 0.0);
+  std::vector<typename Traits::RangeType> phi;
+  std::vector<typename Traits::JacobianType> dphi;
+  for (std::size_t p=0; p<n; p++)
+  {
+    basis.evaluateFunction(rule[p].position(), phi);
+    basis.evaluateJacobian(rule[p].position(), dphi);
+    double value = 0;
+    Dune::FieldVector<double,d> gradient(0);
+    for (std::size_t i=0; i<size; i++)
+    {
+      value += u[i] * phi[i][0];
+      gradient.axpy(u[i], dphi[i][0]);
+      expectedIntegratedValues[i] += w[p] * phi[i][0];
+      expectedIntegrated[i] += w[p] * phi[i][0] + g[p] * dphi[i][0];
+    }
+
+    if (std::abs(values[p] - value) > TOL or std::abs(valuesOnly[p] - value) > TOL
+        or (gradients[p] - gradient).infinity_norm() > TOL)
+    {
+      std::cout << name << ": interpolation to quadrature point " << p << " yields "
+                << values[p] << ", " << gradients[p] << " instead of " << value << ", " << gradient << std::endl;
+      success = false;
+    }
+  }
+
+  for (std::size_t i=0; i<size; i++)
+    if (std::abs(integrated[i] - expectedIntegrated[i]) > TOL
+        or std::abs(integratedValues[i] - expectedIntegratedValues[i]) > TOL)
+    {
+      std::cout << name << ": integration against shape function " << i << " yields "
+                << integrated[i] << " instead of " << expectedIntegrated[i] << std::endl;
+      success = false;
+    }
+
+  // two elements at once give the same results lane by lane
+  std::vector<Pair> pairs(size), pairValues, pairIntegrated;
+  std::vector<Dune::FieldVector<Pair,d> > pairGradients;
+  for (std::size_t i=0; i<size; i++)
+  {
+    pairs[i].v[0] = u[i];
+    pairs[i].v[1] = coefficient(i, 7);
+  }
+  kernel.interpolateToQuadrature(pairs, pairValues, pairGradients);
+  kernel.integrateFromQuadrature(pairValues, pairGradients, pairIntegrated);
+
+  std::vector<double> second(size), secondValues, secondIntegrated;
+  std::vector<Dune::FieldVector<double,d> > secondGradients;
+  for (std::size_t i=0; i<size; i++)
+    second[i] = coefficient(i, 7);
+  kernel.interpolateToQuadrature(second, secondValues, secondGradients);
+  kernel.integrateFromQuadrature(secondValues, secondGradients, secondIntegrated);
+
+  std::vector<double> firstIntegrated;
+  kernel.integrateFromQuadrature(values, gradients, firstIntegrated);
+
+  for (std::size_t i=0; i<size; i++)
+    if (std::abs(pairIntegrated[i].v[0] - firstIntegrated[i]) > TOL
+        or std::abs(pairIntegrated[i].v[1] - secondIntegrated[i]) > TOL)
+    {
+      std::cout << name << ": lanes differ for shape function " << i << std::endl;
+      success = false;
+    }
+
+  return success;
+}
+
+template<int k, int d>
+bool testGauss (int order)
+{
+  Dune::QkLocalBasis<double,double,k,d> basis;
+  Dune::QkSumFactorization<double,double,k,d> kernel(order);
+  return testKernel<k,d>(basis, kernel, "Q" + std::to_string(k) + " in " + std::to_string(d) + "d, order " + std::to_string(order));
+}
+
+// On the Gauss-Lobatto points the interpolation is the identity
+template<int k, int d>
+bool testGaussLobatto ()
+{
+  Dune::QkGLLLocalBasis<double,double,k,d> basis;
+  const Dune::QkGLLQuadratureRule<double,1> rule1d(k);
+  Dune::QkSumFactorization<double,double,k,d,Dune::Impl::QkGaussLobattoNodes> kernel(rule1d);
+  bool success = testKernel<k,d>(basis, kernel, "Q" + std::to_string(k) + " GLL in " + std::to_string(d) + "d");
+
+  std::vector<double> u(basis.size()), values;
+  for (std::size_t i=0; i<u.size(); i++)
+    u[i] = coefficient(i, 3);
+  kernel.interpolateToQuadrature(u, values);
+  for (std::size_t i=0; i<u.size(); i++)
+    if (std::abs(values[i] - u[i]) > TOL)
+    {
+      std::cout << "Q" << k << " GLL in " << d << "d: value " << values[i]
+                << " at node " << i << " instead of " << u[i] << std::endl;
+      success = false;
+    }
+  return success;
+}
+
+int main(int argc, char** argv)
+{
+  try
+  {
+    bool success = true;
+
+    success = testGauss<0,2>(1) and success;
+    success = testGauss<1,1>(3) and success;
+    success = testGauss<3,1>(7) and success;
+    success = testGauss<1,2>(3) and success;
+    success = testGauss<2,2>(2) and success;
+    success = testGauss<4,2>(9) and success;
+    success = testGauss<1,3>(3) and success;
+    success = testGauss<3,3>(7) and success;
+    success = testGauss<2,3>(12) and success;
+
+    success = testGaussLobatto<3,2>() and success;
+    success = testGaussLobatto<4,3>() and success;
+
+    return success ? 0 : 1;
+  }
+  catch (const Dune::Exception& e)
+  {
+    std::cerr << e << std::endl;
+    throw;
+  }
+}
@@ -0,0 +1,226 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+
+#include <dune/geometry/quadraturerules.hh>
+#include <dune/geometry/type.hh>
+
+#include <dune/localfunctions/common/tabulationcache.hh>
+#include <dune/localfunctions/common/virtualwrappers.hh>
+#include <dune/localfunctions/lagrange/pk.hh>
+#include <dune/localfunctions/lagrange/qk.hh>
+
+double TOL = 1e-12;
+
+// Compare a tabulation with the direct evaluation of the basis
+template<class LocalBasis, class Tabulation, class Rule>
+bool checkTabulation (const LocalBasis& basis, const Tabulation& tabulation, const Rule& rule)
+{
+  bool success = true;
+
+  if (tabulation.size() != basis.size() or tabulation.numPoints() != rule.size())
+  {
+    std::cout << "Tabulation has wrong size" << std::endl;
+    return false;
+  }
+
+  std::vector<typename LocalBasis::Traits::RangeType> values;
+  std::vector<typename LocalBasis::Traits::JacobianType> jacobians;
+  for (std::size_t p=0; p<rule.size(); p++)
+  {
+    basis.evaluateFunction(rule[p].position(), values);
+    basis.evaluateJacobian(rule[p].position(), jacobians);
+    for (std::size_t i=0; i<basis.size(); i++)
+    {
+      if (std::abs(values[i][0] - tabulation.value(p,i)[0]) > TOL)
+      {
+        std::cout << "Tabulated value of shape function " << i << " at point " << p << " is wrong" << std::endl;
+        success = false;
+      }
+      if (tabulation.diffOrder() > 0)
+        for (int j=0; j<LocalBasis::Traits::dimDomain; j++)
+          if (std::abs(jacobians[i][0][j] - tabulation.jacobian(p,i)[0][j]) > TOL)
+          {
+            std::cout << "Tabulated derivative of shape function " << i << " at point " << p << " is wrong" << std::endl;
+            success = false;
+          }
+    }
+  }
+
+  return success;
+}
+
+int main ()
+try
+{
+  bool success = true;
+
+  typedef Dune::QkLocalFiniteElement<double,double,2,2> Q2;
+  typedef Q2::Traits::LocalBasisType::Traits Traits;
+  typedef Dune::LocalBasisTabulationCache<Traits> Cache;
+
+  Q2 q2;
+  Dune::Pk2DLocalFiniteElement<double,double,2> p2;
+  const auto& cubeRule = Dune::QuadratureRules<double,2>::rule(Dune::GeometryTypes::quadrilateral, 4);
+  const auto& simplexRule = Dune::QuadratureRules<double,2>::rule(Dune::GeometryTypes::triangle, 4);
+
+  Cache cache;
+
+  // A tabulation is computed once and then shared
+  auto t1 = cache.get(q2.localBasis(), cubeRule);
+  auto t2 = cache.get(q2.localBasis(), cubeRule);
+  success = checkTabulation(q2.localBasis(), *t1, cubeRule) and success;
+  if (t1 != t2 or cache.size() != 1)
+  {
+    std::cout << "Repeated lookup did not return the cached tabulation" << std::endl;
+    success = false;
+  }
+
+  // A lower derivative order is served by the existing entry,
+  // a higher one creates a new entry
+  if (cache.get(q2.localBasis(), cubeRule, 0) != t1)
+  {
+    std::cout << "Lookup of values only did not reuse the tabulation of the Jacobians" << std::endl;
+    success = false;
+  }
+  auto t3 = cache.get(q2.localBasis(), cubeRule, 2);
+  if (t3 == t1 or t3->diffOrder() != 2 or cache.size() != 2)
+  {
+    std::cout << "Lookup of second derivatives did not create a new tabulation" << std::endl;
+    success = false;
+  }
+  success = checkTabulation(q2.localBasis(), *t3, cubeRule) and success;
+
+  std::vector<Traits::RangeType> partials;
+  for (std::size_t p=0; p<cubeRule.size(); p++)
+  {
+    q2.localBasis().partial({{1,1}}, cubeRule[p].position(), partials);
+    for (std::size_t i=0; i<q2.size(); i++)
+      if (std::abs(partials[i][0] - t3->hessian(p,i)[0][0][1]) > TOL
+          or std::abs(partials[i][0] - t3->hessian(p,i)[0][1][0]) > TOL)
+      {
+        std::cout << "Tabulated mixed second derivative of shape function " << i << " at point " << p << " is wrong" << std::endl;
+        success = false;
+      }
+  }
+
+  // Different bases with the same traits share one cache
+  auto t4 = cache.get(p2.localBasis(), simplexRule);
+  success = checkTabulation(p2.localBasis(), *t4, simplexRule) and success;
+
+  // The virtual interface can be used as well
+  Dune::LocalFiniteElementVirtualImp<Q2> virtualQ2(q2);
+  const Dune::LocalFiniteElementVirtualInterface<Traits>& virtualFE = virtualQ2;
+  auto t5 = cache.getFromFiniteElement(virtualFE, cubeRule);
+  success = checkTabulation(virtualFE.localBasis(), *t5, cubeRule) and success;
+  if (t5 != cache.getFromFiniteElement(virtualFE, cubeRule))
+  {
+    std::cout << "Repeated lookup through the virtual interface did not return the cached tabulation" << std::endl;
+    success = false;
+  }
+
+  // The data is aligned
+  if (reinterpret_cast<std::size_t>(t1->values(0)) % Cache::Tabulation::alignment != 0)
+  {
+    std::cout << "Tabulated values are not aligned" << std::endl;
+    success = false;
+  }
+
+  // A small cache evicts old entries but keeps handed out tabulations valid
+  Cache smallCache(t1->memory());
+  auto s1 = smallCache.get(q2.localBasis(), cubeRule);
+  auto s2 = smallCache.get(p2.localBasis(), simplexRule);
+  if (smallCache.size() != 1 or smallCache.memory() > smallCache.capacity())
+  {
+    std::cout << "Cache exceeds its capacity" << std::endl;
+    success = false;
+  }
+  success = checkTabulation(q2.localBasis(), *s1, cubeRule) and success;
+  if (smallCache.get(p2.localBasis(), simplexRule) != s2)
+  {
+    std::cout << "Most recent entry was evicted" << std::endl;
+    success = false;
+  }
+
+  // A lookup marks an entry as recently used, so that it survives the
+  // eviction of an entry inserted after it.  Both insertion orders are
+  // checked, because ties are broken by the order of the keys.
+  Q2 q2a, q2b, q2c;
+  for (int swap=0; swap<2; swap++)
+  {
+    const Q2& older = swap ? q2b : q2a;
+    const Q2& newer = swap ? q2a : q2b;
+    Cache lruCache(2*t1->memory());
+    lruCache.get(older.localBasis(), cubeRule);
+    lruCache.get(newer.localBasis(), cubeRule);
+    auto hit = lruCache.get(older.localBasis(), cubeRule);
+    lruCache.get(q2c.localBasis(), cubeRule);
+    if (lruCache.size() != 2 or lruCache.get(older.localBasis(), cubeRule) != hit)
+    {
+      std::cout << "Recently used entry was evicted" << std::endl;
+      success = false;
+    }
+  }
+
+  // Concurrent lookups find the cached tabulations, and concurrent
+  // lookups in a cache too small for all entries yield correct tabulations
+  const std::size_t numThreads = 8;
+  std::vector<Q2> elements(6);
+  Cache sharedCache, tightCache(3*t1->memory());
+  std::vector<std::shared_ptr<const Cache::Tabulation> > expected;
+  for (const Q2& element : elements)
+    expected.push_back(sharedCache.get(element.localBasis(), cubeRule));
+  std::vector<char> threadSuccess(numThreads, true);
+  std::vector<std::thread> threads;
+  for (std::size_t t=0; t<numThreads; t++)
+    threads.emplace_back([&, t]()
+    {
+      for (std::size_t repeat=0; repeat<200; repeat++)
+        for (std::size_t e=0; e<elements.size(); e++)
+        {
+          const std::size_t k = (e + t + repeat) % elements.size();
+          if (sharedCache.get(elements[k].localBasis(), cubeRule) != expected[k])
+            threadSuccess[t] = false;
+          auto tabulation = tightCache.get(elements[k].localBasis(), cubeRule);
+          if (repeat % 50 == 0 and not checkTabulation(elements[k].localBasis(), *tabulation, cubeRule))
+            threadSuccess[t] = false;
+        }
+    });
+  for (auto& thread : threads)
+    thread.join();
+  for (std::size_t t=0; t<numThreads; t++)
+    if (not threadSuccess[t])
+    {
+      std::cout << "Concurrent lookup failed in thread " << t << std::endl;
+      success = false;
+    }
+  if (sharedCache.size() != elements.size() or tightCache.memory() > tightCache.capacity())
+  {
+    std::cout << "Concurrent lookups changed the number of entries or exceeded the capacity" << std::endl;
+    success = false;
+  }
+
+  cache.clear();
+  if (cache.size() != 0 or cache.memory() != 0)
+  {
+    std::cout << "clear() did not remove all entries" << std::endl;
+    success = false;
+  }
+
+  return success ? 0 : 1;
+}
+catch (const Dune::Exception& e)
+{
+  std::cerr << e << std::endl;
+  throw;
+}
@@ -49,6 +49,23 @@ int main(int argc, char** argv) try
     lagrangeCube(Dune::GeometryTypes::cube(2), order);
     TEST_FE(lagrangeCube);
   }
+  std::cout << "Testing that LagrangeLocalFiniteElement shares its basis"
+            << " between copies and elements of the same order" << std::endl;
+  {
+    typedef Dune::LagrangeLocalFiniteElement<Dune::EquidistantPointSet,2,double,double> FE;
+    FE lagrangeCube(Dune::GeometryTypes::cube(2), 3);
+    FE copy(lagrangeCube);
+    FE other(Dune::GeometryTypes::cube(2), 3);
+    FE simplex(Dune::GeometryTypes::simplex(2), 3);
+    if (&copy.localBasis() != &lagrangeCube.localBasis()
+        || &other.localBasis() != &lagrangeCube.localBasis()
+        || &other.localInterpolation() != &lagrangeCube.localInterpolation()
+        || &simplex.localBasis() == &lagrangeCube.localBasis())
+    {
+      std::cout << "Basis of LagrangeLocalFiniteElement is not shared" << std::endl;
+      success = false;
+    }
+  }
 #if HAVE_GMP
   std::cout << "Testing LagrangeLocalFiniteElement<EquidistantPointSet> on 2d"
             << " simplex elements with higher precision" << std::endl;
@@ -29,10 +29,13 @@ namespace Dune {
     MIBasisFactory;
     typedef typename MIBasisFactory::Object MIBasis;
     typedef typename Basis::CoefficientMatrix CMatrix;
-    typedef PolynomialBasis<StandardEvaluator<MIBasis>, CMatrix > PrintBasis;
+    // the sparse storage adds up only the nonzero terms
+    typedef SparseCoeffMatrix<typename CMatrix::Field, CMatrix::blockSize> PrintMatrix;
+    typedef PolynomialBasisWithMatrix<StandardEvaluator<MIBasis>, PrintMatrix > PrintBasis;
 
     MIBasis *miBasis = MIBasisFactory::create( Dune::GeometryType( basis.basis().topologyId(),dimension ),basis.basis().order());
-    PrintBasis printBasis(*miBasis,basis.matrix(),basis.size());
+    PrintBasis printBasis(*miBasis);
+    printBasis.fill(CoeffMatrixRows<CMatrix>(basis.matrix()),basis.size());
 
     unsigned int size = printBasis.size();
 
@@ -2,13 +2,29 @@
 // vi: set et ts=4 sw=2 sts=2:
 #ifndef DUNE_COEFFMATRIX_HH
 #define DUNE_COEFFMATRIX_HH
+#include <algorithm>
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
 #include <iostream>
+#include <memory>
+#include <type_traits>
 #include <vector>
+#include <dune/common/alignedallocator.hh>
 #include <dune/common/fvector.hh>
 #include <dune/localfunctions/utility/field.hh>
 #include <dune/localfunctions/utility/tensor.hh>
 
+#if DUNE_LOCALFUNCTIONS_HAVE_BLAS
+extern "C"
+{
+  // matrix-matrix product from BLAS
+  void dgemm_ ( const char *transa, const char *transb, const int *m, const int *n, const int *k,
+                const double *alpha, const double *a, const int *lda, const double *b, const int *ldb,
+                const double *beta, double *c, const int *ldc );
+}
+#endif // #if DUNE_LOCALFUNCTIONS_HAVE_BLAS
+
 namespace Dune
 {
   /*************************************************
@@ -72,6 +88,11 @@ namespace Dune
     {
       return numCols_;
     }
+    //! number of stored nonzero entries
+    unsigned int nonZeros () const
+    {
+      return (numRows_ > 0 ? rows_[ numRows_ ]-rows_[ 0 ] : 0);
+    }
 
     template< class BasisIterator, class FF>
     void mult ( const BasisIterator &x,
@@ -232,7 +253,143 @@ namespace Dune
         b[j] += field_cast<typename Vector::value_type>( (*pos)*a );  // field_cast
       }
     }
+
+    /** \brief Multiply the first numRows rows with a table: y = C x
+     *
+     * The table x holds baseSize() rows of n entries, y receives numRows
+     * rows of n entries, both stored row by row.  This is used to evaluate
+     * a basis at many points at once, see PolynomialBasis.
+     */
+    template< class XField, class YField >
+    void multTable ( const XField *x, std::size_t n, unsigned int numRows, YField *y ) const
+    {
+      assert( numRows <= numRows_ );
+      const std::size_t numBlocks = n / columnBlock;
+      for( std::size_t b = 0; b < numBlocks; ++b )
+        multTableBlock< columnBlock >( x, n, b*columnBlock, numRows, y );
+      for( std::size_t c = numBlocks*columnBlock; c < n; ++c )
+        multTableBlock< 1 >( x, n, c, numRows, y );
+    }
+
+    /** \brief Write the matrix in a binary format
+     *
+     * The numbers of rows, columns and nonzero entries are followed by the
+     * row offsets, the skip array and the nonzero entries, which are
+     * written bytewise.  Hence this requires a trivially copyable Field and
+     * the result can only be read on the same platform.
+     */
+    void save ( std::ostream &out ) const
+    {
+      static_assert( std::is_trivially_copyable< Field >::value,
+                     "SparseCoeffMatrix::save requires a trivially copyable field" );
+      const std::uint32_t numEntries = (numRows_ > 0 ? rows_[ numRows_ ]-rows_[ 0 ] : 0);
+      write( out, std::uint32_t( numRows_ ) );
+      write( out, std::uint32_t( numCols_ ) );
+      write( out, numEntries );
+      for( unsigned int r = 0; r <= numRows_ && numRows_ > 0; ++r )
+        write( out, std::uint32_t( rows_[ r ]-rows_[ 0 ] ) );
+      for( unsigned int i = 0; i < numEntries; ++i )
+        write( out, std::uint32_t( skip_[ i ] ) );
+      for( unsigned int i = 0; i < numEntries; ++i )
+        write( out, coeff_[ i ] );
+    }
+
+    /** \brief Read a matrix written by save()
+     *
+     * \returns false, if the data is inconsistent.  The matrix is not
+     *          changed in this case.
+     */
+    bool load ( std::istream &in )
+    {
+      static_assert( std::is_trivially_copyable< Field >::value,
+                     "SparseCoeffMatrix::load requires a trivially copyable field" );
+      std::uint32_t numRows, numCols, numEntries;
+      if( !read( in, numRows ) || !read( in, numCols ) || !read( in, numEntries ) )
+        return false;
+      if( numRows == 0 )
+        return false;
+
+      std::vector< std::uint32_t > offsets( numRows+1 ), skip( numEntries );
+      std::vector< Field > coeff( numEntries );
+      for( std::uint32_t &o : offsets )
+        if( !read( in, o ) )
+          return false;
+      for( std::uint32_t &s : skip )
+        if( !read( in, s ) )
+          return false;
+      for( Field &c : coeff )
+        if( !read( in, c ) )
+          return false;
+      if( offsets[ 0 ] != 0 || offsets[ numRows ] != numEntries )
+        return false;
+      for( std::uint32_t r = 0; r < numRows; ++r )
+      {
+        if( offsets[ r ] > offsets[ r+1 ] )
+          return false;
+        // the skips within a row sum up to the column of the last entry
+        std::uint64_t col = 0;
+        for( std::uint32_t i = offsets[ r ]; i < offsets[ r+1 ]; ++i )
+          col += skip[ i ];
+        if( offsets[ r ] != offsets[ r+1 ] && col >= numCols )
+          return false;
+      }
+
+      delete [] coeff_;
+      delete [] rows_;
+      delete [] skip_;
+      numRows_ = numRows;
+      numCols_ = numCols;
+      coeff_ = new Field[ numEntries ];
+      skip_ = new unsigned int[ numEntries ];
+      rows_ = new Field*[ numRows_+1 ];
+      std::copy( coeff.begin(), coeff.end(), coeff_ );
+      std::copy( skip.begin(), skip.end(), skip_ );
+      for( unsigned int r = 0; r <= numRows_; ++r )
+        rows_[ r ] = coeff_ + offsets[ r ];
+      return true;
+    }
+
   private:
+    // number of table columns computed together in multTable()
+    static const std::size_t columnBlock = 8;
+
+    // computes the columns [c,c+width) of the first numRows rows of y
+    template< std::size_t width, class XField, class YField >
+    void multTableBlock ( const XField *x, std::size_t n, std::size_t c, unsigned int numRows, YField *y ) const
+    {
+      const unsigned int *skipIt = skip_;
+      const Field *pos = rows_[ 0 ];
+      for( unsigned int row = 0; row < numRows; ++row )
+      {
+        YField sum[ width ];
+        for( std::size_t l = 0; l < width; ++l )
+          sum[ l ] = YField( 0 );
+        std::size_t j = 0;
+        for( ; pos != rows_[ row+1 ]; ++pos, ++skipIt )
+        {
+          j += *skipIt;
+          const YField a = field_cast<YField>( *pos );
+          const XField *xj = x + j*n + c;
+          for( std::size_t l = 0; l < width; ++l )
+            sum[ l ] += a * xj[ l ];
+        }
+        YField *yr = y + std::size_t(row)*n + c;
+        for( std::size_t l = 0; l < width; ++l )
+          yr[ l ] = sum[ l ];
+      }
+    }
+
+    template< class T >
+    static void write ( std::ostream &out, const T &value )
+    {
+      out.write( reinterpret_cast< const char * >( &value ), sizeof( T ) );
+    }
+    template< class T >
+    static bool read ( std::istream &in, T &value )
+    {
+      return bool( in.read( reinterpret_cast< char * >( &value ), sizeof( T ) ) );
+    }
+
     SparseCoeffMatrix ( const This &other )
       : numRows_( other.numRows_ ),
         numCols_( other.numCols_ )
@@ -257,6 +414,489 @@ namespace Dune
     unsigned int numRows_,numCols_;
   };
 
+
+  /*************************************************
+  * The rows of a coefficient matrix, as input for
+  * the fill() method of another coefficient matrix,
+  * e.g., to change the storage.
+  *************************************************/
+  template< class CoeffMatrix >
+  struct CoeffMatrixRows
+  {
+    typedef typename CoeffMatrix::Field Field;
+
+    explicit CoeffMatrixRows ( const CoeffMatrix &matrix ) : matrix_( matrix ) {}
+
+    unsigned int rows () const { return matrix_.size()*CoeffMatrix::blockSize; }
+    unsigned int cols () const { return matrix_.baseSize(); }
+
+    template< class Vector >
+    void row ( unsigned int r, Vector &vec ) const
+    {
+      std::fill( vec.begin(), vec.end(), Field(Zero<Field>()) );
+      matrix_.addRow( r, Field(Unity<Field>()), vec );
+    }
+
+  private:
+    const CoeffMatrix &matrix_;
+  };
+
+
+
+  /*************************************************
+  * Dense alternative to the SparseCoeffMatrix. The
+  * coefficients are stored row by row in aligned
+  * memory, each row padded to a multiple of the
+  * alignment. The products are computed for blocks
+  * of rowBlock rows at once, such that each monomial
+  * is loaded only once per block and the inner loops
+  * run over contiguous data without indirection.
+  * This is faster than the sparse storage for the
+  * almost dense matrices of higher order bases.
+  *************************************************/
+  template< class F , unsigned int bSize >
+  class DenseCoeffMatrix
+  {
+  public:
+    typedef F Field;
+    static const unsigned int blockSize = bSize;
+    typedef DenseCoeffMatrix<Field,blockSize> This;
+
+    //! number of rows evaluated together
+    static const unsigned int rowBlock = 4;
+    //! alignment of the rows in bytes
+    static const std::size_t alignment = 64;
+    //! number of table columns computed together in multTable()
+    static const std::size_t columnBlock = 8;
+
+    DenseCoeffMatrix()
+      : numRows_(0),
+        numCols_(0),
+        stride_(0)
+    {}
+
+    unsigned int size () const
+    {
+      return numRows_/blockSize;
+    }
+    unsigned int baseSize () const
+    {
+      return numCols_;
+    }
+
+    template< class BasisIterator, class FF>
+    void mult ( const BasisIterator &x,
+                unsigned int numLsg,
+                FF *y ) const
+    {
+      typedef typename BasisIterator::Derivatives XDerivatives;
+      assert( numLsg*blockSize <= (size_t)numRows_ );
+      multRows( x, numLsg*blockSize, [ y ] ( unsigned int row, const XDerivatives &val ) {
+          DerivativeAssign<XDerivatives,FF>::apply(row%blockSize,val,*(y+(row/blockSize)*XDerivatives::size*blockSize));
+        } );
+    }
+    template< class BasisIterator, class Vector>
+    void mult ( const BasisIterator &x,
+                Vector &y ) const
+    {
+      typedef typename Vector::value_type YDerivatives;
+      typedef typename BasisIterator::Derivatives XDerivatives;
+      assert( y.size()*blockSize <= (size_t)numRows_ );
+      multRows( x, y.size()*blockSize, [ &y ] ( unsigned int row, const XDerivatives &val ) {
+          DerivativeAssign<XDerivatives,YDerivatives>::apply(row%blockSize,val,y[row/blockSize]);
+        } );
+    }
+    template <unsigned int deriv, class BasisIterator, class Vector>
+    void mult ( const BasisIterator &x,
+                Vector &y ) const
+    {
+      typedef typename Vector::value_type YDerivatives;
+      typedef typename BasisIterator::Derivatives XDerivatives;
+      typedef typename XDerivatives::Field XField;
+      typedef FieldVector<XField,YDerivatives::dimension> XLFETensor;
+      assert( y.size()*blockSize <= (size_t)numRows_ );
+      // the rows arrive in order, so the blockSize rows of one function
+      // are accumulated in val before it is stored
+      XLFETensor val(XField(0));
+      multRows( x, y.size()*blockSize, [ &y, &val ] ( unsigned int row, const XDerivatives &rowVal ) {
+          LFETensorAxpy<XDerivatives,XLFETensor,deriv>::apply(row%blockSize,Field(Unity<Field>()),rowVal,val);
+          if( row%blockSize == blockSize-1 )
+          {
+            field_cast(val,y[row/blockSize]);
+            val = XField(0);
+          }
+        } );
+    }
+
+    template< class RowMatrix >
+    void fill ( const RowMatrix &mat, bool verbose=false )
+    {
+      numRows_ = mat.rows();
+      numCols_ = mat.cols();
+      stride_ = paddedSize( numCols_ );
+
+      coeff_.assign( std::size_t(numRows_)*stride_, Field(Zero<Field>()) );
+      std::vector<Field> row( numCols_ );
+      for( unsigned int r = 0; r < numRows_; ++r )
+      {
+        mat.row( r, row );
+        std::copy( row.begin(), row.end(), coeff_.begin() + std::size_t(r)*stride_ );
+      }
+
+      if (verbose)
+        std::cout << "Entries: " << numCols_*numRows_
+                  << " full: " << numCols_*numRows_
+                  << std::endl;
+    }
+    // b += a*C[k]
+    template <class Vector>
+    void addRow( unsigned int k, const Field &a, Vector &b) const
+    {
+      assert(k<numRows_);
+      assert(numCols_ <= b.size());
+      const Field *pos = coeff_.data() + std::size_t(k)*stride_;
+      for( unsigned int j = 0; j < numCols_; ++j )
+        b[j] += field_cast<typename Vector::value_type>( pos[j]*a );  // field_cast
+    }
+
+    /** \brief Multiply the first numRows rows with a table: y = C x
+     *
+     * See SparseCoeffMatrix::multTable().  The product is computed in
+     * blocks of rowBlock rows and columnBlock columns of y, which are
+     * summed up in local variables and written only once.
+     * If dune-localfunctions has been configured with
+     * DUNE_LOCALFUNCTIONS_USE_BLAS and a BLAS library is found, dgemm is
+     * used for double.
+     */
+    template< class XField, class YField >
+    void multTable ( const XField *x, std::size_t n, unsigned int numRows, YField *y ) const
+    {
+      assert( numRows <= numRows_ );
+#if DUNE_LOCALFUNCTIONS_HAVE_BLAS
+      const bool useBlas = std::is_same< Field, double >::value && std::is_same< XField, double >::value && std::is_same< YField, double >::value;
+#else
+      const bool useBlas = false;
+#endif
+      multTable( x, n, numRows, y, std::integral_constant< bool, useBlas >() );
+    }
+
+    /** \brief Write the matrix in a binary format
+     *
+     * The numbers of rows and columns are followed by the entries row by
+     * row, without the padding.  As for the SparseCoeffMatrix this
+     * requires a trivially copyable Field.
+     */
+    void save ( std::ostream &out ) const
+    {
+      static_assert( std::is_trivially_copyable< Field >::value,
+                     "DenseCoeffMatrix::save requires a trivially copyable field" );
+      const std::uint32_t numRows = numRows_, numCols = numCols_;
+      out.write( reinterpret_cast< const char * >( &numRows ), sizeof( numRows ) );
+      out.write( reinterpret_cast< const char * >( &numCols ), sizeof( numCols ) );
+      for( unsigned int r = 0; r < numRows_; ++r )
+        out.write( reinterpret_cast< const char * >( coeff_.data() + std::size_t(r)*stride_ ), numCols_*sizeof( Field ) );
+    }
+
+    /** \brief Read a matrix written by save()
+     *
+     * \returns false, if the data is incomplete.  The matrix is not
+     *          changed in this case.
+     */
+    bool load ( std::istream &in )
+    {
+      static_assert( std::is_trivially_copyable< Field >::value,
+                     "DenseCoeffMatrix::load requires a trivially copyable field" );
+      std::uint32_t numRows, numCols;
+      if( !in.read( reinterpret_cast< char * >( &numRows ), sizeof( numRows ) )
+          || !in.read( reinterpret_cast< char * >( &numCols ), sizeof( numCols ) )
+          || numRows == 0 )
+        return false;
+      const unsigned int stride = paddedSize( numCols );
+      Storage coeff( std::size_t(numRows)*stride, Field(Zero<Field>()) );
+      for( unsigned int r = 0; r < numRows; ++r )
+        if( !in.read( reinterpret_cast< char * >( coeff.data() + std::size_t(r)*stride ), numCols*sizeof( Field ) ) )
+          return false;
+
+      numRows_ = numRows;
+      numCols_ = numCols;
+      stride_ = stride;
+      coeff_.swap( coeff );
+      return true;
+    }
+
+  private:
+    typedef std::vector< Field, AlignedAllocator< Field, alignment > > Storage;
+
+    // the number of columns rounded up to a multiple of the alignment
+    static unsigned int paddedSize ( unsigned int numCols )
+    {
+      const unsigned int padding = std::max< std::size_t >( alignment/sizeof(Field), 1 );
+      return (numCols + padding-1)/padding*padding;
+    }
+
+    // computes the products of the rows [0,numRows) with the monomials
+    // x and passes them to assign( row, value ) in increasing row order
+    template< class BasisIterator, class Assign >
+    void multRows ( const BasisIterator &x, unsigned int numRows, Assign assign ) const
+    {
+      typedef typename BasisIterator::Derivatives XDerivatives;
+      XDerivatives val[ rowBlock ];
+      unsigned int row = 0;
+      for( ; row+rowBlock <= numRows; row += rowBlock )
+      {
+        const Field *pos = coeff_.data() + std::size_t(row)*stride_;
+        for( unsigned int k = 0; k < rowBlock; ++k )
+          val[ k ] = 0;
+        BasisIterator itx = x;
+        for( unsigned int j = 0; j < numCols_; ++j, ++itx )
+        {
+          const XDerivatives &xj = *itx;
+          for( unsigned int k = 0; k < rowBlock; ++k )
+            val[ k ].axpy( pos[ k*stride_+j ], xj );
+        }
+        for( unsigned int k = 0; k < rowBlock; ++k )
+          assign( row+k, val[ k ] );
+      }
+      for( ; row < numRows; ++row )
+      {
+        const Field *pos = coeff_.data() + std::size_t(row)*stride_;
+        val[ 0 ] = 0;
+        BasisIterator itx = x;
+        for( unsigned int j = 0; j < numCols_; ++j, ++itx )
+          val[ 0 ].axpy( pos[ j ], *itx );
+        assign( row, val[ 0 ] );
+      }
+    }
+
+    template< class XField, class YField >
+    void multTable ( const XField *x, std::size_t n, unsigned int numRows, YField *y, std::false_type ) const
+    {
+      const std::size_t numBlocks = n / columnBlock;
+      for( std::size_t b = 0; b < numBlocks; ++b )
+        multTableBlocks< columnBlock >( x, n, b*columnBlock, numRows, y );
+      for( std::size_t c = numBlocks*columnBlock; c < n; ++c )
+        multTableBlocks< 1 >( x, n, c, numRows, y );
+    }
+
+    // computes the columns [c,c+width) of y
+    template< std::size_t width, class XField, class YField >
+    void multTableBlocks ( const XField *x, std::size_t n, std::size_t c, unsigned int numRows, YField *y ) const
+    {
+      unsigned int row = 0;
+      for( ; row+rowBlock <= numRows; row += rowBlock )
+        multTableBlock< rowBlock, width >( x, n, c, row, y );
+      for( ; row < numRows; ++row )
+        multTableBlock< 1, width >( x, n, c, row, y );
+    }
+
+    // computes the block of rows [row,row+rows) and columns [c,c+width)
+    // of y, which is kept in local variables during the summation
+    template< unsigned int rows, std::size_t width, class XField, class YField >
+    void multTableBlock ( const XField *x, std::size_t n, std::size_t c, unsigned int row, YField *y ) const
+    {
+      const Field *pos = coeff_.data() + std::size_t(row)*stride_;
+      YField sum[ rows ][ width ];
+      for( unsigned int k = 0; k < rows; ++k )
+        for( std::size_t l = 0; l < width; ++l )
+          sum[ k ][ l ] = YField( 0 );
+      for( unsigned int j = 0; j < numCols_; ++j )
+      {
+        const XField *xj = x + std::size_t(j)*n + c;
+        for( unsigned int k = 0; k < rows; ++k )
+        {
+          const YField a = field_cast<YField>( pos[ k*stride_+j ] );
+          for( std::size_t l = 0; l < width; ++l )
+            sum[ k ][ l ] += a * xj[ l ];
+        }
+      }
+      for( unsigned int k = 0; k < rows; ++k )
+      {
+        YField *yr = y + std::size_t(row+k)*n + c;
+        for( std::size_t l = 0; l < width; ++l )
+          yr[ l ] = sum[ k ][ l ];
+      }
+    }
+
+#if DUNE_LOCALFUNCTIONS_HAVE_BLAS
+    // all matrices are stored row by row, i.e., column major transposed,
+    // so y^T = x^T C^T is computed
+    void multTable ( const double *x, std::size_t n, unsigned int numRows, double *y, std::true_type ) const
+    {
+      const char trans = 'N';
+      const int m = n, k = numCols_, rows = numRows, ldc = stride_;
+      const double one = 1.0, zero = 0.0;
+      dgemm_( &trans, &trans, &m, &rows, &k, &one, x, &m, coeff_.data(), &ldc, &zero, y, &m );
+    }
+#endif // #if DUNE_LOCALFUNCTIONS_HAVE_BLAS
+
+    DenseCoeffMatrix ( const This &other );
+    This &operator= (const This&);
+
+    Storage coeff_;
+    unsigned int numRows_,numCols_,stride_;
+  };
+
+
+
+  /*************************************************
+  * Coefficient matrix choosing between sparse and
+  * dense storage. fill() first builds a
+  * SparseCoeffMatrix and switches to a
+  * DenseCoeffMatrix, if the fraction of nonzero
+  * entries is at least denseFillRatio(). This is
+  * the coefficient matrix of the generic bases
+  * created by the DefaultBasisFactory.
+  *************************************************/
+  template< class F , unsigned int bSize >
+  class AdaptiveCoeffMatrix
+  {
+  public:
+    typedef F Field;
+    static const unsigned int blockSize = bSize;
+    typedef AdaptiveCoeffMatrix<Field,blockSize> This;
+    typedef SparseCoeffMatrix<Field,blockSize> Sparse;
+    typedef DenseCoeffMatrix<Field,blockSize> Dense;
+
+    /** \brief fill ratio from which on the coefficients are stored dense
+     *
+     * For the Lagrange and orthonormal bases up to dimension 3 the dense
+     * evaluation was measured to be faster from about this ratio on.
+     */
+    static double denseFillRatio ()
+    {
+      return 0.6;
+    }
+
+    AdaptiveCoeffMatrix()
+      : sparse_(new Sparse())
+    {}
+
+    //! true if the coefficients are stored in a DenseCoeffMatrix
+    bool isDense () const
+    {
+      return bool(dense_);
+    }
+
+    unsigned int size () const
+    {
+      return (dense_ ? dense_->size() : sparse_->size());
+    }
+    unsigned int baseSize () const
+    {
+      return (dense_ ? dense_->baseSize() : sparse_->baseSize());
+    }
+
+    template< class BasisIterator, class FF>
+    void mult ( const BasisIterator &x,
+                unsigned int numLsg,
+                FF *y ) const
+    {
+      if( dense_ )
+        dense_->mult( x, numLsg, y );
+      else
+        sparse_->mult( x, numLsg, y );
+    }
+    template< class BasisIterator, class Vector>
+    void mult ( const BasisIterator &x,
+                Vector &y ) const
+    {
+      if( dense_ )
+        dense_->mult( x, y );
+      else
+        sparse_->mult( x, y );
+    }
+    template <unsigned int deriv, class BasisIterator, class Vector>
+    void mult ( const BasisIterator &x,
+                Vector &y ) const
+    {
+      if( dense_ )
+        dense_->template mult<deriv>( x, y );
+      else
+        sparse_->template mult<deriv>( x, y );
+    }
+
+    template< class RowMatrix >
+    void fill ( const RowMatrix &mat, bool verbose=false )
+    {
+      std::unique_ptr<Sparse> sparse(new Sparse());
+      sparse->fill( mat, verbose );
+      const double entries = double(sparse->size())*blockSize*sparse->baseSize();
+      if( entries > 0 && sparse->nonZeros() >= denseFillRatio()*entries )
+      {
+        std::unique_ptr<Dense> dense(new Dense());
+        dense->fill( CoeffMatrixRows< Sparse >( *sparse ) );
+        dense_ = std::move( dense );
+        sparse_.reset();
+      }
+      else
+      {
+        sparse_ = std::move( sparse );
+        dense_.reset();
+      }
+    }
+    // b += a*C[k]
+    template <class Vector>
+    void addRow( unsigned int k, const Field &a, Vector &b) const
+    {
+      if( dense_ )
+        dense_->addRow( k, a, b );
+      else
+        sparse_->addRow( k, a, b );
+    }
+    //! Multiply the first numRows rows with a table, see SparseCoeffMatrix::multTable()
+    template< class XField, class YField >
+    void multTable ( const XField *x, std::size_t n, unsigned int numRows, YField *y ) const
+    {
+      if( dense_ )
+        dense_->multTable( x, n, numRows, y );
+      else
+        sparse_->multTable( x, n, numRows, y );
+    }
+
+    //! Write the matrix in a binary format, see SparseCoeffMatrix::save() and DenseCoeffMatrix::save()
+    void save ( std::ostream &out ) const
+    {
+      const std::uint32_t dense = isDense();
+      out.write( reinterpret_cast< const char * >( &dense ), sizeof( dense ) );
+      if( dense_ )
+        dense_->save( out );
+      else
+        sparse_->save( out );
+    }
+
+    //! Read a matrix written by save(), returns false if the data is inconsistent
+    bool load ( std::istream &in )
+    {
+      std::uint32_t dense;
+      if( !in.read( reinterpret_cast< char * >( &dense ), sizeof( dense ) ) || dense > 1 )
+        return false;
+      if( dense )
+      {
+        std::unique_ptr<Dense> matrix(new Dense());
+        if( !matrix->load( in ) )
+          return false;
+        dense_ = std::move( matrix );
+        sparse_.reset();
+      }
+      else
+      {
+        std::unique_ptr<Sparse> matrix(new Sparse());
+        if( !matrix->load( in ) )
+          return false;
+        sparse_ = std::move( matrix );
+        dense_.reset();
+      }
+      return true;
+    }
+
+  private:
+    AdaptiveCoeffMatrix ( const This &other );
+    This &operator= (const This&);
+
+    std::unique_ptr<Sparse> sparse_;
+    std::unique_ptr<Dense> dense_;
+  };
+
 }
 
 #endif // DUNE_COEFFMATRIX_HH
@@ -0,0 +1,218 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#ifndef DUNE_COEFFMATRIXCACHE_HH
+#define DUNE_COEFFMATRIXCACHE_HH
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <typeinfo>
+
+namespace Dune
+{
+
+  /**
+   * @brief An opt-in persistent cache of coefficient matrices.
+   *
+   * The generic finite elements compute the coefficients of their basis
+   * with respect to the monomials by inverting a matrix in the compute
+   * field.  For high orders this dominates the time to create an element.
+   * If a cache directory is set, the factories store the resulting
+   * coefficient matrices there and read them back on the next creation.
+   *
+   * The cache is disabled by default.  It is enabled by calling
+   * setDirectory() before the first element is created, or by setting
+   * the environment variable DUNE_LOCALFUNCTIONS_CACHE_DIR.  The
+   * directory has to exist.
+   *
+   * Each matrix is stored in its own file, named by a hash of the factory
+   * type, the topology, the key and the storage field.  The file starts
+   * with a header containing a magic number, the format version, this
+   * description and a checksum of the data.  Files which do not match are
+   * ignored, and the matrix is recomputed and written again.  Matrices are
+   * only cached for trivially copyable storage fields, since their entries
+   * are stored bytewise.
+   */
+  struct CoeffMatrixCache
+  {
+    //! version of the file format, increase it whenever the format changes
+    static const std::uint32_t version = 2;
+
+    //! set the cache directory, an empty string disables the cache
+    static void setDirectory ( const std::string &directory )
+    {
+      std::lock_guard< std::mutex > guard( mutex() );
+      directoryRef() = directory;
+    }
+
+    //! the cache directory, empty if the cache is disabled
+    static std::string directory ()
+    {
+      std::lock_guard< std::mutex > guard( mutex() );
+      return directoryRef();
+    }
+
+    //! the file storing the coefficients for the given factory, topology, key and field
+    template< class Factory, class Topology, class Field, class Key >
+    static std::string fileName ( const Key &key )
+    {
+      const std::string dir = directory();
+      if( dir.empty() )
+        return std::string();
+      std::ostringstream name;
+      name << dir << "/coeffs-" << std::hex << std::setw( 16 ) << std::setfill( '0' )
+           << hash( description< Factory, Topology, Field >( key ) ) << ".bin";
+      return name.str();
+    }
+
+    /** \brief Read the coefficients of a basis from the cache
+     *
+     * \returns true if a valid file was found and the coefficients have been
+     *          loaded into matrix.
+     */
+    template< class Factory, class Topology, class Field, class Key, class Matrix >
+    static bool load ( const Key &key, Matrix &matrix )
+    {
+      return load< Factory, Topology, Field >( key, matrix, std::is_trivially_copyable< Field >() );
+    }
+
+    //! Write the coefficients of a basis to the cache, if it is enabled
+    template< class Factory, class Topology, class Field, class Key, class Matrix >
+    static void store ( const Key &key, const Matrix &matrix )
+    {
+      store< Factory, Topology, Field >( key, matrix, std::is_trivially_copyable< Field >() );
+    }
+
+  private:
+    static const char *magic () { return "DUNELFCM"; }
+
+    static std::mutex &mutex ()
+    {
+      static std::mutex mutex;
+      return mutex;
+    }
+
+    static std::string &directoryRef ()
+    {
+      static std::string directory = initialDirectory();
+      return directory;
+    }
+
+    static std::string initialDirectory ()
+    {
+      const char *dir = std::getenv( "DUNE_LOCALFUNCTIONS_CACHE_DIR" );
+      return (dir ? std::string( dir ) : std::string());
+    }
+
+    // 64 bit FNV-1a hash
+    static std::uint64_t hash ( const std::string &data )
+    {
+      std::uint64_t h = 14695981039346656037ull;
+      for( unsigned char c : data )
+      {
+        h ^= c;
+        h *= 1099511628211ull;
+      }
+      return h;
+    }
+
+    template< class Factory, class Topology, class Field, class Key >
+    static std::string description ( const Key &key )
+    {
+      std::ostringstream s;
+      s << typeid( Factory ).name() << ";topology=" << Topology::id
+        << ";dim=" << Topology::dimension << ";key=" << key
+        << ";field=" << typeid( Field ).name() << ";" << sizeof( Field );
+      return s.str();
+    }
+
+    template< class Factory, class Topology, class Field, class Key, class Matrix >
+    static bool load ( const Key &key, Matrix &matrix, std::true_type )
+    {
+      const std::string file = fileName< Factory, Topology, Field >( key );
+      if( file.empty() )
+        return false;
+      std::ifstream in( file, std::ios::binary );
+      if( !in )
+        return false;
+
+      std::string header;
+      if( !std::getline( in, header, '\0' ) )
+        return false;
+      std::ostringstream expected;
+      expected << magic() << ";version=" << version << ";"
+               << description< Factory, Topology, Field >( key );
+      if( header != expected.str() )
+        return false;
+
+      std::uint64_t checksum, length;
+      if( !in.read( reinterpret_cast< char * >( &checksum ), sizeof( checksum ) )
+          || !in.read( reinterpret_cast< char * >( &length ), sizeof( length ) ) )
+        return false;
+      std::string data( length, '\0' );
+      if( !in.read( &data[ 0 ], length ) || hash( data ) != checksum )
+        return false;
+
+      std::istringstream dataIn( data );
+      return matrix.load( dataIn );
+    }
+
+    template< class Factory, class Topology, class Field, class Key, class Matrix >
+    static bool load ( const Key &key, Matrix &matrix, std::false_type )
+    {
+      return false;
+    }
+
+    template< class Factory, class Topology, class Field, class Key, class Matrix >
+    static void store ( const Key &key, const Matrix &matrix, std::true_type )
+    {
+      const std::string file = fileName< Factory, Topology, Field >( key );
+      if( file.empty() )
+        return;
+
+      std::ostringstream dataOut;
+      matrix.save( dataOut );
+      const std::string data = dataOut.str();
+      const std::uint64_t checksum = hash( data );
+      const std::uint64_t length = data.size();
+
+      // write to a temporary file first and rename it, such that concurrent
+      // readers never see an incomplete file
+      std::ostringstream tmp;
+      tmp << file << ".tmp-" << std::hash< std::thread::id >()( std::this_thread::get_id() )
+          << "-" << std::chrono::steady_clock::now().time_since_epoch().count();
+      {
+        std::ofstream out( tmp.str(), std::ios::binary );
+        out << magic() << ";version=" << version << ";"
+            << description< Factory, Topology, Field >( key ) << '\0';
+        out.write( reinterpret_cast< const char * >( &checksum ), sizeof( checksum ) );
+        out.write( reinterpret_cast< const char * >( &length ), sizeof( length ) );
+        out.write( data.data(), data.size() );
+        if( !out )
+        {
+          out.close();
+          std::remove( tmp.str().c_str() );
+          return;
+        }
+      }
+      if( std::rename( tmp.str().c_str(), file.c_str() ) != 0 )
+        std::remove( tmp.str().c_str() );
+    }
+
+    template< class Factory, class Topology, class Field, class Key, class Matrix >
+    static void store ( const Key &key, const Matrix &matrix, std::false_type )
+    {}
+  };
+
+}
+
+#endif // #ifndef DUNE_COEFFMATRIXCACHE_HH
@@ -0,0 +1,111 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#ifndef DUNE_CONCURRENTREGISTRY_HH
+#define DUNE_CONCURRENTREGISTRY_HH
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include <dune/geometry/type.hh>
+
+namespace Dune
+{
+
+  /**
+   * @brief A thread-safe registry of objects created once per key.
+   *
+   * get() returns the object stored for a key and creates it on the first
+   * request.  Objects for different keys may be created concurrently,
+   * while concurrent requests for the same key wait for the first one to
+   * finish.  If the creation throws, the next request tries again.
+   * Objects are never removed, so pointers to them remain valid as long
+   * as the registry exists.
+   */
+  template< class Key, class Object >
+  class ConcurrentRegistry
+  {
+    struct Entry
+    {
+      std::once_flag once;
+      std::shared_ptr< Object > object;
+    };
+
+  public:
+    /** \brief the object for key, created by create() on the first request
+     *
+     * \param create callable returning something convertible to
+     *               std::shared_ptr< Object >
+     */
+    template< class Create >
+    std::shared_ptr< Object > get ( const Key &key, Create &&create )
+    {
+      Entry *entry;
+      {
+        std::lock_guard< std::mutex > guard( mutex_ );
+        entry = &storage_[ key ];
+      }
+      std::call_once( entry->once, [ entry, &create ] () { entry->object = create(); } );
+      return entry->object;
+    }
+
+  private:
+    std::mutex mutex_;
+    std::map< Key, Entry > storage_;
+  };
+
+
+
+  /**
+   * @brief A thread-safe replacement for TopologySingletonFactory
+   *
+   * Like TopologySingletonFactory this creates at most one object per
+   * topology and key using Factory and returns the same pointer on all
+   * later requests.  In contrast to it, the storage is a
+   * ConcurrentRegistry, so that objects may be requested and created
+   * from several threads at the same time.
+   */
+  template< class Factory >
+  struct ConcurrentTopologySingletonFactory
+  {
+    static const unsigned int dimension = Factory::dimension;
+    typedef typename Factory::Key Key;
+    typedef const typename Factory::Object Object;
+
+    static Object *create ( const GeometryType &gt, const Key &key )
+    {
+      return registry().get( std::make_pair( gt.id(), key ), [ &gt, &key ] () {
+          return std::shared_ptr< Object >( Factory::create( gt, key ), Deleter() );
+        } ).get();
+    }
+
+    template< class Topology >
+    static Object *create ( const Key &key )
+    {
+      static_assert( (Topology::dimension == dimension), "Topology with incompatible dimension used" );
+      return registry().get( std::make_pair( static_cast< unsigned int >( Topology::id ), key ), [ &key ] () {
+          return std::shared_ptr< Object >( Factory::template create< Topology >( key ), Deleter() );
+        } ).get();
+    }
+
+    static void release ( Object * ) {}
+
+  private:
+    struct Deleter
+    {
+      void operator() ( Object *object ) const { Factory::release( object ); }
+    };
+
+    typedef ConcurrentRegistry< std::pair< unsigned int, Key >, Object > Registry;
+
+    static Registry &registry ()
+    {
+      static Registry registry;
+      return registry;
+    }
+  };
+
+}
+
+#endif // #ifndef DUNE_CONCURRENTREGISTRY_HH
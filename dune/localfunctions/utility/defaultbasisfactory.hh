@@ -8,6 +8,7 @@
 #include <dune/geometry/topologyfactory.hh>
 
 #include <dune/localfunctions/utility/basismatrix.hh>
+#include <dune/localfunctions/utility/coeffmatrixcache.hh>
 
 namespace Dune
 {
@@ -53,7 +54,7 @@ namespace Dune
     typedef typename PreBasisFactory::template EvaluationBasisFactory<dim,SF>::Type MonomialBasisFactory;
     typedef typename MonomialBasisFactory::Object MonomialBasis;
     typedef StandardEvaluator< MonomialBasis > Evaluator;
-    typedef PolynomialBasisWithMatrix< Evaluator, SparseCoeffMatrix< SF, dimRange > > Basis;
+    typedef PolynomialBasisWithMatrix< Evaluator, AdaptiveCoeffMatrix< SF, dimRange > > Basis;
 
     typedef const Basis Object;
     typedef typename InterpolationFactory::Key Key;
@@ -90,20 +91,28 @@ namespace Dune
     template< class Topology >
     static Object *createObject ( const Key &key )
     {
+      typedef typename Traits::Factory Factory;
       const typename PreBasisFactory::Key preBasisKey = PreBasisKeyExtractor::apply(key);
       const typename Traits::PreBasis *preBasis = Traits::PreBasisFactory::template create<Topology>( preBasisKey );
-      const typename Traits::Interpolation *interpol = Traits::InterpolationFactory::template create<Topology>( key );
-      BasisMatrix< typename Traits::PreBasis,
-          typename Traits::Interpolation,
-          ComputeField > matrix( *preBasis, *interpol );
-
       const typename Traits::MonomialBasis *monomialBasis = Traits::MonomialBasisFactory::template create< Topology >( preBasis->order() );
 
       Basis *basis = new Basis( *monomialBasis );
 
-      basis->fill( matrix );
+      // the expensive inversion of the basis matrix can be skipped, if the
+      // coefficients are found in the cache
+      if( !CoeffMatrixCache::load< Factory, Topology, StorageField >( key, *basis ) )
+      {
+        const typename Traits::Interpolation *interpol = Traits::InterpolationFactory::template create<Topology>( key );
+        BasisMatrix< typename Traits::PreBasis,
+            typename Traits::Interpolation,
+            ComputeField > matrix( *preBasis, *interpol );
+
+        basis->fill( matrix );
+        CoeffMatrixCache::store< Factory, Topology, StorageField >( key, *basis );
+
+        Traits::InterpolationFactory::release(interpol);
+      }
 
-      Traits::InterpolationFactory::release(interpol);
       Traits::PreBasisFactory::release(preBasis);
 
       return basis;
@@ -0,0 +1,177 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#ifndef DUNE_LOCALFUNCTIONS_UTILITY_DOUBLEDOUBLEFIELD_HH
+#define DUNE_LOCALFUNCTIONS_UTILITY_DOUBLEDOUBLEFIELD_HH
+
+#include <cmath>
+#include <ostream>
+#include <type_traits>
+
+namespace Dune
+{
+
+  /**
+   * @brief A floating point number with about 106 bits of mantissa
+   *
+   * The value is represented as the unevaluated sum hi + lo of two
+   * doubles with |lo| <= ulp(hi)/2.  Arithmetic is based on the error
+   * free transformations of Dekker and Knuth, so it needs no library
+   * support and no heap allocation.  This makes it a cheap alternative
+   * to GMPField, e.g., as the ComputeField of the generic finite
+   * elements, if the accuracy of double is not sufficient.
+   *
+   * The exponent range is that of double.  Output is rounded to double.
+   */
+  class DoubleDoubleField
+  {
+    typedef DoubleDoubleField This;
+
+  public:
+    DoubleDoubleField ()
+      : hi_( 0 ), lo_( 0 )
+    {}
+
+    DoubleDoubleField ( double x )
+      : hi_( x ), lo_( 0 )
+    {}
+
+    DoubleDoubleField ( long double x )
+      : hi_( static_cast< double >( x ) ),
+        lo_( static_cast< double >( x - static_cast< long double >( hi_ ) ) )
+    {}
+
+    template< class T, std::enable_if_t< std::is_integral< T >::value, int > = 0 >
+    DoubleDoubleField ( T x )
+      : DoubleDoubleField( static_cast< long double >( x ) )
+    {}
+
+    //! the leading part of the value
+    double hi () const { return hi_; }
+    //! the trailing part of the value
+    double lo () const { return lo_; }
+
+    explicit operator double () const { return hi_; }
+    explicit operator long double () const
+    {
+      return static_cast< long double >( hi_ ) + static_cast< long double >( lo_ );
+    }
+
+    This operator- () const { return This( -hi_, -lo_ ); }
+
+    This &operator+= ( const This &other )
+    {
+      double s, e, t, f;
+      twoSum( hi_, other.hi_, s, e );
+      twoSum( lo_, other.lo_, t, f );
+      e += t;
+      quickTwoSum( s, e, s, e );
+      e += f;
+      quickTwoSum( s, e, hi_, lo_ );
+      return *this;
+    }
+
+    This &operator-= ( const This &other ) { return *this += -other; }
+
+    This &operator*= ( const This &other )
+    {
+      double p, e;
+      twoProd( hi_, other.hi_, p, e );
+      e += hi_*other.lo_ + lo_*other.hi_;
+      quickTwoSum( p, e, hi_, lo_ );
+      return *this;
+    }
+
+    This &operator/= ( const This &other )
+    {
+      // long division: q1 + q2 + q3 with remainders computed exactly
+      const double q1 = hi_ / other.hi_;
+      This r = *this - other*q1;
+      const double q2 = r.hi_ / other.hi_;
+      r -= other*q2;
+      const double q3 = r.hi_ / other.hi_;
+      quickTwoSum( q1, q2, hi_, lo_ );
+      return *this += This( q3 );
+    }
+
+    friend This operator+ ( This a, const This &b ) { return a += b; }
+    friend This operator- ( This a, const This &b ) { return a -= b; }
+    friend This operator* ( This a, const This &b ) { return a *= b; }
+    friend This operator/ ( This a, const This &b ) { return a /= b; }
+
+    friend bool operator== ( const This &a, const This &b ) { return a.hi_ == b.hi_ && a.lo_ == b.lo_; }
+    friend bool operator!= ( const This &a, const This &b ) { return !(a == b); }
+    friend bool operator< ( const This &a, const This &b ) { return a.hi_ < b.hi_ || (a.hi_ == b.hi_ && a.lo_ < b.lo_); }
+    friend bool operator> ( const This &a, const This &b ) { return b < a; }
+    friend bool operator<= ( const This &a, const This &b ) { return !(b < a); }
+    friend bool operator>= ( const This &a, const This &b ) { return !(a < b); }
+
+    friend This abs ( const This &a ) { return (a.hi_ < 0 ? -a : a); }
+
+    friend This sqrt ( const This &a )
+    {
+      // one Newton step for 1/sqrt(a) in double precision (Karp's trick)
+      if( !(a.hi_ > 0) )
+        return This( std::sqrt( a.hi_ ) );
+      const double x = 1.0 / std::sqrt( a.hi_ );
+      const double ax = a.hi_ * x;
+      double p, e;
+      twoProd( ax, ax, p, e );
+      const double correction = (a - This( p, e )).hi_ * (0.5*x);
+      This result;
+      twoSum( ax, correction, result.hi_, result.lo_ );
+      return result;
+    }
+
+    friend std::ostream &operator<< ( std::ostream &out, const This &a )
+    {
+      return out << a.hi_;
+    }
+
+  private:
+    DoubleDoubleField ( double hi, double lo )
+      : hi_( hi ), lo_( lo )
+    {}
+
+    // s + e = a + b exactly
+    static void twoSum ( double a, double b, double &s, double &e )
+    {
+      s = a + b;
+      const double bb = s - a;
+      e = (a - (s - bb)) + (b - bb);
+    }
+
+    // s + e = a + b exactly, provided |a| >= |b|
+    static void quickTwoSum ( double a, double b, double &s, double &e )
+    {
+      s = a + b;
+      e = b - (s - a);
+    }
+
+    // p + e = a * b exactly
+    static void twoProd ( double a, double b, double &p, double &e )
+    {
+      p = a * b;
+#ifdef FP_FAST_FMA
+      e = std::fma( a, b, -p );
+#else
+      double ahi, alo, bhi, blo;
+      split( a, ahi, alo );
+      split( b, bhi, blo );
+      e = ((ahi*bhi - p) + ahi*blo + alo*bhi) + alo*blo;
+#endif
+    }
+
+    // Dekker's splitting of a into two 26 bit halves
+    static void split ( double a, double &hi, double &lo )
+    {
+      const double t = 134217729.0 * a; // 2^27 + 1
+      hi = t - (t - a);
+      lo = a - hi;
+    }
+
+    double hi_, lo_;
+  };
+
+} // namespace Dune
+
+#endif // #ifndef DUNE_LOCALFUNCTIONS_UTILITY_DOUBLEDOUBLEFIELD_HH
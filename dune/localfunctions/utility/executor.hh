@@ -0,0 +1,192 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#ifndef DUNE_LOCALFUNCTIONS_EXECUTOR_HH
+#define DUNE_LOCALFUNCTIONS_EXECUTOR_HH
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace Dune
+{
+
+  /**
+   * @brief Runs the parallel parts of the construction of generic finite
+   *        elements
+   *
+   * The construction of the basis of a generic finite element fills and
+   * factorizes a dense matrix with one row per degree of freedom.  For
+   * high orders these steps are split into independent tasks, which are
+   * run by this class.  By default everything runs serially on the
+   * calling thread.  setNumThreads() enables a simple executor creating
+   * std::threads for each parallel step, setExecutor() installs any other
+   * one, e.g., a thread pool of the application:
+   *
+   * \code
+   * LocalFiniteElementExecutor::setNumThreads( 0 ); // one per hardware thread
+   * LagrangeLocalFiniteElement< EquidistantPointSet, 3, double, double > fe( GeometryTypes::simplex( 3 ), 12 );
+   * \endcode
+   *
+   * The settings are global and may be changed at any time, but not while
+   * a finite element is being constructed.
+   */
+  class LocalFiniteElementExecutor
+  {
+  public:
+    /** \brief type of a custom executor
+     *
+     * The executor is called with a number of tasks n and a function task
+     * and has to call task( i ) once for each 0 <= i < n, possibly
+     * concurrently, and return after all calls have finished.  Exceptions
+     * thrown by the tasks have to be passed on to the caller.
+     */
+    typedef std::function< void ( std::size_t, const std::function< void ( std::size_t ) > & ) > Executor;
+
+    /** \brief run all tasks by numThreads std::threads
+     *
+     * \param numThreads number of threads, including the calling one;
+     *                   0 means one per hardware thread and 1 (the
+     *                   default) runs all tasks serially
+     */
+    static void setNumThreads ( unsigned int numThreads )
+    {
+      if( numThreads == 0 )
+        numThreads = std::max( std::thread::hardware_concurrency(), 1u );
+      std::lock_guard< std::mutex > guard( state().mutex );
+      state().executor.reset();
+      state().concurrency = numThreads;
+    }
+
+    /** \brief run all tasks by a custom executor
+     *
+     * \param executor     the executor, an empty function restores serial
+     *                     execution
+     * \param concurrency  number of tasks the executor runs concurrently,
+     *                     used to decide how to split the work
+     */
+    static void setExecutor ( Executor executor, unsigned int concurrency )
+    {
+      std::lock_guard< std::mutex > guard( state().mutex );
+      if( executor )
+      {
+        state().executor = std::make_shared< Executor >( std::move( executor ) );
+        state().concurrency = std::max( concurrency, 1u );
+      }
+      else
+      {
+        state().executor.reset();
+        state().concurrency = 1;
+      }
+    }
+
+    //! number of tasks run concurrently, 1 if everything runs serially
+    static unsigned int concurrency ()
+    {
+      std::lock_guard< std::mutex > guard( state().mutex );
+      return state().concurrency;
+    }
+
+    //! minimal estimated number of operations worth a task of its own
+    static const std::size_t minTaskCost = std::size_t( 1 ) << 16;
+
+    /** \brief call f( first, last ) for a partition of [begin, end)
+     *
+     * The range is split into at most concurrency() chunks, which are
+     * processed concurrently.  Each chunk has to cost at least minTaskCost
+     * operations, so that small ranges are not split at all.  If there is
+     * only one chunk, f is called directly.
+     *
+     * \param cost estimated number of arithmetic operations per index
+     */
+    template< class F >
+    static void parallelFor ( std::size_t begin, std::size_t end, std::size_t cost, F &&f )
+    {
+      if( begin >= end )
+        return;
+
+      const std::size_t size = end - begin;
+      const std::size_t grain = 1 + minTaskCost / std::max< std::size_t >( cost, 1 );
+      std::shared_ptr< Executor > executor;
+      std::size_t numChunks;
+      {
+        std::lock_guard< std::mutex > guard( state().mutex );
+        executor = state().executor;
+        numChunks = std::min< std::size_t >( state().concurrency, size / grain );
+      }
+      if( numChunks <= 1 )
+      {
+        f( begin, end );
+        return;
+      }
+
+      const std::function< void ( std::size_t ) > task = [ begin, size, numChunks, &f ] ( std::size_t i ) {
+          f( begin + (i*size)/numChunks, begin + ((i+1)*size)/numChunks );
+        };
+      if( executor )
+        (*executor)( numChunks, task );
+      else
+        runThreads( numChunks, task );
+    }
+
+  private:
+    struct State
+    {
+      std::mutex mutex;
+      std::shared_ptr< Executor > executor;
+      unsigned int concurrency = 1;
+    };
+
+    static State &state ()
+    {
+      static State state;
+      return state;
+    }
+
+    // run the tasks on numTasks-1 new threads and the calling one
+    static void runThreads ( std::size_t numTasks, const std::function< void ( std::size_t ) > &task )
+    {
+      std::exception_ptr error;
+      std::mutex errorMutex;
+      auto work = [ &task, &error, &errorMutex ] ( std::size_t i ) {
+          try
+          {
+            task( i );
+          }
+          catch( ... )
+          {
+            std::lock_guard< std::mutex > guard( errorMutex );
+            if( !error )
+              error = std::current_exception();
+          }
+        };
+
+      std::vector< std::thread > threads;
+      for( std::size_t i = 1; i < numTasks; ++i )
+      {
+        // if no further thread can be started, run the task here
+        try
+        {
+          threads.emplace_back( work, i );
+        }
+        catch( const std::system_error & )
+        {
+          work( i );
+        }
+      }
+      work( 0 );
+      for( std::thread &thread : threads )
+        thread.join();
+      if( error )
+        std::rethrow_exception( error );
+    }
+  };
+
+}
+
+#endif // #ifndef DUNE_LOCALFUNCTIONS_EXECUTOR_HH
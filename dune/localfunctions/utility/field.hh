@@ -7,6 +7,9 @@
 #include <dune/common/fvector.hh>
 #include <dune/common/fmatrix.hh>
 
+#include <dune/localfunctions/utility/doubledoublefield.hh>
+#include <dune/localfunctions/utility/float128field.hh>
+
 namespace Dune
 {
 
@@ -101,6 +104,36 @@ namespace Dune
   };
 #endif
 
+  template<>
+  struct Zero< DoubleDoubleField >
+  {
+    typedef DoubleDoubleField Field;
+    operator Field () const
+    {
+      return Field( 0 );
+    }
+    static const Field epsilon()
+    {
+      return Field(1e-20);
+    }
+  };
+
+#if DUNE_LOCALFUNCTIONS_HAVE_FLOAT128
+  template<>
+  struct Zero< Float128Field >
+  {
+    typedef Float128Field Field;
+    operator Field () const
+    {
+      return Field( 0 );
+    }
+    static const Field epsilon()
+    {
+      return Field(1e-20);
+    }
+  };
+#endif
+
   template< class Field >
   inline bool operator == ( const Zero< Field > &, const Field &f )
   {
@@ -173,6 +206,39 @@ namespace Dune
   }
 #endif
 
+  inline void field_cast ( const DoubleDoubleField &f1, double &f2 )
+  {
+    f2 = static_cast< double >( f1 );
+  }
+
+  inline void field_cast ( const DoubleDoubleField &f1, long double &f2 )
+  {
+    f2 = static_cast< long double >( f1 );
+  }
+
+#if DUNE_LOCALFUNCTIONS_HAVE_FLOAT128
+  inline void field_cast ( const Float128Field &f1, double &f2 )
+  {
+    f2 = static_cast< double >( f1 );
+  }
+
+  inline void field_cast ( const Float128Field &f1, long double &f2 )
+  {
+    f2 = static_cast< long double >( f1 );
+  }
+
+  inline void field_cast ( const Float128Field &f1, DoubleDoubleField &f2 )
+  {
+    const double hi = static_cast< double >( f1 );
+    f2 = DoubleDoubleField( hi ) + DoubleDoubleField( static_cast< double >( f1 - Float128Field( hi ) ) );
+  }
+
+  inline void field_cast ( const DoubleDoubleField &f1, Float128Field &f2 )
+  {
+    f2 = Float128Field( f1.hi() ) + Float128Field( f1.lo() );
+  }
+#endif
+
   template< class F2, class F1, int dim >
   inline void field_cast ( const Dune::FieldVector< F1, dim > &f1, Dune::FieldVector< F2, dim > &f2 )
   {
@@ -287,9 +353,33 @@ namespace Dune
   };
 #endif
 
+  template<>
+  struct Precision< DoubleDoubleField >
+  {
+    static const unsigned int value = 106;
+  };
+
+#if DUNE_LOCALFUNCTIONS_HAVE_FLOAT128
+  template<>
+  struct Precision< Float128Field >
+  {
+    static const unsigned int value = 113;
+  };
+#endif
+
   // ComputeField
   // ------------
 
+  /**
+   * @brief the field used to compute the coefficients of a basis
+   *        stored in Field
+   *
+   * For GMPField the precision is increased by sum bits, all other fields,
+   * including the fixed precision fields DoubleDoubleField and
+   * Float128Field, are used as they are.  To compute in higher precision
+   * than double, pass one of these as ComputeField explicitly, e.g.,
+   * LagrangeBasisFactory< PointSet, dim, double, DoubleDoubleField >.
+   */
   template <class Field,unsigned int sum>
   struct ComputeField
   {
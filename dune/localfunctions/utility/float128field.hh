@@ -0,0 +1,115 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#ifndef DUNE_LOCALFUNCTIONS_UTILITY_FLOAT128FIELD_HH
+#define DUNE_LOCALFUNCTIONS_UTILITY_FLOAT128FIELD_HH
+
+#include <cmath>
+#include <ostream>
+#include <type_traits>
+
+/**
+ * \brief whether the compiler provides the __float128 type
+ *
+ * This may be set to 0 on the command line to disable Float128Field.
+ */
+#ifndef DUNE_LOCALFUNCTIONS_HAVE_FLOAT128
+#ifdef __SIZEOF_FLOAT128__
+#define DUNE_LOCALFUNCTIONS_HAVE_FLOAT128 1
+#else
+#define DUNE_LOCALFUNCTIONS_HAVE_FLOAT128 0
+#endif
+#endif
+
+#if DUNE_LOCALFUNCTIONS_HAVE_FLOAT128
+
+namespace Dune
+{
+
+  /**
+   * @brief The IEEE quadruple precision type __float128 as a field
+   *
+   * __float128 has a 113 bit mantissa and is implemented by the
+   * compiler, so no library like libquadmath is needed.  This class
+   * only adds the functions needed by the generic finite elements,
+   * i.e., abs, sqrt and output, which are found by argument dependent
+   * lookup.  sqrt is computed by Newton's method starting from the
+   * double precision result.  Output is rounded to long double.
+   */
+  class Float128Field
+  {
+    typedef Float128Field This;
+
+  public:
+    Float128Field ()
+      : value_( 0 )
+    {}
+
+    Float128Field ( __float128 x )
+      : value_( x )
+    {}
+
+    Float128Field ( double x )
+      : value_( x )
+    {}
+
+    Float128Field ( long double x )
+      : value_( x )
+    {}
+
+    template< class T, std::enable_if_t< std::is_integral< T >::value, int > = 0 >
+    Float128Field ( T x )
+      : value_( x )
+    {}
+
+    //! the underlying __float128
+    __float128 value () const { return value_; }
+
+    explicit operator double () const { return static_cast< double >( value_ ); }
+    explicit operator long double () const { return static_cast< long double >( value_ ); }
+
+    This operator- () const { return This( -value_ ); }
+
+    This &operator+= ( const This &other ) { value_ += other.value_; return *this; }
+    This &operator-= ( const This &other ) { value_ -= other.value_; return *this; }
+    This &operator*= ( const This &other ) { value_ *= other.value_; return *this; }
+    This &operator/= ( const This &other ) { value_ /= other.value_; return *this; }
+
+    friend This operator+ ( This a, const This &b ) { return a += b; }
+    friend This operator- ( This a, const This &b ) { return a -= b; }
+    friend This operator* ( This a, const This &b ) { return a *= b; }
+    friend This operator/ ( This a, const This &b ) { return a /= b; }
+
+    friend bool operator== ( const This &a, const This &b ) { return a.value_ == b.value_; }
+    friend bool operator!= ( const This &a, const This &b ) { return a.value_ != b.value_; }
+    friend bool operator< ( const This &a, const This &b ) { return a.value_ < b.value_; }
+    friend bool operator> ( const This &a, const This &b ) { return a.value_ > b.value_; }
+    friend bool operator<= ( const This &a, const This &b ) { return a.value_ <= b.value_; }
+    friend bool operator>= ( const This &a, const This &b ) { return a.value_ >= b.value_; }
+
+    friend This abs ( const This &a ) { return (a.value_ < 0 ? -a : a); }
+
+    friend This sqrt ( const This &a )
+    {
+      if( !(a.value_ > 0) )
+        return This( std::sqrt( static_cast< double >( a.value_ ) ) );
+      // each Newton step doubles the 53 correct bits of the initial value
+      __float128 x = std::sqrt( static_cast< double >( a.value_ ) );
+      x = 0.5 * (x + a.value_ / x);
+      x = 0.5 * (x + a.value_ / x);
+      return This( x );
+    }
+
+    friend std::ostream &operator<< ( std::ostream &out, const This &a )
+    {
+      return out << static_cast< long double >( a.value_ );
+    }
+
+  private:
+    __float128 value_;
+  };
+
+} // namespace Dune
+
+#endif // #if DUNE_LOCALFUNCTIONS_HAVE_FLOAT128
+
+#endif // #ifndef DUNE_LOCALFUNCTIONS_UTILITY_FLOAT128FIELD_HH
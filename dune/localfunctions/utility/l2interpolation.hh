@@ -3,6 +3,12 @@
 #ifndef DUNE_L2INTERPOLATION_HH
 #define DUNE_L2INTERPOLATION_HH
 
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+#include <dune/common/fvector.hh>
+
 #include <dune/geometry/topologyfactory.hh>
 #include <dune/geometry/quadraturerules.hh>
 
@@ -24,6 +30,11 @@ namespace Dune
    * base function set.
    * The third template argument can be used to specify that the
    * mass matrix is the unit matrix (onb=true).
+   *
+   * The weighted values of the basis functions at the quadrature points
+   * (multiplied by M^{-1} for onb=false) are tabulated on construction.
+   * An interpolation therefore only evaluates the function, and several
+   * threads can interpolate at the same time.
    **/
   template< class B, class Q, bool onb >
   struct LocalL2Interpolation;
@@ -38,31 +49,68 @@ namespace Dune
     typedef Q Quadrature;
 
     static const unsigned int dimension = Basis::dimension;
+    static const unsigned int dimRange = Basis::dimRange;
 
     template< class Function, class DofField >
     void interpolate ( const Function &function, std::vector< DofField > &coefficients ) const
     {
-      typedef typename Quadrature::iterator Iterator;
-      typedef FieldVector< DofField, Basis::dimRange > RangeVector;
+      typedef FieldVector< DofField, dimRange > RangeVector;
 
       const unsigned int size = basis().size();
-      static std::vector< RangeVector > basisValues( size );
-
       coefficients.resize( size );
-      basisValues.resize( size );
       for( unsigned int i = 0; i < size; ++i )
         coefficients[ i ] = Zero< DofField >();
 
-      const Iterator end = quadrature().end();
-      for( Iterator it = quadrature().begin(); it != end; ++it )
+      for( unsigned int q = 0; q < quadrature().size(); ++q )
       {
-        basis().evaluate( it->position(), basisValues );
         typename Function::RangeType val;
-        function.evaluate( field_cast<typename Function::DomainType::field_type>(it->position()), val );
+        function.evaluate( field_cast<typename Function::DomainType::field_type>(quadrature()[ q ].position()), val );
         RangeVector factor = field_cast< DofField >( val );
-        factor *= field_cast< DofField >( it->weight() );
-        for( unsigned int i = 0; i < size; ++i )
-          coefficients[ i ] += factor * basisValues[ i ];
+        for( unsigned int r = 0; r < dimRange; ++r )
+        {
+          const Field *row = &(table_[ (q*dimRange + r)*size ]);
+          for( unsigned int i = 0; i < size; ++i )
+            coefficients[ i ] += factor[ r ] * field_cast< DofField >( row[ i ] );
+        }
+      }
+    }
+
+    /** \brief Interpolate several functions given by their values at the
+     *         quadrature points
+     *
+     * The coefficients of all functions are computed by one product of the
+     * matrix of samples with the tabulated basis, so that the basis is not
+     * evaluated again.
+     *
+     * \param samples       values of the functions, samples[f*quadrature().size()+q]
+     *                      is the value of function f at quadrature point q
+     * \param coefficients  the coefficients, coefficients[f*basis().size()+i]
+     *                      is coefficient i of function f
+     */
+    template< class DofField >
+    void interpolate ( const std::vector< FieldVector< DofField, dimRange > > &samples,
+                       std::vector< DofField > &coefficients ) const
+    {
+      const unsigned int size = basis().size();
+      const unsigned int numPoints = quadrature().size();
+      assert( samples.size() % numPoints == 0 );
+      const std::size_t numFunctions = samples.size() / numPoints;
+
+      coefficients.resize( numFunctions*size );
+      for( std::size_t k = 0; k < coefficients.size(); ++k )
+        coefficients[ k ] = Zero< DofField >();
+
+      for( std::size_t f = 0; f < numFunctions; ++f )
+      {
+        DofField *c = &(coefficients[ f*size ]);
+        for( unsigned int q = 0; q < numPoints; ++q )
+          for( unsigned int r = 0; r < dimRange; ++r )
+          {
+            const DofField s = samples[ f*numPoints + q ][ r ];
+            const Field *row = &(table_[ (q*dimRange + r)*size ]);
+            for( unsigned int i = 0; i < size; ++i )
+              c[ i ] += s * field_cast< DofField >( row[ i ] );
+          }
       }
     }
 
@@ -77,13 +125,31 @@ namespace Dune
     }
 
   protected:
+    typedef typename Basis::StorageField Field;
+    typedef FieldVector< Field, dimRange > RangeVector;
+
     LocalL2InterpolationBase ( const Basis &basis, const Quadrature &quadrature )
       : basis_( basis ),
-        quadrature_( quadrature )
-    {}
+        quadrature_( quadrature ),
+        table_( quadrature.size()*dimRange*basis.size() )
+    {
+      // tabulate the basis functions, weighted by the quadrature weights
+      const unsigned int size = basis.size();
+      std::vector< RangeVector > basisValues( size );
+      for( unsigned int q = 0; q < quadrature.size(); ++q )
+      {
+        basis.evaluate( quadrature[ q ].position(), basisValues );
+        const Field weight = field_cast< Field >( quadrature[ q ].weight() );
+        for( unsigned int r = 0; r < dimRange; ++r )
+          for( unsigned int i = 0; i < size; ++i )
+            table_[ (q*dimRange + r)*size + i ] = basisValues[ i ][ r ] * weight;
+      }
+    }
 
     const Basis &basis_;
     const Quadrature &quadrature_;
+    // weight_q phi_i(x_q)[r] at table_[(q*dimRange+r)*size+i]
+    std::vector< Field > table_;
   };
 
   template< class B, class Q >
@@ -109,55 +175,52 @@ namespace Dune
     friend class LocalL2InterpolationFactory;
     using typename Base::Basis;
     using typename Base::Quadrature;
-    template< class Function, class DofField >
-    void interpolate ( const Function &function, std::vector< DofField > &coefficients ) const
-    {
-      const unsigned size = Base::basis().size();
-      Base::interpolate(function,val_);
-      coefficients.resize( size );
-      for (unsigned int i=0; i<size; ++i)
-      {
-        coefficients[i] = 0;
-        for (unsigned int j=0; j<size; ++j)
-        {
-          coefficients[i] += field_cast<DofField>(massMatrix_(i,j)*val_[j]);
-        }
-      }
-    }
   private:
     LocalL2Interpolation ( const typename Base::Basis &basis, const typename Base::Quadrature &quadrature )
-      : Base(basis,quadrature),
-        val_(basis.size()),
-        massMatrix_()
+      : Base(basis,quadrature)
     {
-      typedef FieldVector< Field, Base::Basis::dimRange > RangeVector;
       typedef typename Base::Quadrature::iterator Iterator;
       const unsigned size = basis.size();
       std::vector< RangeVector > basisValues( size );
 
-      massMatrix_.resize( size,size );
+      MassMatrix massMatrix;
+      massMatrix.resize( size,size );
       for (unsigned int i=0; i<size; ++i)
         for (unsigned int j=0; j<size; ++j)
-          massMatrix_(i,j) = 0;
+          massMatrix(i,j) = 0;
       const Iterator end = Base::quadrature().end();
       for( Iterator it = Base::quadrature().begin(); it != end; ++it )
       {
         Base::basis().evaluate( it->position(), basisValues );
         for (unsigned int i=0; i<size; ++i)
           for (unsigned int j=0; j<size; ++j)
-            massMatrix_(i,j) += (basisValues[i]*basisValues[j])*it->weight();
+            massMatrix(i,j) += (basisValues[i]*basisValues[j])*it->weight();
       }
-      if ( !massMatrix_.invert() )
+      LFELUDecomposition< Field > lu;
+      if ( !lu.factorize( massMatrix ) )
       {
         DUNE_THROW(MathError, "Mass matrix singular in LocalL2Interpolation");
       }
 
+      // Apply the inverse mass matrix to the tabulated basis once, so that
+      // the interpolation of the base class yields M^{-1}b directly.  The
+      // tabulated values are the right hand sides of one solve with the
+      // LU decomposition, so that M^{-1} is never formed.
+      const std::size_t numBlocks = table_.size() / size;
+      MassMatrix rhs;
+      rhs.resize( size, numBlocks );
+      for( std::size_t k = 0; k < numBlocks; ++k )
+        for (unsigned int i=0; i<size; ++i)
+          rhs(i,k) = table_[k*size+i];
+      lu.solve( rhs );
+      for( std::size_t k = 0; k < numBlocks; ++k )
+        for (unsigned int i=0; i<size; ++i)
+          table_[k*size+i] = rhs(i,k);
     }
-    typedef typename Base::Basis::StorageField Field;
-    typedef FieldVector< Field, Base::Basis::dimRange > RangeVector;
+    typedef typename Base::Field Field;
+    typedef typename Base::RangeVector RangeVector;
     typedef LFEMatrix<Field> MassMatrix;
-    mutable std::vector<Field> val_;
-    MassMatrix massMatrix_;
+    using Base::table_;
   };
 
   /**
@@ -3,54 +3,75 @@
 #ifndef DUNE_LOCALFUNCTIONS_UTILITY_LFEMATRIX_HH
 #define DUNE_LOCALFUNCTIONS_UTILITY_LFEMATRIX_HH
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <cstddef>
 #include <vector>
 
+#include <dune/common/deprecated.hh>
+
+#include "executor.hh"
 #include "field.hh"
 
 namespace Dune
 {
 
   template< class F >
+  class LFELUDecomposition;
+
+  /**
+   * @brief A dense matrix used for the construction of the generic
+   *        finite elements
+   *
+   * The entries are stored row by row in one contiguous array.
+   */
+  template< class F >
   class LFEMatrix
   {
     typedef LFEMatrix< F > This;
-    typedef std::vector< F > Row;
-    typedef std::vector<Row> RealMatrix;
 
   public:
     typedef F Field;
 
-    operator const RealMatrix & () const
-    {
-      return matrix_;
-    }
+    LFEMatrix ()
+      : cols_(0), rows_(0)
+    {}
 
-    operator RealMatrix & ()
+    /** \brief copy the entries into a vector of rows
+     *
+     * The entries are no longer stored as a vector of rows, so this
+     * returns a copy and changes of the result do not affect the matrix.
+     */
+    DUNE_DEPRECATED_MSG("LFEMatrix stores its entries contiguously, use operator() or rowPtr() instead")
+    operator std::vector< std::vector< Field > > () const
     {
-      return matrix_;
+      std::vector< std::vector< Field > > matrix( rows_ );
+      for (unsigned int i=0; i<rows_; ++i)
+        matrix[i].assign( rowPtr(i), rowPtr(i)+cols_ );
+      return matrix;
     }
 
     template <class Vector>
     void row( const unsigned int row, Vector &vec ) const
     {
       assert(row<rows());
-      for (int i=0; i<cols(); ++i)
-        field_cast(matrix_[row][i], vec[i]);
+      for (unsigned int i=0; i<cols(); ++i)
+        field_cast((*this)(row,i), vec[i]);
     }
 
     const Field &operator() ( const unsigned int row, const unsigned int col ) const
     {
       assert(row<rows());
       assert(col<cols());
-      return matrix_[ row ][ col ];
+      return matrix_[ std::size_t(row)*cols_ + col ];
     }
 
     Field &operator() ( const unsigned int row, const unsigned int col )
     {
       assert(row<rows());
       assert(col<cols());
-      return matrix_[ row ][ col ];
+      return matrix_[ std::size_t(row)*cols_ + col ];
     }
 
     unsigned int rows () const
@@ -66,83 +87,342 @@ namespace Dune
     const Field *rowPtr ( const unsigned int row ) const
     {
       assert(row<rows());
-      return &(matrix_[row][0]);
+      return matrix_.data() + std::size_t(row)*cols_;
     }
 
     Field *rowPtr ( const unsigned int row )
     {
       assert(row<rows());
-      return &(matrix_[row][0]);
+      return matrix_.data() + std::size_t(row)*cols_;
     }
 
+    //! resize the matrix, keeping the entries present in both sizes
     void resize ( const unsigned int rows, const unsigned int cols )
     {
-      matrix_.resize(rows);
-      for (unsigned int i=0; i<rows; ++i)
-        matrix_[i].resize(cols);
+      if (cols != cols_)
+      {
+        std::vector< Field > matrix( std::size_t(rows)*cols );
+        for (unsigned int i=0; i<std::min(rows,rows_); ++i)
+          std::copy( rowPtr(i), rowPtr(i)+std::min(cols,cols_), matrix.begin()+std::size_t(i)*cols );
+        matrix_.swap( matrix );
+      }
+      else
+        matrix_.resize( std::size_t(rows)*cols );
       rows_ = rows;
       cols_ = cols;
     }
 
+    /** \brief Replace the matrix by its inverse
+     *
+     * The inverse is computed from an LU decomposition with partial
+     * pivoting, see LFELUDecomposition.
+     *
+     * \returns false, if the matrix is singular
+     */
     bool invert ()
     {
       assert( rows() == cols() );
-      std::vector<unsigned int> p(rows());
-      for (unsigned int j=0; j<rows(); ++j)
-        p[j] = j;
-      for (unsigned int j=0; j<rows(); ++j)
+      LFELUDecomposition< Field > lu;
+      if (!lu.factorize(*this))
+        return false;
+      setIdentity();
+      lu.solve(*this);
+      return true;
+    }
+
+    /** \brief Replace the matrix by its inverse using mixed precision
+     *
+     * The matrix is factorized in the cheaper LowField, e.g., double,
+     * and the inverse X obtained from this factorization is improved by
+     * iterative refinement: The residual I - AX is computed in Field,
+     * the correction is obtained from the LowField factorization, and X
+     * is updated in Field.  This stops as soon as the corrections no
+     * longer decrease, i.e., the accuracy of Field has been reached.
+     * If the matrix is too ill-conditioned for LowField, so that the
+     * refinement does not converge within maxIterations steps, the
+     * inverse is computed by invert() in Field.
+     *
+     * Each refinement step costs about as much as invert().  Hence this
+     * pays off when arithmetic in Field is expensive and few steps are
+     * needed, i.e., for moderately conditioned matrices.
+     *
+     * \returns false, if the matrix is singular
+     */
+    template< class LowField >
+    bool invertRefined ( unsigned int maxIterations = 10 )
+    {
+      assert( rows() == cols() );
+      LFELUDecomposition< LowField > lu;
+      if (lu.factorize(*this))
       {
-        // pivot search
-        unsigned int r = j;
-        Field max = std::abs( (*this)(j,j) );
-        for (unsigned int i=j+1; i<rows(); ++i)
+        This inverse;
+        inverse.resize(rows(), cols());
+        inverse.setIdentity();
+        lu.solve(inverse);
+
+        This correction;
+        double lastNorm = 0;
+        for (unsigned int iteration = 0; iteration < maxIterations; ++iteration)
         {
-          if ( std::abs( (*this)(i,j) ) > max )
+          // correction = I - A X
+          correction.resize(rows(), cols());
+          correction.setIdentity();
+          correction.subtractProduct(*this, inverse);
+          lu.solve(correction);
+
+          const double norm = correction.maxNorm();
+          if ((iteration > 0 && norm > 0.5*lastNorm) || norm == 0)
           {
-            max = std::abs( (*this)(i,j) );
-            r = i;
+            // no further improvement, Field accuracy has been reached
+            swap(inverse);
+            return true;
           }
+          inverse.add(correction);
+          lastNorm = norm;
         }
-        if (max == Zero<Field>())
-          return false;
-        // row swap
-        if (r > j)
-        {
-          for (unsigned int k=0; k<cols(); ++k)
-            std::swap( (*this)(j,k), (*this)(r,k) );
-          std::swap( p[j], p[r] );
-        }
-        // transformation
-        Field hr = Unity<Field>()/(*this)(j,j);
-        for (unsigned int i=0; i<rows(); ++i)
-          (*this)(i,j) *= hr;
-        (*this)(j,j) = hr;
-        for (unsigned int k=0; k<cols(); ++k)
+      }
+      return invert();
+    }
+
+    //! set this matrix to the identity
+    void setIdentity ()
+    {
+      std::fill( matrix_.begin(), matrix_.end(), Field( Zero< Field >() ) );
+      for (unsigned int i=0; i<std::min(rows(),cols()); ++i)
+        (*this)(i,i) = Unity< Field >();
+    }
+
+    //! swap the entries with another matrix
+    void swap ( This &other )
+    {
+      matrix_.swap( other.matrix_ );
+      std::swap( cols_, other.cols_ );
+      std::swap( rows_, other.rows_ );
+    }
+
+  private:
+    // this += other
+    void add ( const This &other )
+    {
+      for (std::size_t i=0; i<matrix_.size(); ++i)
+        matrix_[ i ] += other.matrix_[ i ];
+    }
+
+    // this -= a*b, computed row by row to run over contiguous data
+    void subtractProduct ( const This &a, const This &b )
+    {
+      assert( a.rows() == rows() && b.cols() == cols() && a.cols() == b.rows() );
+      LocalFiniteElementExecutor::parallelFor( 0, rows(), std::size_t(a.cols())*cols(),
+        [ this, &a, &b ] ( std::size_t first, std::size_t last ) {
+          for (std::size_t i=first; i<last; ++i)
+          {
+            Field *ci = rowPtr(i);
+            for (unsigned int k=0; k<a.cols(); ++k)
+            {
+              const Field &aik = a(i,k);
+              const Field *bk = b.rowPtr(k);
+              for (unsigned int j=0; j<cols(); ++j)
+                ci[ j ] -= aik * bk[ j ];
+            }
+          }
+        } );
+    }
+
+    // maximal absolute value of the entries
+    double maxNorm () const
+    {
+      double norm = 0;
+      for (const Field &f : matrix_)
+        norm = std::max( norm, std::abs( field_cast< double >( f ) ) );
+      return norm;
+    }
+
+    std::vector< Field > matrix_;
+    unsigned int cols_,rows_;
+  };
+
+
+
+  /**
+   * @brief LU decomposition with partial pivoting of a square LFEMatrix
+   *
+   * The factorization is computed in Field, which may differ from the
+   * field of the matrix.  It is blocked: blockSize columns are factorized
+   * at once, and the remaining matrix is updated by one matrix product
+   * for the whole block.  All loops run over rows, which are contiguous
+   * in the LFEMatrix.
+   */
+  template< class F >
+  class LFELUDecomposition
+  {
+  public:
+    typedef F Field;
+
+    //! number of columns factorized together
+    static const unsigned int blockSize = 32;
+
+    //! size of the factorized matrix
+    unsigned int size () const
+    {
+      return lu_.rows();
+    }
+
+    /** \brief factorize a matrix
+     *
+     * \returns false, if a pivot is zero, i.e., the matrix is singular
+     */
+    template< class MField >
+    bool factorize ( const LFEMatrix< MField > &matrix )
+    {
+      assert( matrix.rows() == matrix.cols() );
+      const unsigned int n = matrix.rows();
+      lu_.resize( n, n );
+      for (unsigned int i=0; i<n; ++i)
+        for (unsigned int j=0; j<n; ++j)
+          field_cast( matrix(i,j), lu_(i,j) );
+      pivot_.resize( n );
+
+      for (unsigned int k0=0; k0<n; k0+=blockSize)
+      {
+        const unsigned int k1 = std::min( k0+blockSize, n );
+
+        // factorize the columns [k0,k1), swapping whole rows
+        for (unsigned int j=k0; j<k1; ++j)
         {
-          if (k==j) continue;
-          for (unsigned int i=0; i<rows(); ++i)
+          unsigned int r = j;
+          Field max = absolute( lu_(j,j) );
+          for (unsigned int i=j+1; i<n; ++i)
           {
-            if (i==j) continue;
-            (*this)(i,k) -= (*this)(i,j)*(*this)(j,k);
+            if (absolute( lu_(i,j) ) > max)
+            {
+              max = absolute( lu_(i,j) );
+              r = i;
+            }
+          }
+          if (max == Zero<Field>())
+            return false;
+          pivot_[ j ] = r;
+          if (r != j)
+            std::swap_ranges( lu_.rowPtr(j), lu_.rowPtr(j)+n, lu_.rowPtr(r) );
+
+          const Field hr = Unity<Field>()/lu_(j,j);
+          const Field *uj = lu_.rowPtr(j);
+          for (unsigned int i=j+1; i<n; ++i)
+          {
+            Field *li = lu_.rowPtr(i);
+            li[ j ] *= hr;
+            for (unsigned int c=j+1; c<k1; ++c)
+              li[ c ] -= li[ j ] * uj[ c ];
           }
-          (*this)(j,k) *= -hr;
         }
-      }
-      // column exchange
-      Row hv(rows());
-      for (unsigned int i=0; i<rows(); ++i)
-      {
-        for (unsigned int k=0; k<rows(); ++k)
-          hv[ p[k] ] = (*this)(i,k);
-        for (unsigned int k=0; k<rows(); ++k)
-          (*this)(i,k) = hv[k];
+
+        // rows [k0,k1) of U right of the block: solve with the unit lower
+        // triangle of the block, independently for ranges of columns
+        LocalFiniteElementExecutor::parallelFor( k1, n, (k1-k0)*(k1-k0),
+          [ this, k0, k1 ] ( std::size_t first, std::size_t last ) {
+            for (unsigned int i=k0+1; i<k1; ++i)
+            {
+              Field *ui = lu_.rowPtr(i);
+              for (unsigned int j=k0; j<i; ++j)
+                axpy( ui+first, -ui[ j ], lu_.rowPtr(j)+first, last-first );
+            }
+          } );
+
+        // update the remaining matrix by the product of the block column
+        // of L with the block row of U, independently for ranges of rows
+        LocalFiniteElementExecutor::parallelFor( k1, n, (k1-k0)*(n-k1),
+          [ this, k0, k1, n ] ( std::size_t first, std::size_t last ) {
+            for (std::size_t i=first; i<last; ++i)
+            {
+              Field *ai = lu_.rowPtr(i);
+              for (unsigned int j=k0; j<k1; ++j)
+                axpy( ai+k1, -ai[ j ], lu_.rowPtr(j)+k1, n-k1 );
+            }
+          } );
       }
       return true;
     }
 
+    /** \brief solve AX = B for several right hand sides
+     *
+     * B is overwritten by X. It is converted to Field for the solution,
+     * if it is given in another field.
+     */
+    template< class BField >
+    void solve ( LFEMatrix< BField > &b ) const
+    {
+      LFEMatrix< Field > x;
+      x.resize( b.rows(), b.cols() );
+      for (unsigned int i=0; i<b.rows(); ++i)
+        for (unsigned int j=0; j<b.cols(); ++j)
+          field_cast( b(i,j), x(i,j) );
+      solve( x );
+      for (unsigned int i=0; i<b.rows(); ++i)
+        for (unsigned int j=0; j<b.cols(); ++j)
+          field_cast( x(i,j), b(i,j) );
+    }
+
+    /** \brief solve AX = B for several right hand sides, B is overwritten by X
+     *
+     * The columns of B are solved for independently, so ranges of them
+     * are processed in parallel by the LocalFiniteElementExecutor.
+     */
+    void solve ( LFEMatrix< Field > &b ) const
+    {
+      assert( b.rows() == size() );
+      LocalFiniteElementExecutor::parallelFor( 0, b.cols(), std::size_t(size())*size(),
+        [ this, &b ] ( std::size_t first, std::size_t last ) {
+          solve( b, first, last );
+        } );
+    }
+
   private:
-    RealMatrix matrix_;
-    unsigned int cols_,rows_;
+    // solve for the columns [first,last) of b
+    void solve ( LFEMatrix< Field > &b, std::size_t first, std::size_t last ) const
+    {
+      const unsigned int n = size();
+      const std::size_t m = last - first;
+
+      for (unsigned int i=0; i<n; ++i)
+        if (pivot_[ i ] != i)
+          std::swap_ranges( b.rowPtr(i)+first, b.rowPtr(i)+last, b.rowPtr(pivot_[ i ])+first );
+
+      // forward substitution with the unit lower triangle
+      for (unsigned int i=1; i<n; ++i)
+      {
+        const Field *li = lu_.rowPtr(i);
+        Field *bi = b.rowPtr(i)+first;
+        for (unsigned int j=0; j<i; ++j)
+          axpy( bi, -li[ j ], b.rowPtr(j)+first, m );
+      }
+
+      // backward substitution with the upper triangle
+      for (unsigned int i=n; i-- > 0; )
+      {
+        const Field *ui = lu_.rowPtr(i);
+        Field *bi = b.rowPtr(i)+first;
+        for (unsigned int j=i+1; j<n; ++j)
+          axpy( bi, -ui[ j ], b.rowPtr(j)+first, m );
+        const Field hr = Unity<Field>()/ui[ i ];
+        for (std::size_t c=0; c<m; ++c)
+          bi[ c ] *= hr;
+      }
+    }
+
+    static Field absolute ( const Field &f )
+    {
+      return (f < Zero<Field>() ? Field( -f ) : f);
+    }
+
+    // y += a*x for n entries
+    static void axpy ( Field *y, const Field &a, const Field *x, std::size_t n )
+    {
+      for (std::size_t c=0; c<n; ++c)
+        y[ c ] += a * x[ c ];
+    }
+
+    LFEMatrix< Field > lu_;
+    std::vector< unsigned int > pivot_;
   };
 
   template< class Field >
@@ -3,9 +3,13 @@
 #ifndef DUNE_GENERIC_LOCALFINITEELEMENT_HH
 #define DUNE_GENERIC_LOCALFINITEELEMENT_HH
 
+#include <memory>
+#include <utility>
+
 #include <dune/geometry/type.hh>
 
 #include <dune/localfunctions/common/localfiniteelementtraits.hh>
+#include <dune/localfunctions/utility/concurrentregistry.hh>
 #include <dune/localfunctions/utility/l2interpolation.hh>
 #include <dune/localfunctions/utility/dglocalcoefficients.hh>
 
@@ -16,6 +20,10 @@ namespace Dune
    *        TopologyFactories providing the LocalBasis, LocalCoefficients,
    *        and LocalInterpolations. Note the key type for all three
    *        factories must coincide.
+   *
+   * The basis, coefficients and interpolation are created only once for
+   * each topology and key, and are shared by all elements constructed
+   * with them.  Copying an element only copies a shared pointer.
    **/
   template< class BasisF, class CoeffF, class InterpolF>
   struct GenericLocalFiniteElement
@@ -41,50 +49,34 @@ namespace Dune
     GenericLocalFiniteElement ( const GeometryType &gt, const Key &key )
       : topologyId_( gt.id() ),
         key_( key ),
-        finiteElement_()
-    {
-      Impl::IfTopology< FiniteElement::template Maker, dimDomain >::apply( topologyId_, key_, finiteElement_ );
-    }
-
-    /** \todo Please doc me */
-    GenericLocalFiniteElement ( const GenericLocalFiniteElement &other )
-      : topologyId_( other.topologyId_ ),
-        key_( other.key_ ),
-        finiteElement_()
-    {
-      Impl::IfTopology< FiniteElement::template Maker, dimDomain >::apply( topologyId_, key_, finiteElement_ );
-    }
-
-    ~GenericLocalFiniteElement()
-    {
-      finiteElement_.release();
-    }
+        finiteElement_( finiteElement( topologyId_, key_ ) )
+    {}
 
     /** \todo Please doc me !
      */
     const typename Traits::LocalBasisType& localBasis () const
     {
-      return *(finiteElement_.basis_);
+      return *(finiteElement_->basis_);
     }
 
     /** \todo Please doc me !
      */
     const typename Traits::LocalCoefficientsType& localCoefficients () const
     {
-      return *(finiteElement_.coeff_);
+      return *(finiteElement_->coeff_);
     }
 
     /** \todo Please doc me !
      */
     const typename Traits::LocalInterpolationType& localInterpolation () const
     {
-      return *(finiteElement_.interpol_);
+      return *(finiteElement_->interpol_);
     }
 
     /** \brief Number of shape functions in this finite element */
     unsigned int size () const
     {
-      return finiteElement_.basis_->size();
+      return finiteElement_->basis_->size();
     }
 
     /** \todo Please doc me !
@@ -104,6 +96,9 @@ namespace Dune
     struct FiniteElement
     {
       FiniteElement() : basis_(0), coeff_(0), interpol_(0) {}
+      FiniteElement( const FiniteElement & ) = delete;
+      FiniteElement &operator= ( const FiniteElement & ) = delete;
+      ~FiniteElement() { release(); }
       template <class Topology>
       void create( const Key &key )
       {
@@ -136,9 +131,26 @@ namespace Dune
       typename Traits::LocalCoefficientsType *coeff_;
       typename Traits::LocalInterpolationType *interpol_;
     };
+
+    // The finite element for the given topology and key, which is created
+    // on the first request and shared by all later ones
+    static std::shared_ptr< const FiniteElement > finiteElement ( unsigned int topologyId, const Key &key )
+    {
+      typedef ConcurrentRegistry< std::pair< unsigned int, Key >, const FiniteElement > Registry;
+      // never destroyed, since the factories releasing the objects may
+      // already be gone at program exit
+      static Registry &registry = *new Registry;
+
+      return registry.get( std::make_pair( topologyId, key ), [ topologyId, &key ] () {
+          std::shared_ptr< FiniteElement > finiteElement = std::make_shared< FiniteElement >();
+          Impl::IfTopology< FiniteElement::template Maker, dimDomain >::apply( topologyId, key, *finiteElement );
+          return finiteElement;
+        } );
+    }
+
     unsigned int topologyId_;
     Key key_;
-    FiniteElement finiteElement_;
+    std::shared_ptr< const FiniteElement > finiteElement_;
   };
 
   /**
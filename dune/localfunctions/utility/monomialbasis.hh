@@ -3,14 +3,20 @@
 #ifndef DUNE_MONOMIALBASIS_HH
 #define DUNE_MONOMIALBASIS_HH
 
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <limits>
 #include <vector>
 
 #include <dune/common/fvector.hh>
 #include <dune/common/fmatrix.hh>
+#include <dune/common/unused.hh>
 
 #include <dune/geometry/topologyfactory.hh>
 #include <dune/geometry/type.hh>
 
+#include <dune/localfunctions/utility/concurrentregistry.hh>
 #include <dune/localfunctions/utility/field.hh>
 #include <dune/localfunctions/utility/multiindex.hh>
 #include <dune/localfunctions/utility/tensor.hh>
@@ -60,7 +66,7 @@ namespace Dune
   * 5) template< int dim, class F >
   *    struct MonomialBasisProvider
   *    A singleton container for the virtual monomial
-  *    basis
+  *    basis, which may be used from several threads
   ************************************************/
 
   // Internal Forward Declarations
@@ -77,6 +83,18 @@ namespace Dune
   // MonomialBasisSize
   // -----------------
 
+  /** \brief highest order up to which the sizes of the monomial bases are tabulated
+   *
+   *  The tables of MonomialBasisSize are filled up to this order on
+   *  construction, or up to the highest order whose number of monomials
+   *  still fits into an unsigned int, whichever is smaller, e.g., order 254
+   *  for the cube and order 564 for the simplex in 4d.  The tables are never changed afterwards, so they
+   *  may be read from several threads without locking; the concurrent
+   *  evaluation of PolynomialBasis and LocalFiniteElementPrewarm rely on
+   *  this.  Higher orders are not supported.
+   */
+  static const unsigned int monomialBasisOrderLimit = 1024;
+
   template<>
   class MonomialBasisSize< Impl::Point >
   {
@@ -94,20 +112,29 @@ namespace Dune
     friend class MonomialBasisSize< Impl::Prism< Topology > >;
     friend class MonomialBasisSize< Impl::Pyramid< Topology > >;
 
-    mutable unsigned int maxOrder_;
+    unsigned int maxOrder_;
     // sizes_[ k ]: number of basis functions of exactly order k
-    mutable unsigned int *sizes_;
+    unsigned int *sizes_;
     // numBaseFunctions_[ k ] = sizes_[ 0 ] + ... + sizes_[ k ]
-    mutable unsigned int *numBaseFunctions_;
+    unsigned int *numBaseFunctions_;
 
     MonomialBasisSize ()
-      : maxOrder_( 0 ),
-        sizes_( 0 ),
-        numBaseFunctions_( 0 )
+      : maxOrder_( monomialBasisOrderLimit ),
+        sizes_( new unsigned int[ monomialBasisOrderLimit+1 ] ),
+        numBaseFunctions_( new unsigned int[ monomialBasisOrderLimit+1 ] )
     {
-      computeSizes( 2 );
+      sizes_[ 0 ] = 1;
+      numBaseFunctions_[ 0 ] = 1;
+      for( unsigned int k = 1; k <= maxOrder_; ++k )
+      {
+        sizes_[ k ]            = 0;
+        numBaseFunctions_[ k ] = 1;
+      }
     }
 
+    MonomialBasisSize ( const This & ) = delete;
+    This &operator= ( const This & ) = delete;
+
     ~MonomialBasisSize ()
     {
       delete[] sizes_;
@@ -116,6 +143,7 @@ namespace Dune
 
     unsigned int operator() ( const unsigned int order ) const
     {
+      assert( order <= maxOrder_ );
       return numBaseFunctions_[ order ];
     }
 
@@ -124,25 +152,11 @@ namespace Dune
       return maxOrder_;
     }
 
+    // the sizes are tabulated on construction, see monomialBasisOrderLimit
     void computeSizes ( unsigned int order ) const
     {
-      if (order <= maxOrder_)
-        return;
-
-      maxOrder_ = order;
-
-      delete [] sizes_;
-      delete [] numBaseFunctions_;
-      sizes_            = new unsigned int [ order+1 ];
-      numBaseFunctions_ = new unsigned int [ order+1 ];
-
-      sizes_[ 0 ] = 1;
-      numBaseFunctions_[ 0 ] = 1;
-      for( unsigned int k = 1; k <= order; ++k )
-      {
-        sizes_[ k ]            = 0;
-        numBaseFunctions_[ k ] = 1;
-      }
+      DUNE_UNUSED_PARAMETER( order );
+      assert( order <= maxOrder_ );
     }
   };
 
@@ -163,20 +177,43 @@ namespace Dune
     friend class MonomialBasisSize< Impl::Prism< Topology > >;
     friend class MonomialBasisSize< Impl::Pyramid< Topology > >;
 
-    mutable unsigned int maxOrder_;
+    unsigned int maxOrder_;
     // sizes_[ k ]: number of basis functions of exactly order k
-    mutable unsigned int *sizes_;
+    unsigned int *sizes_;
     // numBaseFunctions_[ k ] = sizes_[ 0 ] + ... + sizes_[ k ]
-    mutable unsigned int *numBaseFunctions_;
+    unsigned int *numBaseFunctions_;
 
     MonomialBasisSize ()
       : maxOrder_( 0 ),
         sizes_( 0 ),
         numBaseFunctions_( 0 )
     {
-      computeSizes( 2 );
+      const MonomialBasisSize<BaseTopology> &baseBasis =
+        MonomialBasisSize<BaseTopology>::instance();
+      const unsigned int order = baseBasis.maxOrder();
+      const unsigned int *const baseSizes = baseBasis.sizes_;
+      const unsigned int *const baseNBF   = baseBasis.numBaseFunctions_;
+
+      sizes_            = new unsigned int[ order+1 ];
+      numBaseFunctions_ = new unsigned int[ order+1 ];
+
+      sizes_[ 0 ] = 1;
+      numBaseFunctions_[ 0 ] = 1;
+      for( unsigned int k = 1; k <= order; ++k )
+      {
+        const unsigned long long size = baseNBF[ k ] + static_cast< unsigned long long >( k )*baseSizes[ k ];
+        const unsigned long long numBaseFunctions = numBaseFunctions_[ k-1 ] + size;
+        if( numBaseFunctions > std::numeric_limits< unsigned int >::max() )
+          break;
+        sizes_[ k ]            = size;
+        numBaseFunctions_[ k ] = numBaseFunctions;
+        maxOrder_ = k;
+      }
     }
 
+    MonomialBasisSize ( const This & ) = delete;
+    This &operator= ( const This & ) = delete;
+
     ~MonomialBasisSize ()
     {
       delete[] sizes_;
@@ -185,6 +222,7 @@ namespace Dune
 
     unsigned int operator() ( const unsigned int order ) const
     {
+      assert( order <= maxOrder_ );
       return numBaseFunctions_[ order ];
     }
 
@@ -193,31 +231,11 @@ namespace Dune
       return maxOrder_;
     }
 
+    // the sizes are tabulated on construction, see monomialBasisOrderLimit
     void computeSizes ( unsigned int order ) const
     {
-      if (order <= maxOrder_)
-        return;
-
-      maxOrder_ = order;
-
-      delete[] sizes_;
-      delete[] numBaseFunctions_;
-      sizes_            = new unsigned int[ order+1 ];
-      numBaseFunctions_ = new unsigned int[ order+1 ];
-
-      MonomialBasisSize<BaseTopology> &baseBasis =
-        MonomialBasisSize<BaseTopology>::instance();
-      baseBasis.computeSizes( order );
-      const unsigned int *const baseSizes = baseBasis.sizes_;
-      const unsigned int *const baseNBF   = baseBasis.numBaseFunctions_;
-
-      sizes_[ 0 ] = 1;
-      numBaseFunctions_[ 0 ] = 1;
-      for( unsigned int k = 1; k <= order; ++k )
-      {
-        sizes_[ k ]            = baseNBF[ k ] + k*baseSizes[ k ];
-        numBaseFunctions_[ k ] = numBaseFunctions_[ k-1 ] + sizes_[ k ];
-      }
+      DUNE_UNUSED_PARAMETER( order );
+      assert( order <= maxOrder_ );
     }
   };
 
@@ -238,20 +256,41 @@ namespace Dune
     friend class MonomialBasisSize< Impl::Prism< Topology > >;
     friend class MonomialBasisSize< Impl::Pyramid< Topology > >;
 
-    mutable unsigned int maxOrder_;
+    unsigned int maxOrder_;
     // sizes_[ k ]: number of basis functions of exactly order k
-    mutable unsigned int *sizes_;
+    unsigned int *sizes_;
     // numBaseFunctions_[ k ] = sizes_[ 0 ] + ... + sizes_[ k ]
-    mutable unsigned int *numBaseFunctions_;
+    unsigned int *numBaseFunctions_;
 
     MonomialBasisSize ()
       : maxOrder_( 0 ),
         sizes_( 0 ),
         numBaseFunctions_( 0 )
     {
-      computeSizes( 2 );
+      const MonomialBasisSize<BaseTopology> &baseBasis =
+        MonomialBasisSize<BaseTopology>::instance();
+      const unsigned int order = baseBasis.maxOrder();
+      const unsigned int *const baseNBF = baseBasis.numBaseFunctions_;
+
+      sizes_            = new unsigned int[ order+1 ];
+      numBaseFunctions_ = new unsigned int[ order+1 ];
+
+      sizes_[ 0 ] = 1;
+      numBaseFunctions_[ 0 ] = 1;
+      for( unsigned int k = 1; k <= order; ++k )
+      {
+        const unsigned long long numBaseFunctions = static_cast< unsigned long long >( numBaseFunctions_[ k-1 ] ) + baseNBF[ k ];
+        if( numBaseFunctions > std::numeric_limits< unsigned int >::max() )
+          break;
+        sizes_[ k ]            = baseNBF[ k ];
+        numBaseFunctions_[ k ] = numBaseFunctions;
+        maxOrder_ = k;
+      }
     }
 
+    MonomialBasisSize ( const This & ) = delete;
+    This &operator= ( const This & ) = delete;
+
     ~MonomialBasisSize ()
     {
       delete[] sizes_;
@@ -260,6 +299,7 @@ namespace Dune
 
     unsigned int operator() ( const unsigned int order ) const
     {
+      assert( order <= maxOrder_ );
       return numBaseFunctions_[ order ];
     }
 
@@ -268,31 +308,11 @@ namespace Dune
       return maxOrder_;
     }
 
+    // the sizes are tabulated on construction, see monomialBasisOrderLimit
     void computeSizes ( unsigned int order ) const
     {
-      if (order <= maxOrder_)
-        return;
-
-      maxOrder_ = order;
-
-      delete[] sizes_;
-      delete[] numBaseFunctions_;
-      sizes_            = new unsigned int[ order+1 ];
-      numBaseFunctions_ = new unsigned int[ order+1 ];
-
-      MonomialBasisSize<BaseTopology> &baseBasis =
-        MonomialBasisSize<BaseTopology>::instance();
-
-      baseBasis.computeSizes( order );
-
-      const unsigned int *const baseNBF = baseBasis.numBaseFunctions_;
-      sizes_[ 0 ] = 1;
-      numBaseFunctions_[ 0 ] = 1;
-      for( unsigned int k = 1; k <= order; ++k )
-      {
-        sizes_[ k ]            = baseNBF[ k ];
-        numBaseFunctions_[ k ] = numBaseFunctions_[ k-1 ] + sizes_[ k ];
-      }
+      DUNE_UNUSED_PARAMETER( order );
+      assert( order <= maxOrder_ );
     }
   };
 
@@ -352,6 +372,64 @@ namespace Dune
         }
       }
     }
+
+    // Same as copy, but for the table of numPoints points written by
+    // MonomialBasis::evaluatePoints, i.e., each entry is a row of
+    // numPoints values and z holds one value per point.
+    static void copyPoints ( const unsigned int deriv, F *&wit, F *&rit,
+                             const unsigned int numBaseFunctions, const F *const z,
+                             const std::size_t numPoints )
+    {
+      MySize &mySize = MySize::instance();
+      Size &size = Size::instance();
+
+      const F *const rend = rit + size( deriv )*numBaseFunctions*numPoints;
+      for( ; rit != rend; )
+      {
+        F *prit = rit;
+
+        scale( wit, z, rit, numPoints );
+        rit += numPoints, wit += numPoints;
+
+        for( unsigned d = 1; d <= deriv; ++d )
+        {
+          {
+            const F *const drend = rit + (mySize.sizes_[ d ] - mySize.sizes_[ d-1 ])*numPoints;
+            for( ; rit != drend ; rit += numPoints, wit += numPoints )
+              scale( wit, z, rit, numPoints );
+          }
+
+          for (unsigned int j=1; j<d; ++j)
+          {
+            const F *const drend = rit + (mySize.sizes_[ d-j ] - mySize.sizes_[ d-j-1 ])*numPoints;
+            for( ; rit != drend ; prit += numPoints, rit += numPoints, wit += numPoints )
+              scaleAdd( wit, F(j), prit, z, rit, numPoints );
+          }
+          scaleAdd( wit, F(d), prit, z, rit, numPoints );
+          prit += numPoints, rit += numPoints, wit += numPoints;
+          rit += (size.sizes_[d] - mySize.sizes_[d])*numPoints;
+          prit += (size.sizes_[d-1] - mySize.sizes_[d-1])*numPoints;
+          const F *const emptyWitEnd = wit + (size.sizes_[d] - mySize.sizes_[d])*numPoints;
+          for ( ; wit != emptyWitEnd; ++wit )
+            *wit = Zero<F>();
+        }
+      }
+    }
+
+  private:
+    // w[ p ] = z[ p ] * r[ p ]
+    static void scale ( F *const w, const F *const z, const F *const r, const std::size_t numPoints )
+    {
+      for( std::size_t p = 0; p < numPoints; ++p )
+        w[ p ] = z[ p ] * r[ p ];
+    }
+
+    // w[ p ] = a * q[ p ] + z[ p ] * r[ p ]
+    static void scaleAdd ( F *const w, const F &a, const F *const q, const F *const z, const F *const r, const std::size_t numPoints )
+    {
+      for( std::size_t p = 0; p < numPoints; ++p )
+        w[ p ] = a * q[ p ] + z[ p ] * r[ p ];
+    }
   };
 
 
@@ -392,6 +470,16 @@ namespace Dune
         *it = Zero< F >();
     }
 
+    template< int dimD >
+    void evaluatePoints ( const unsigned int, const unsigned int,
+                          const FieldVector< Field, dimD > *, const std::size_t numPoints,
+                          const unsigned int block, const unsigned int *const,
+                          Field *const values ) const
+    {
+      std::fill( values, values+numPoints, Field( Unity< F >() ) );
+      std::fill( values+numPoints, values+block*numPoints, Field( Zero< F >() ) );
+    }
+
     void integrate ( const unsigned int order,
                      const unsigned int *const offsets,
                      Field *const values ) const
@@ -451,6 +539,33 @@ namespace Dune
       }
     }
 
+    template< int dimD >
+    void evaluatePoints ( const unsigned int deriv, const unsigned int order,
+                          const FieldVector< Field, dimD > *x, const std::size_t numPoints,
+                          const unsigned int block, const unsigned int *const offsets,
+                          Field *const values ) const
+    {
+      typedef MonomialBasisHelper< dimDomain, dimD, Field > Helper;
+      const BaseSize &size = BaseSize::instance();
+
+      std::vector< Field > z( numPoints );
+      for( std::size_t p = 0; p < numPoints; ++p )
+        z[ p ] = x[ p ][ dimDomain-1 ];
+
+      // fill first column
+      baseBasis_.evaluatePoints( deriv, order, x, numPoints, block, offsets, values );
+
+      Field *row0 = values;
+      for( unsigned int k = 1; k <= order; ++k )
+      {
+        Field *row1 = values + block*offsets[ k-1 ]*numPoints;
+        Field *wit = row1 + block*size.sizes_[ k ]*numPoints;
+        Helper::copyPoints( deriv, wit, row1, k*size.sizes_[ k ], z.data(), numPoints );
+        Helper::copyPoints( deriv, wit, row0, size( k-1 ), z.data(), numPoints );
+        row0 = row1;
+      }
+    }
+
     void integrate ( const unsigned int order,
                      const unsigned int *const offsets,
                      Field *const values ) const
@@ -563,6 +678,50 @@ namespace Dune
       }
     }
 
+    template< int dimD >
+    void evaluatePyramidBasePoints ( const unsigned int deriv, const unsigned int order,
+                                     const FieldVector< Field, dimD > *x, const std::size_t numPoints,
+                                     const unsigned int block, const unsigned int *const offsets,
+                                     Field *const values,
+                                     const BaseSize &size ) const
+    {
+      std::vector< Field > omz( numPoints ), omzk( numPoints );
+      std::vector< FieldVector< Field, dimD > > y( x, x+numPoints );
+      for( std::size_t p = 0; p < numPoints; ++p )
+      {
+        omz[ p ] = Unity< Field >() - x[ p ][ dimDomain-1 ];
+        if( Zero< Field >() < omz[ p ] )
+        {
+          const Field invomz = Unity< Field >() / omz[ p ];
+          for( unsigned int i = 0; i < dimDomain-1; ++i )
+            y[ p ][ i ] = x[ p ][ i ] * invomz;
+        }
+        else
+        {
+          // at the apex only the constant is nonzero, see evaluatePyramidBase
+          assert( deriv==0 );
+          for( unsigned int i = 0; i < dimDomain-1; ++i )
+            y[ p ][ i ] = Zero< Field >();
+          omz[ p ] = Zero< Field >();
+        }
+        omzk[ p ] = omz[ p ];
+      }
+
+      // fill first column
+      baseBasis_.evaluatePoints( deriv, order, y.data(), numPoints, block, offsets, values );
+
+      for( unsigned int k = 1; k <= order; ++k )
+      {
+        Field *it = values + block*offsets[ k-1 ]*numPoints;
+        Field *const end = it + block*size.sizes_[ k ]*numPoints;
+        for( ; it != end; it += numPoints )
+          for( std::size_t p = 0; p < numPoints; ++p )
+            it[ p ] *= omzk[ p ];
+        for( std::size_t p = 0; p < numPoints; ++p )
+          omzk[ p ] *= omz[ p ];
+      }
+    }
+
     template< int dimD >
     void evaluate ( const unsigned int deriv, const unsigned int order,
                     const FieldVector< Field, dimD > &x,
@@ -587,6 +746,34 @@ namespace Dune
       }
     }
 
+    template< int dimD >
+    void evaluatePoints ( const unsigned int deriv, const unsigned int order,
+                          const FieldVector< Field, dimD > *x, const std::size_t numPoints,
+                          const unsigned int block, const unsigned int *const offsets,
+                          Field *const values ) const
+    {
+      typedef MonomialBasisHelper< dimDomain, dimD, Field > Helper;
+      const BaseSize &size = BaseSize::instance();
+
+      if( Impl::IsSimplex< Topology >::value )
+        baseBasis_.evaluatePoints( deriv, order, x, numPoints, block, offsets, values );
+      else
+        evaluatePyramidBasePoints( deriv, order, x, numPoints, block, offsets, values, size );
+
+      std::vector< Field > z( numPoints );
+      for( std::size_t p = 0; p < numPoints; ++p )
+        z[ p ] = x[ p ][ dimDomain-1 ];
+
+      Field *row0 = values;
+      for( unsigned int k = 1; k <= order; ++k )
+      {
+        Field *row1 = values + block*offsets[ k-1 ]*numPoints;
+        Field *wit = row1 + block*size.sizes_[ k ]*numPoints;
+        Helper::copyPoints( deriv, wit, row0, size( k-1 ), z.data(), numPoints );
+        row0 = row1;
+      }
+    }
+
     void integrate ( const unsigned int order,
                      const unsigned int *const offsets,
                      Field *const values ) const
@@ -655,7 +842,7 @@ namespace Dune
         order_(order),
         size_(Size::instance())
     {
-      assert(order<=1024); // avoid wrapping of unsigned int (0-1) order=1024 is quite hight...)
+      assert(order<=Size::instance().maxOrder()); // see monomialBasisOrderLimit
     }
 
     const unsigned int *sizes ( unsigned int order ) const
@@ -705,6 +892,21 @@ namespace Dune
       evaluate( deriv, x, values );
     }
 
+    /** \brief Evaluate all monomials and their derivatives at several points
+     *
+     * The result is stored point by point: the k-th entry of the block of
+     * derivSize( deriv ) derivatives of monomial j at the point p is
+     * values[ (j*derivSize( deriv )+k)*numPoints + p ], so values needs
+     * room for size()*derivSize( deriv )*numPoints entries.  Each step of
+     * the recursion is done for all points at once, such that the sizes
+     * are looked up once per call and the inner loops run over the points.
+     */
+    void evaluatePoints ( const unsigned int deriv, const DomainVector *x,
+                          const std::size_t numPoints, Field *const values ) const
+    {
+      Base::evaluatePoints( deriv, order_, x, numPoints, derivSize( deriv ), sizes( order_ ), values );
+    }
+
     template<unsigned int deriv, class Vector >
     void evaluate ( const DomainVector &x,
                     Vector &values ) const
@@ -843,6 +1045,25 @@ namespace Dune
 
     virtual void evaluate ( const unsigned int deriv, const DomainVector &x,
                             Field *const values ) const = 0;
+
+    /** \brief Evaluate at several points, see MonomialBasis::evaluatePoints
+     *
+     * The default implementation evaluates point by point.
+     */
+    virtual void evaluatePoints ( const unsigned int deriv, const DomainVector *x,
+                                  const std::size_t numPoints, Field *const values ) const
+    {
+      typedef MonomialBasisSize< typename Impl::SimplexTopology< dimension >::type > DerivSize;
+      const std::size_t block = DerivSize::instance()( deriv )*size();
+      std::vector< Field > pointValues( block );
+      for( std::size_t p = 0; p < numPoints; ++p )
+      {
+        evaluate( deriv, x[ p ], pointValues.data() );
+        for( std::size_t i = 0; i < block; ++i )
+          values[ i*numPoints + p ] = pointValues[ i ];
+      }
+    }
+
     template < unsigned int deriv >
     void evaluate ( const DomainVector &x,
                     Field *const values ) const
@@ -929,6 +1150,12 @@ namespace Dune
       basis_.evaluate(deriv,x,values);
     }
 
+    void evaluatePoints ( const unsigned int deriv, const DomainVector *x,
+                          const std::size_t numPoints, Field *const values ) const
+    {
+      basis_.evaluatePoints(deriv,x,numPoints,values);
+    }
+
     void integrate ( Field *const values ) const
     {
       basis_.integrate(values);
@@ -985,7 +1212,7 @@ namespace Dune
 
   template< int dim, class SF >
   struct MonomialBasisProvider
-    : public TopologySingletonFactory< MonomialBasisFactory< dim, SF > >
+    : public ConcurrentTopologySingletonFactory< MonomialBasisFactory< dim, SF > >
   {
     static const unsigned int dimension = dim;
     typedef SF StorageField;
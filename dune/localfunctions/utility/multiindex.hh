@@ -182,9 +182,10 @@ namespace Dune
     This &operator+= ( const This &other )
     {
       assert(!other.next_);
-      if (std::abs(other.factor_)<1e-10)
+      using std::abs;
+      if (abs(other.factor_)<1e-10)
         return *this;
-      if (std::abs(factor_)<1e-10)
+      if (abs(factor_)<1e-10)
       {
         *this = other;
         return *this;
@@ -373,10 +374,11 @@ namespace Dune
   template <int d, class F>
   std::ostream &operator<<(std::ostream& out,const MultiIndex<d,F>& val)
   {
+    using std::abs;
     bool first = true;
     const MultiIndex<d,F> *m = &val;
     do {
-      if (m->absZ()==0 && std::abs(m->factor())<1e-10)
+      if (m->absZ()==0 && abs(m->factor())<1e-10)
       {
         if (!m->next_ || !first)
         {
@@ -398,17 +400,17 @@ namespace Dune
       else
         out << "  ";
       first = false;
-      F f = std::abs(m->factor());
+      F f = abs(m->factor());
       if (m->absZ()==0)
         out << f;
       else {
-        if ( std::abs(f)<1e-10)
+        if ( abs(f)<1e-10)
           out << 0;
         else
         {
           F f_1(f);
           f_1 -= 1.; // better Unity<F>();
-          if ( std::abs(f_1)>1e-10)
+          if ( abs(f_1)>1e-10)
             out << f;
           int absVal = 0;
           for (int i=0; i<d; ++i) {
@@ -3,8 +3,16 @@
 #ifndef DUNE_POLYNOMIALBASIS_HH
 #define DUNE_POLYNOMIALBASIS_HH
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
 #include <fstream>
+#include <iostream>
+#include <memory>
 #include <numeric>
+#include <vector>
 
 #include <dune/common/fmatrix.hh>
 
@@ -57,6 +65,12 @@ namespace Dune
    *           typedef value_type
    *           typedef const_iterator
    *           const_iterator begin()
+   *
+   * The basis object itself is never modified by an evaluation.  The
+   * intermediate values of the underlying basis set are stored in a
+   * Workspace, which can either be passed explicitly to the evaluation
+   * methods, or is taken from a thread-local cache.  Hence one basis object
+   * can be evaluated by several threads at the same time.
    **/
   template< class Eval, class CM, class D=double, class R=double >
   class PolynomialBasis
@@ -77,14 +91,38 @@ namespace Dune
     typedef typename Evaluator::Basis Basis;
     typedef typename Evaluator::DomainVector DomainVector;
 
+    /** \brief Scratch memory for the evaluation of a PolynomialBasis
+     *
+     * A workspace must not be used by several threads at the same time,
+     * but it can be used for all bases sharing the same underlying basis set.
+     */
+    class Workspace
+    {
+      friend class PolynomialBasis;
+
+    public:
+      explicit Workspace (const PolynomialBasis &polynomialBasis)
+        : eval_(polynomialBasis.basis())
+      {}
+
+    private:
+      Workspace (const Workspace &);
+      Workspace &operator= (const Workspace &);
+      Evaluator eval_;
+      // points, underlying basis and basis functions at all points for
+      // the evaluation at several points, see evaluateTable()
+      std::vector<DomainVector> points_;
+      std::vector<typename Evaluator::Field> table_, product_;
+    };
+
     PolynomialBasis (const Basis &basis,
                      const CoefficientMatrix &coeffMatrix,
                      unsigned int size)
       : basis_(basis),
         coeffMatrix_(&coeffMatrix),
-        eval_(basis),
         order_(basis.order()),
-        size_(size)
+        size_(size),
+        id_(nextId())
     {
       // assert(coeffMatrix_);
       // assert(size_ <= coeffMatrix.size()); // !!!
@@ -113,17 +151,97 @@ namespace Dune
     //! \brief Evaluate all shape functions
     void evaluateFunction (const typename Traits::DomainType& x,
                            std::vector<typename Traits::RangeType>& out) const
+    {
+      evaluateFunction(x, out, threadWorkspace());
+    }
+
+    //! \brief Evaluate all shape functions, using the given workspace
+    void evaluateFunction (const typename Traits::DomainType& x,
+                           std::vector<typename Traits::RangeType>& out,
+                           Workspace& workspace) const
     {
       out.resize(size());
-      evaluate(x,out);
+      evaluate<0>(Convert<true,typename Traits::DomainType>::apply(x),out,workspace);
     }
 
     //! \brief Evaluate Jacobian of all shape functions
     void evaluateJacobian (const typename Traits::DomainType& x,         // position
                            std::vector<typename Traits::JacobianType>& out) const      // return value
     {
+      evaluateJacobian(x, out, threadWorkspace());
+    }
+
+    //! \brief Evaluate Jacobian of all shape functions, using the given workspace
+    void evaluateJacobian (const typename Traits::DomainType& x,
+                           std::vector<typename Traits::JacobianType>& out,
+                           Workspace& workspace) const
+    {
+      typedef FieldVector<R,dimRange*dimension> FlatJacobian;
       out.resize(size());
-      jacobian(x,out);
+      OutputRange<FlatJacobian> values(reinterpret_cast<FlatJacobian*>(out.data()), size());
+      evaluateSingle<1>(Convert<true,typename Traits::DomainType>::apply(x),values,workspace);
+    }
+
+    //! \brief Evaluate all shape functions at several points, see batchedevaluation.hh
+    void evaluateFunction (const std::vector<typename Traits::DomainType>& points,
+                           std::vector<typename Traits::RangeType>& out) const
+    {
+      evaluateFunction(points, out, threadWorkspace());
+    }
+
+    /** \brief Evaluate all shape functions at several points, using the given workspace
+     *
+     * The underlying basis is evaluated at all points first and the result
+     * is multiplied with the coefficient matrix at once, see
+     * SparseCoeffMatrix::multTable().
+     */
+    void evaluateFunction (const std::vector<typename Traits::DomainType>& points,
+                           std::vector<typename Traits::RangeType>& out,
+                           Workspace& workspace) const
+    {
+      typedef typename Evaluator::template Iterator<0>::All::Derivatives XDerivatives;
+      const std::size_t numPoints = points.size();
+      out.resize(numPoints*size());
+      const typename Evaluator::Field *product = evaluateTable<0>(points, workspace);
+      for (unsigned int i=0; i<size(); i++)
+        for (unsigned int r=0; r<CoefficientMatrix::blockSize; r++, product+=numPoints)
+          for (std::size_t p=0; p<numPoints; p++)
+            DerivativeAssign<XDerivatives,typename Traits::RangeType>::apply(r, reinterpret_cast<const XDerivatives&>(product[p]), out[p*size()+i]);
+    }
+
+    //! \brief Evaluate Jacobian of all shape functions at several points, see batchedevaluation.hh
+    void evaluateJacobian (const std::vector<typename Traits::DomainType>& points,
+                           std::vector<typename Traits::JacobianType>& out) const
+    {
+      evaluateJacobian(points, out, threadWorkspace());
+    }
+
+    //! \brief Evaluate Jacobian of all shape functions at several points, using the given workspace, see above
+    void evaluateJacobian (const std::vector<typename Traits::DomainType>& points,
+                           std::vector<typename Traits::JacobianType>& out,
+                           Workspace& workspace) const
+    {
+      typedef typename Evaluator::template Iterator<1>::All::Derivatives XDerivatives;
+      typedef typename Evaluator::Field XField;
+      typedef FieldVector<XField,dimRange*dimension> XLFETensor;
+      typedef FieldVector<R,dimRange*dimension> FlatJacobian;
+      const std::size_t numPoints = points.size();
+      const std::size_t n = numPoints*XDerivatives::size;
+      out.resize(numPoints*size());
+      const XField *product = evaluateTable<1>(points, workspace);
+      for (unsigned int i=0; i<size(); i++, product+=CoefficientMatrix::blockSize*n)
+        for (std::size_t p=0; p<numPoints; p++)
+        {
+          XLFETensor jacobian(XField(0));
+          XDerivatives derivatives;
+          for (unsigned int r=0; r<CoefficientMatrix::blockSize; r++)
+          {
+            for (unsigned int k=0; k<XDerivatives::size; k++)
+              derivatives.block()[k] = product[r*n+k*numPoints+p];
+            LFETensorAxpy<XDerivatives,XLFETensor,1>::apply(r, StorageField(Unity<StorageField>()), derivatives, jacobian);
+          }
+          field_cast(jacobian, reinterpret_cast<FlatJacobian&>(out[p*size()+i]));
+        }
     }
 
     //! \brief Evaluate partial derivatives of all shape functions
@@ -142,7 +260,12 @@ namespace Dune
     template< unsigned int deriv, class F >
     void evaluate ( const DomainVector &x, F *values ) const
     {
-      coeffMatrix_->mult( eval_.template evaluate<deriv>( x ), size(), values);
+      evaluate<deriv>( x, values, threadWorkspace() );
+    }
+    template< unsigned int deriv, class F >
+    void evaluate ( const DomainVector &x, F *values, Workspace &workspace ) const
+    {
+      coeffMatrix_->mult( workspace.eval_.template evaluate<deriv>( x ), size(), values);
     }
     template< unsigned int deriv, class DVector, class F >
     void evaluate ( const DVector &x, F *values ) const
@@ -176,10 +299,15 @@ namespace Dune
     };
     template< unsigned int deriv, class DVector, class RVector >
     void evaluate ( const DVector &x, RVector &values ) const
+    {
+      evaluate<deriv>( x, values, threadWorkspace() );
+    }
+    template< unsigned int deriv, class DVector, class RVector >
+    void evaluate ( const DVector &x, RVector &values, Workspace &workspace ) const
     {
       assert(values.size()>=size());
       const DomainVector &bx = Convert<true,DVector>::apply(x);
-      coeffMatrix_->mult( eval_.template evaluate<deriv>( bx ), values );
+      coeffMatrix_->mult( workspace.eval_.template evaluate<deriv>( bx ), values );
     }
 
     template <class Fy>
@@ -199,9 +327,14 @@ namespace Dune
 
     template< unsigned int deriv, class Vector >
     void evaluateSingle ( const DomainVector &x, Vector &values ) const
+    {
+      evaluateSingle<deriv>( x, values, threadWorkspace() );
+    }
+    template< unsigned int deriv, class Vector >
+    void evaluateSingle ( const DomainVector &x, Vector &values, Workspace &workspace ) const
     {
       assert(values.size()>=size());
-      coeffMatrix_->template mult<deriv>( eval_.template evaluate<deriv>( x ), values );
+      coeffMatrix_->template mult<deriv>( workspace.eval_.template evaluate<deriv>( x ), values );
     }
     template< unsigned int deriv, class Fy >
     void evaluateSingle ( const DomainVector &x,
@@ -234,24 +367,248 @@ namespace Dune
 
     template <class Fy>
     void integrate ( std::vector<Fy> &values ) const
+    {
+      integrate( values, threadWorkspace() );
+    }
+    template <class Fy>
+    void integrate ( std::vector<Fy> &values, Workspace &workspace ) const
     {
       assert(values.size()>=size());
-      coeffMatrix_->mult( eval_.template integrate(), values );
+      coeffMatrix_->mult( workspace.eval_.template integrate(), values );
+    }
+
+    /** \brief A linear combination of the basis functions, prepared for the
+     *         evaluation at many points
+     *
+     * The coefficients of the combination with respect to the underlying
+     * basis set, i.e. C^T c for the coefficient matrix C, are computed once
+     * by linearCombination().  Afterwards an evaluation costs one evaluation
+     * of the underlying basis set and a dot product, independent of the
+     * number of basis functions and of the sparsity of C.  The object refers
+     * to the basis, which must outlive it.
+     */
+    class LinearCombination
+    {
+      friend class PolynomialBasis;
+
+      typedef typename Evaluator::Field XField;
+
+    public:
+      //! \brief Evaluate the combination
+      void evaluate (const typename Traits::DomainType& x,
+                     typename Traits::RangeType& value) const
+      {
+        evaluate(x, value, basis_->threadWorkspace());
+      }
+
+      //! \brief Evaluate the combination, using the given workspace
+      void evaluate (const typename Traits::DomainType& x,
+                     typename Traits::RangeType& value,
+                     Workspace& workspace) const
+      {
+        typedef FieldVector<XField,dimRange> XValue;
+        XValue xValue(XField(0));
+        accumulate<0>(workspace.eval_.template evaluate<0>(Convert<true,typename Traits::DomainType>::apply(x)), xValue);
+        field_cast(xValue, value);
+      }
+
+      //! \brief Evaluate the combination and its Jacobian
+      void evaluate (const typename Traits::DomainType& x,
+                     typename Traits::RangeType& value,
+                     typename Traits::JacobianType& gradient) const
+      {
+        evaluate(x, value, gradient, basis_->threadWorkspace());
+      }
+
+      //! \brief Evaluate the combination and its Jacobian, using the given workspace
+      void evaluate (const typename Traits::DomainType& x,
+                     typename Traits::RangeType& value,
+                     typename Traits::JacobianType& gradient,
+                     Workspace& workspace) const
+      {
+        typedef FieldVector<XField,dimRange> XValue;
+        typedef FieldVector<XField,dimRange*dimension> XJacobian;
+        typedef FieldVector<R,dimRange*dimension> FlatJacobian;
+        XValue xValue(XField(0));
+        XJacobian xJacobian(XField(0));
+        auto it = workspace.eval_.template evaluate<1>(Convert<true,typename Traits::DomainType>::apply(x));
+        accumulate<0>(it, xValue);
+        accumulate<1>(it, xJacobian);
+        field_cast(xValue, value);
+        field_cast(xJacobian, reinterpret_cast<FlatJacobian&>(gradient));
+      }
+
+    private:
+      LinearCombination (const PolynomialBasis& basis)
+        : basis_(&basis)
+      {}
+
+      // y += sum_m coefficients_[r][m] * (derivatives of order deriv of the mth
+      // function of the underlying basis set) for all components r
+      template< unsigned int deriv, class BasisIterator, class Tensor >
+      void accumulate (const BasisIterator& x, Tensor& y) const
+      {
+        typedef typename BasisIterator::Derivatives XDerivatives;
+        for (unsigned int r=0; r<CoefficientMatrix::blockSize; r++)
+        {
+          BasisIterator itx = x;
+          for (const StorageField& c : coefficients_[r])
+          {
+            LFETensorAxpy<XDerivatives,Tensor,deriv>::apply(r, c, *itx, y);
+            ++itx;
+          }
+        }
+      }
+
+      const PolynomialBasis* basis_;
+      std::array<std::vector<StorageField>,CoefficientMatrix::blockSize> coefficients_;
+    };
+
+    /** \brief Prepare the combination of the basis functions with the given
+     *         coefficients for the evaluation at many points, see LinearCombination
+     *
+     * This costs one pass over the coefficient matrix.
+     */
+    template< class C >
+    LinearCombination linearCombination (const std::vector<C>& coefficients) const
+    {
+      assert(coefficients.size() == size());
+      LinearCombination combination(*this);
+      for (unsigned int r=0; r<CoefficientMatrix::blockSize; r++)
+      {
+        std::vector<StorageField>& row = combination.coefficients_[r];
+        row.assign(basis_.size(), StorageField(Zero<StorageField>()));
+        for (unsigned int i=0; i<size(); i++)
+          coeffMatrix_->addRow(i*CoefficientMatrix::blockSize+r, field_cast<StorageField>(coefficients[i]), row);
+      }
+      return combination;
+    }
+
+    /** \brief Evaluate the combination of the basis functions with the given
+     *         coefficients, without the values of the single basis functions
+     *
+     * For many points with the same coefficients, prepare the combination
+     * once by linearCombination().
+     */
+    template< class C >
+    void evaluateCombination (const typename Traits::DomainType& x,
+                              const std::vector<C>& coefficients,
+                              typename Traits::RangeType& value) const
+    {
+      linearCombination(coefficients).evaluate(x, value);
+    }
+
+    //! \brief Evaluate the combination of the basis functions with the given coefficients and its Jacobian
+    template< class C >
+    void evaluateCombination (const typename Traits::DomainType& x,
+                              const std::vector<C>& coefficients,
+                              typename Traits::RangeType& value,
+                              typename Traits::JacobianType& gradient) const
+    {
+      linearCombination(coefficients).evaluate(x, value, gradient);
     }
 
   protected:
+    // Non-owning view of consecutive entries of an output vector,
+    // to be passed to the mult methods of the coefficient matrix
+    template <class T>
+    struct OutputRange
+    {
+      typedef T value_type;
+      OutputRange ( T *data, std::size_t size )
+        : data_(data), size_(size)
+      {}
+      std::size_t size () const { return size_; }
+      T &operator[] ( std::size_t i ) const { return data_[i]; }
+    private:
+      T *data_;
+      std::size_t size_;
+    };
+
+    // Evaluates the derivatives up to order deriv of the underlying basis
+    // at all points into a table with one row per basis function and
+    // derivative of the underlying basis (see MonomialBasis::evaluatePoints)
+    // and multiplies it with the coefficient matrix.  The row
+    // k*blockSize+r of the result holds, for each derivative of component
+    // r of the basis function k, its values at all points.
+    template< unsigned int deriv >
+    const typename Evaluator::Field *evaluateTable ( const std::vector<typename Traits::DomainType>& points, Workspace &workspace ) const
+    {
+      const std::size_t numDerivatives = Evaluator::template Iterator<deriv>::All::Derivatives::size;
+      const std::size_t n = points.size()*numDerivatives;
+      const unsigned int numRows = size()*CoefficientMatrix::blockSize;
+      assert(basis_.size() == coeffMatrix_->baseSize());
+
+      workspace.points_.resize(points.size());
+      for (std::size_t p=0; p<points.size(); p++)
+        workspace.points_[p] = Convert<true,typename Traits::DomainType>::apply(points[p]);
+      workspace.table_.resize(std::size_t(basis_.size())*n);
+      basis_.evaluatePoints(deriv, workspace.points_.data(), points.size(), workspace.table_.data());
+
+      workspace.product_.resize(std::size_t(numRows)*n);
+      if (n > 0)
+        coeffMatrix_->multTable(workspace.table_.data(), n, numRows, workspace.product_.data());
+      return workspace.product_.data();
+    }
+
+    // Number of workspaces kept by each thread, enough for the bases of a
+    // mixed discretization like Taylor-Hood elements
+    static const std::size_t threadWorkspaces = 4;
+
+    // The workspace of the calling thread.  Each thread keeps the
+    // workspaces of the threadWorkspaces bases it evaluated last,
+    // identified by an id that is never reused, and replaces the least
+    // recently used one when it evaluates another basis.
+    Workspace &threadWorkspace () const
+    {
+      struct Slot
+      {
+        std::size_t id = 0, lastUse = 0;
+        std::unique_ptr<Workspace> workspace;
+      };
+      struct Cache
+      {
+        std::array<Slot,threadWorkspaces> slots;
+        std::size_t clock = 0;
+      };
+      static thread_local Cache cache;
+
+      Slot *oldest = &cache.slots[0];
+      for (Slot &slot : cache.slots)
+      {
+        if (slot.id == id_)
+        {
+          slot.lastUse = ++cache.clock;
+          return *slot.workspace;
+        }
+        if (slot.lastUse < oldest->lastUse)
+          oldest = &slot;
+      }
+      oldest->workspace.reset(new Workspace(*this));
+      oldest->id = id_;
+      oldest->lastUse = ++cache.clock;
+      return *oldest->workspace;
+    }
+
+    static std::size_t nextId ()
+    {
+      static std::atomic<std::size_t> counter(0);
+      return ++counter;
+    }
+
+    // a copy shares the underlying basis set and hence the workspace
     PolynomialBasis(const PolynomialBasis &other)
       : basis_(other.basis_),
         coeffMatrix_(other.coeffMatrix_),
-        eval_(basis_),
         order_(basis_.order()),
-        size_(other.size_)
+        size_(other.size_),
+        id_(other.id_)
     {}
     PolynomialBasis &operator=(const PolynomialBasis&);
     const Basis &basis_;
     const CoefficientMatrix* coeffMatrix_;
-    mutable Evaluator eval_;
     unsigned int order_,size_;
+    std::size_t id_;
   };
 
   /**
@@ -295,6 +652,20 @@ namespace Dune
       this->size_ = size;
     }
 
+    //! \brief Write the coefficient matrix in a binary format
+    void save(std::ostream& out) const
+    {
+      coeffMatrix_.save(out);
+    }
+    //! \brief Read a coefficient matrix written by save(), returns false on failure
+    bool load(std::istream& in)
+    {
+      if (!coeffMatrix_.load(in))
+        return false;
+      this->size_ = coeffMatrix_.size();
+      return true;
+    }
+
   private:
     PolynomialBasisWithMatrix(const PolynomialBasisWithMatrix &);
     PolynomialBasisWithMatrix &operator=(const PolynomialBasisWithMatrix &);
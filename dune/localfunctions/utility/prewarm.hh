@@ -0,0 +1,160 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#ifndef DUNE_LOCALFUNCTIONS_PREWARM_HH
+#define DUNE_LOCALFUNCTIONS_PREWARM_HH
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <dune/common/classname.hh>
+#include <dune/common/exceptions.hh>
+
+#include <dune/geometry/type.hh>
+
+namespace Dune
+{
+
+  /**
+   * @brief Build finite elements and bases ahead of their first use
+   *
+   * The generic finite elements and the factories behind them create
+   * their bases, coefficients and interpolations lazily on the first
+   * request.  For high orders this takes long enough to show up as a
+   * latency spike in the first assembly.  LocalFiniteElementPrewarm
+   * collects a list of families, geometry types and orders and builds
+   * them concurrently on a set of threads, for example at program start.
+   *
+   * Finite elements derived from GenericLocalFiniteElement (e.g.
+   * LagrangeLocalFiniteElement, OrthonormalLocalFiniteElement,
+   * RaviartThomasSimplexLocalFiniteElement) keep the objects built here
+   * for all later elements with the same geometry type and order.  For
+   * factories only those keeping their objects, like
+   * MonomialBasisProvider, or storing them in the CoeffMatrixCache
+   * benefit from being prewarmed.
+   *
+   * \code
+   * LocalFiniteElementPrewarm prewarm;
+   * for( unsigned int order = 1; order <= 6; ++order )
+   *   prewarm.add< LagrangeLocalFiniteElement< EquidistantPointSet, 3, double, double > >( GeometryTypes::simplex( 3 ), order );
+   * for( const auto &timing : prewarm.run() )
+   *   std::cout << timing.family << " " << timing.type << " " << timing.order
+   *             << ": " << timing.seconds << "s" << std::endl;
+   * \endcode
+   */
+  class LocalFiniteElementPrewarm
+  {
+  public:
+    //! result of building a single item
+    struct Timing
+    {
+      //! name of the finite element or factory
+      std::string family;
+      GeometryType type;
+      unsigned int order;
+      //! wall clock time needed to build the item
+      double seconds;
+      //! false if building the item threw an exception
+      bool success;
+      //! the message of the exception if the build failed
+      std::string message;
+    };
+
+    //! add a finite element constructible from a geometry type and an order
+    template< class FiniteElement >
+    void add ( const GeometryType &type, unsigned int order,
+               const std::string &family = className< FiniteElement >() )
+    {
+      items_.push_back( Item{ family, type, order, [ type, order ] () { FiniteElement finiteElement( type, order ); } } );
+    }
+
+    //! add a topology factory taking the order as key
+    template< class Factory >
+    void addFactory ( const GeometryType &type, unsigned int order,
+                      const std::string &family = className< Factory >() )
+    {
+      items_.push_back( Item{ family, type, order, [ type, order ] () { Factory::release( Factory::create( type, order ) ); } } );
+    }
+
+    //! number of items added
+    std::size_t size () const
+    {
+      return items_.size();
+    }
+
+    /** \brief build all items
+     *
+     * \param numThreads number of threads to use, 0 means one per hardware
+     *                   thread
+     * \returns the timings in the order the items have been added
+     */
+    std::vector< Timing > run ( unsigned int numThreads = 0 ) const
+    {
+      if( numThreads == 0 )
+        numThreads = std::max( std::thread::hardware_concurrency(), 1u );
+      numThreads = std::min< std::size_t >( numThreads, items_.size() );
+
+      std::vector< Timing > timings( items_.size() );
+      std::atomic< std::size_t > next( 0 );
+      auto work = [ this, &timings, &next ] () {
+          for( std::size_t i = next++; i < items_.size(); i = next++ )
+            timings[ i ] = build( items_[ i ] );
+        };
+
+      std::vector< std::thread > threads;
+      for( unsigned int t = 1; t < numThreads; ++t )
+        threads.emplace_back( work );
+      work();
+      for( std::thread &thread : threads )
+        thread.join();
+      return timings;
+    }
+
+  private:
+    struct Item
+    {
+      std::string family;
+      GeometryType type;
+      unsigned int order;
+      std::function< void () > build;
+    };
+
+    static Timing build ( const Item &item )
+    {
+      Timing timing{ item.family, item.type, item.order, 0.0, true, std::string() };
+      const auto start = std::chrono::steady_clock::now();
+      try
+      {
+        item.build();
+      }
+      catch( const Dune::Exception &e )
+      {
+        timing.success = false;
+        timing.message = e.what();
+      }
+      catch( const std::exception &e )
+      {
+        timing.success = false;
+        timing.message = e.what();
+      }
+      catch( ... )
+      {
+        timing.success = false;
+        timing.message = "unknown exception";
+      }
+      timing.seconds = std::chrono::duration< double >( std::chrono::steady_clock::now() - start ).count();
+      return timing;
+    }
+
+    std::vector< Item > items_;
+  };
+
+}
+
+#endif // #ifndef DUNE_LOCALFUNCTIONS_PREWARM_HH
@@ -4,6 +4,7 @@
 #ifndef DUNE_LOCALFUNCTIONS_WHITNEY_EDGES0_5_BASIS_HH
 #define DUNE_LOCALFUNCTIONS_WHITNEY_EDGES0_5_BASIS_HH
 
+#include <array>
 #include <cstddef>
 #include <vector>
 
@@ -112,7 +113,7 @@ namespace Dune {
 
       // compute p1 values -- use the local basis directly for that, local and
       // global values are identical for scalars
-      std::vector<typename P1LocalBasis::Traits::RangeType> p1v;
+      std::array<typename P1LocalBasis::Traits::RangeType, dim+1> p1v;
       p1LocalBasis.evaluateFunction(xl, p1v);
 
       for(std::size_t i = 0; i < s; i++) {